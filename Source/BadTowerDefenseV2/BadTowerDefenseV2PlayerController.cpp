@@ -6,6 +6,9 @@
 #include "NiagaraSystem.h"
 #include "NiagaraFunctionLibrary.h"
 #include "BadTowerDefenseV2Character.h"
+#include "ObjectPoolSubsystem.h"
+#include "HexFlowFieldSubsystem.h"
+#include "MapUtilitiesLibrary.h"
 #include "Engine/World.h"
 #include "EnhancedInputComponent.h"
 #include "InputActionValue.h"
@@ -20,6 +23,13 @@ ABadTowerDefenseV2PlayerController::ABadTowerDefenseV2PlayerController()
 	DefaultMouseCursor = EMouseCursor::Default;
 	CachedDestination = FVector::ZeroVector;
 	FollowTime = 0.f;
+	MapPlaneHeight = 0.f;
+	ChunkDimensions = 8;
+	MinPickRayZ = 0.05f;
+	MaxPickDistance = 100000.f;
+	LastCursorPickFrame = TNumericLimits<uint64>::Max();
+	bLastCursorPickHit = false;
+	LastCursorPickLocation = FVector::ZeroVector;
 }
 
 void ABadTowerDefenseV2PlayerController::BeginPlay()
@@ -32,6 +42,12 @@ void ABadTowerDefenseV2PlayerController::BeginPlay()
 	{
 		Subsystem->AddMappingContext(DefaultMappingContext, 0);
 	}
+
+	// Have the click FX ready before the first click
+	if (UObjectPoolSubsystem* ObjectPool = GetWorld()->GetSubsystem<UObjectPoolSubsystem>())
+	{
+		ObjectPool->PrewarmEffects(FXCursor, 2);
+	}
 }
 
 void ABadTowerDefenseV2PlayerController::SetupInputComponent()
@@ -71,22 +87,24 @@ void ABadTowerDefenseV2PlayerController::OnSetDestinationTriggered()
 	// We flag that the input is being pressed
 	FollowTime += GetWorld()->GetDeltaSeconds();
 	
-	// We look for the location in the world where the player has pressed the input
-	FHitResult Hit;
+	// We look for the location on the map where the player has pressed the input
+	FCoordinate2D Tile;
+	FCoordinate2D Chunk;
+	FVector Location;
 	bool bHitSuccessful = false;
 	if (bIsTouch)
 	{
-		bHitSuccessful = GetHitResultUnderFinger(ETouchIndex::Touch1, ECollisionChannel::ECC_Visibility, true, Hit);
+		bHitSuccessful = GetHexUnderFinger(ETouchIndex::Touch1, Tile, Chunk, Location);
 	}
 	else
 	{
-		bHitSuccessful = GetHitResultUnderCursor(ECollisionChannel::ECC_Visibility, true, Hit);
+		bHitSuccessful = GetHexUnderCursor(Tile, Chunk, Location);
 	}
 
-	// If we hit a surface, cache the location
+	// If we hit the map, cache the location
 	if (bHitSuccessful)
 	{
-		CachedDestination = Hit.Location;
+		CachedDestination = Location;
 	}
 	
 	// Move towards mouse pointer or touch
@@ -105,7 +123,14 @@ void ABadTowerDefenseV2PlayerController::OnSetDestinationReleased()
 	{
 		// We move there and spawn some particles
 		UAIBlueprintHelperLibrary::SimpleMoveToLocation(this, CachedDestination);
-		UNiagaraFunctionLibrary::SpawnSystemAtLocation(this, FXCursor, CachedDestination, FRotator::ZeroRotator, FVector(1.f, 1.f, 1.f), true, true, ENCPoolMethod::None, true);
+		if (UObjectPoolSubsystem* ObjectPool = GetWorld()->GetSubsystem<UObjectPoolSubsystem>())
+		{
+			ObjectPool->SpawnPooledEffect(FXCursor, CachedDestination, FRotator::ZeroRotator, FVector(1.f, 1.f, 1.f));
+		}
+		else
+		{
+			UNiagaraFunctionLibrary::SpawnSystemAtLocation(this, FXCursor, CachedDestination, FRotator::ZeroRotator, FVector(1.f, 1.f, 1.f), true, true, ENCPoolMethod::AutoRelease, true);
+		}
 	}
 
 	FollowTime = 0.f;
@@ -123,3 +148,79 @@ void ABadTowerDefenseV2PlayerController::OnTouchReleased()
 	bIsTouch = false;
 	OnSetDestinationReleased();
 }
+
+bool ABadTowerDefenseV2PlayerController::GetHexUnderCursor(FCoordinate2D& OutTile, FCoordinate2D& OutChunk, FVector& OutLocation)
+{
+	// Hover highlighting, placement and movement can all ask in the same frame
+	if (LastCursorPickFrame != GFrameCounter)
+	{
+		float MouseX;
+		float MouseY;
+		bLastCursorPickHit = GetMousePosition(MouseX, MouseY) && PickMapLocation(FVector2D(MouseX, MouseY), LastCursorPickLocation);
+		LastCursorPickFrame = GFrameCounter;
+	}
+
+	if (!bLastCursorPickHit)
+	{
+		return false;
+	}
+
+	OutLocation = LastCursorPickLocation;
+	ConvertPickToHex(OutLocation, OutTile, OutChunk);
+	return true;
+}
+
+bool ABadTowerDefenseV2PlayerController::GetHexUnderFinger(TEnumAsByte<ETouchIndex::Type> FingerIndex, FCoordinate2D& OutTile, FCoordinate2D& OutChunk, FVector& OutLocation)
+{
+	float TouchX;
+	float TouchY;
+	bool bIsPressed = false;
+	GetInputTouchState(FingerIndex, TouchX, TouchY, bIsPressed);
+	if (!bIsPressed || !PickMapLocation(FVector2D(TouchX, TouchY), OutLocation))
+	{
+		return false;
+	}
+
+	ConvertPickToHex(OutLocation, OutTile, OutChunk);
+	return true;
+}
+
+bool ABadTowerDefenseV2PlayerController::PickMapLocation(const FVector2D& ScreenPosition, FVector& OutLocation) const
+{
+	FVector RayOrigin;
+	FVector RayDirection;
+	if (!DeprojectScreenPositionToWorld(ScreenPosition.X, ScreenPosition.Y, RayOrigin, RayDirection))
+	{
+		return false;
+	}
+
+	// The tiles are flat on one plane, so one division finds the hit. It's only ambiguous when the ray is nearly
+	// parallel to the plane, points away from it or meets it too far out, and then a trace has the final say
+	if (FMath::Abs(RayDirection.Z) >= MinPickRayZ)
+	{
+		const double Distance = (MapPlaneHeight - RayOrigin.Z) / RayDirection.Z;
+		if (Distance >= 0.0 && Distance <= MaxPickDistance)
+		{
+			OutLocation = RayOrigin + RayDirection * Distance;
+			return true;
+		}
+	}
+
+	FHitResult Hit;
+	if (GetHitResultAtScreenPosition(ScreenPosition, ECollisionChannel::ECC_Visibility, true, Hit))
+	{
+		OutLocation = Hit.Location;
+		return true;
+	}
+	return false;
+}
+
+void ABadTowerDefenseV2PlayerController::ConvertPickToHex(const FVector& Location, FCoordinate2D& OutTile, FCoordinate2D& OutChunk) const
+{
+	// The flow field owns the tile size, same as the rest of the map code
+	const UHexFlowFieldSubsystem* FlowField = GetWorld()->GetSubsystem<UHexFlowFieldSubsystem>();
+	const float TileSize = FlowField ? FlowField->TileSize : 100.f;
+
+	OutTile = UMapUtilitiesLibrary::ConvertWorldLocationToGlobalCoordinate(Location, TileSize);
+	OutChunk = UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(OutTile, ChunkDimensions);
+}
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Templates/SubclassOf.h"
 #include "GameFramework/PlayerController.h"
+#include "FCoordinate2D.h"
 #include "BadTowerDefenseV2PlayerController.generated.h"
 
 /** Forward declaration to improve compiling times */
@@ -42,6 +43,34 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
 	UInputAction* SetDestinationTouchAction;
 
+	/** Height of the plane the map's tiles lie on */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Picking)
+	float MapPlaneHeight;
+
+	/** Tiles per chunk side, for the chunk coordinate of a picked tile */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Picking)
+	int32 ChunkDimensions;
+
+	/** Cursor rays flatter than this (Z of the unit direction) hit the map plane too far out to trust, so they fall back to a trace */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Picking)
+	float MinPickRayZ;
+
+	/** Plane hits further than this from the camera fall back to a trace */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Picking)
+	float MaxPickDistance;
+
+	/**
+	 * Tile under the mouse cursor, for hover highlighting and placement. Intersects the cursor ray with the map plane
+	 * instead of running a collision query, and only traces against ECC_Visibility if that hit is ambiguous.
+	 * Same-frame calls reuse the first result.
+	 */
+	UFUNCTION(BlueprintCallable, Category = Picking)
+	bool GetHexUnderCursor(FCoordinate2D& OutTile, FCoordinate2D& OutChunk, FVector& OutLocation);
+
+	/** Same as GetHexUnderCursor, for a touch */
+	UFUNCTION(BlueprintCallable, Category = Picking)
+	bool GetHexUnderFinger(TEnumAsByte<ETouchIndex::Type> FingerIndex, FCoordinate2D& OutTile, FCoordinate2D& OutChunk, FVector& OutLocation);
+
 protected:
 	/** True if the controlled character should navigate to the mouse cursor. */
 	uint32 bMoveToMouseCursor : 1;
@@ -59,8 +88,17 @@ protected:
 	void OnTouchReleased();
 
 private:
+	/** Where the ray through ScreenPosition meets the map, on the plane if it's unambiguous and by tracing otherwise */
+	bool PickMapLocation(const FVector2D& ScreenPosition, FVector& OutLocation) const;
+	void ConvertPickToHex(const FVector& Location, FCoordinate2D& OutTile, FCoordinate2D& OutChunk) const;
+
 	FVector CachedDestination;
 
+	/** Cursor pick of the frame in LastCursorPickFrame */
+	uint64 LastCursorPickFrame;
+	bool bLastCursorPickHit;
+	FVector LastCursorPickLocation;
+
 	bool bIsTouch; // Is it a touch device
 	float FollowTime; // For how long it has been pressed
 };
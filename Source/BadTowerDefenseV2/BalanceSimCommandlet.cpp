@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BalanceSimCommandlet.h"
+#include "BalanceSimConfig.h"
+#include "BalanceSimulation.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+#include "JsonObjectConverter.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+/// <summary>
+/// Quotes field for a CSV cell if it needs it (RFC 4180): wrapped in double quotes, quotes inside doubled
+/// </summary>
+static FString EscapeCsvField(const FString& field)
+{
+	int32 index;
+	if (!field.FindChar(TEXT(','), index) && !field.FindChar(TEXT('"'), index) && !field.FindChar(TEXT('\n'), index) && !field.FindChar(TEXT('\r'), index)) {
+		return field;
+	}
+	return TEXT("\"") + field.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\"");
+}
+
+UBalanceSimCommandlet::UBalanceSimCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Simulates waves against tower layouts for a sweep of seeds and stat scales and writes per-wave results");
+	HelpUsage = TEXT("-run=BalanceSim -Config=<path.json> [-Output=<path.csv>] [-SingleThread]");
+}
+
+int32 UBalanceSimCommandlet::Main(const FString& Params)
+{
+	FString configPath;
+	if (!FParse::Value(*Params, TEXT("Config="), configPath)) {
+		UE_LOG(LogTemp, Error, TEXT("No -Config=<path.json> given. %s"), *HelpUsage);
+		return 1;
+	}
+
+	FString json;
+	FBalanceSimConfig config;
+	if (!FFileHelper::LoadFileToString(json, *configPath) || !FJsonObjectConverter::JsonObjectStringToUStruct(json, &config, 0, 0)) {
+		UE_LOG(LogTemp, Error, TEXT("Failed to read a balance config from %s"), *configPath);
+		return 1;
+	}
+
+	if (config.Waves.IsEmpty()) {
+		UE_LOG(LogTemp, Error, TEXT("%s has no waves to play"), *configPath);
+		return 1;
+	}
+
+	FString outputPath;
+	if (!FParse::Value(*Params, TEXT("Output="), outputPath)) {
+		outputPath = FPaths::ProjectSavedDir() / TEXT("Balance") / FString::Printf(TEXT("BalanceSim-%s.csv"), *FDateTime::Now().ToString());
+	}
+
+	// Missing axes still get swept once
+	if (config.Seeds.IsEmpty()) {
+		config.Seeds.Add(0);
+	}
+	if (config.EnemyHealthScales.IsEmpty()) {
+		config.EnemyHealthScales.Add(1.f);
+	}
+	if (config.TowerDamageScales.IsEmpty()) {
+		config.TowerDamageScales.Add(1.f);
+	}
+
+	TArray<FBalanceRunParams> runs;
+	const auto numLayouts = FMath::Max(config.Layouts.Num(), 1);
+	for (auto seed : config.Seeds) {
+		for (int32 layout = 0; layout < numLayouts; layout++) {
+			for (auto healthScale : config.EnemyHealthScales) {
+				for (auto damageScale : config.TowerDamageScales) {
+					auto& run = runs.AddDefaulted_GetRef();
+					run.Seed = seed;
+					run.LayoutIndex = config.Layouts.IsEmpty() ? INDEX_NONE : layout;
+					run.EnemyHealthScale = healthScale;
+					run.TowerDamageScale = damageScale;
+				}
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Simulating %d runs of %d waves"), runs.Num(), config.Waves.Num());
+
+	// Runs don't share anything but the config, so each one gets a core to itself
+	TArray<TArray<FBalanceWaveResult>> results;
+	results.SetNum(runs.Num());
+	const auto start = FPlatformTime::Seconds();
+	ParallelFor(runs.Num(), [&](int32 i) {
+		FBalanceSimulation simulation(config);
+		simulation.Run(runs[i], results[i]);
+	}, FParse::Param(*Params, TEXT("SingleThread")) ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced);
+	const auto wallSeconds = FPlatformTime::Seconds() - start;
+
+	// Write everything out
+	double simulatedSeconds = 0.0;
+	int32 wavesPlayed = 0;
+	FString csv = TEXT("seed,layout,enemyHealthScale,towerDamageScale,wave,spawned,killed,leaked,headquartersDamage,headquartersHealth,bounty,steps,simulated_s,wall_ms,speedup,timedOut\n");
+	for (int32 i = 0; i < runs.Num(); i++) {
+		auto& run = runs[i];
+		const auto layoutName = EscapeCsvField(config.Layouts.IsValidIndex(run.LayoutIndex) ? config.Layouts[run.LayoutIndex].Name : FString(TEXT("none")));
+
+		for (auto& wave : results[i]) {
+			csv += FString::Printf(TEXT("%d,%s,%.3f,%.3f,%d,%d,%d,%d,%d,%d,%d,%d,%.3f,%.3f,%.1f,%s\n"),
+				run.Seed, *layoutName, run.EnemyHealthScale, run.TowerDamageScale,
+				wave.Wave, wave.Spawned, wave.Killed, wave.Leaked, wave.HeadquartersDamage, wave.HeadquartersHealth, wave.Bounty,
+				wave.Steps, wave.SimulatedSeconds, wave.WallSeconds * 1000.0, wave.SimulatedSeconds / FMath::Max(wave.WallSeconds, 1e-9),
+				wave.bTimedOut ? TEXT("true") : TEXT("false"));
+
+			simulatedSeconds += wave.SimulatedSeconds;
+			wavesPlayed++;
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(csv, *outputPath)) {
+		UE_LOG(LogTemp, Error, TEXT("Failed to write balance results to %s"), *outputPath);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Played %d waves, %.0f simulated seconds in %.2f seconds (%.0fx real time). Wrote results to %s"),
+		wavesPlayed, simulatedSeconds, wallSeconds, simulatedSeconds / FMath::Max(wallSeconds, 1e-9), *outputPath);
+	return 0;
+}
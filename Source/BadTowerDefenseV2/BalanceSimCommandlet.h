@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "BalanceSimCommandlet.generated.h"
+
+/**
+ * Headless balancing runs, faster than real time and without rendering.
+ *
+ * Reads a FBalanceSimConfig from JSON (tower and enemy stats, tower layouts, waves, seeds and the stat scales to
+ * sweep), plays every combination as its own FBalanceSimulation spread over all cores, and writes one CSV line per
+ * wave played: outcome (kills, leaks, headquarters health, bounty) and timing (steps, simulated and wall time).
+ * Returns 1 if the config can't be read or the results can't be written.
+ *
+ * UnrealEditor-Cmd BadTowerDefenseV2.uproject -run=BalanceSim -nullrhi -unattended -Config=<path.json>
+ *     [-Output=<path.csv>] [-SingleThread]
+ */
+UCLASS()
+class UBalanceSimCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UBalanceSimCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "EnemySimulationSubsystem.h"
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "BalanceSimConfig.generated.h"
+
+/** Stats of one kind of tower. Row struct for tower data tables, mirroring S_TowerData */
+USTRUCT(BlueprintType)
+struct FBalanceTowerStats : public FTableRowBase {
+	GENERATED_USTRUCT_BODY()
+
+	// Per shot
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tower")
+	float Damage = 10.f;
+
+	// In tiles
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tower")
+	int32 Range = 2;
+
+	// Seconds between shots
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tower")
+	float FireInterval = 1.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tower")
+	int32 Cost = 10;
+};
+
+/**
+ * Where one tower goes. Maps differ per seed, so instead of a fixed Tile a tower can be placed next to the road:
+ * with RoadIndex set it goes on the Side-th free neighbor of that road tile, counted from the spawn.
+ */
+USTRUCT(BlueprintType)
+struct FBalanceTowerPlacement {
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	FName Tower;
+
+	// Global tile, used when RoadIndex is INDEX_NONE. Towers placed on the road block it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	FCoordinate2D Tile = FCoordinate2D(0, 0);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	int32 RoadIndex = INDEX_NONE;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	int32 Side = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FBalanceTowerLayout {
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	FString Name;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	TArray<FBalanceTowerPlacement> Towers;
+};
+
+/** Count enemies of one type, the first Delay seconds into the wave and then one every Interval seconds */
+USTRUCT(BlueprintType)
+struct FBalanceSpawnGroup {
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	FName Enemy;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	int32 Count = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	float Delay = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	float Interval = 1.f;
+};
+
+USTRUCT(BlueprintType)
+struct FBalanceWave {
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	TArray<FBalanceSpawnGroup> Groups;
+};
+
+/**
+ * Everything a balancing sweep needs, read from JSON by UBalanceSimCommandlet. Every combination of seed, layout,
+ * enemy health scale and tower damage scale is one run, and each run plays all the waves in order.
+ */
+USTRUCT(BlueprintType)
+struct FBalanceSimConfig {
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	TArray<int32> Seeds;
+
+	// Chunks in the map's walk
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	int32 MapSize = 16;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	int32 ChunkDimensions = 8;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	float TileSize = 100.f;
+
+	// Simulated seconds per step, independent of how fast the steps actually run
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	float TimeStep = 1.f / 30.f;
+
+	// A wave that hasn't ended after this long (e.g. a tower cut the road) is cut off and marked as timed out
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	float MaxWaveSeconds = 600.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	int32 HeadquartersHealth = 20;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	TMap<FName, FEnemyUnitStats> Enemies;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	TMap<FName, FBalanceTowerStats> Towers;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	TArray<FBalanceTowerLayout> Layouts;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	TArray<FBalanceWave> Waves;
+
+	// Sweep axes. Enemy max health and tower damage get multiplied by each of these in turn
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	TArray<float> EnemyHealthScales = { 1.f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Balance")
+	TArray<float> TowerDamageScales = { 1.f };
+};
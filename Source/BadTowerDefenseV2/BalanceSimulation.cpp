@@ -0,0 +1,255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BalanceSimulation.h"
+#include "RandomWalkLibrary.h"
+#include "HexLayout.h"
+
+#include "HAL/PlatformTime.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("BalanceSim"), STATGROUP_BalanceSim, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Build Map"), STAT_BalanceSim_BuildMap, STATGROUP_BalanceSim);
+DECLARE_CYCLE_STAT(TEXT("Play Wave"), STAT_BalanceSim_PlayWave, STATGROUP_BalanceSim);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Steps"), STAT_BalanceSim_Steps, STATGROUP_BalanceSim);
+
+// Shortest time between two shots of a tower, so a zero interval can't keep one firing forever within a step
+constexpr float MIN_FIRE_INTERVAL = 0.001f;
+
+FBalanceSimulation::FBalanceSimulation(const FBalanceSimConfig& config)
+	: Config(config)
+	, Enemies(config.TileSize, config.ChunkDimensions)
+{
+	// Type ids follow the config's order, which is the same for every instance
+	for (auto& enemy : Config.Enemies) {
+		EnemyTypeNames.Add(enemy.Key);
+		EnemyTypes.Add(&enemy.Value);
+	}
+}
+
+void FBalanceSimulation::Run(const FBalanceRunParams& params, TArray<FBalanceWaveResult>& outWaves)
+{
+	BuildMap(params.Seed);
+	if (Config.Layouts.IsValidIndex(params.LayoutIndex)) {
+		PlaceTowers(Config.Layouts[params.LayoutIndex], params.TowerDamageScale);
+	}
+	FlowField.Rebuild();
+
+	HeadquartersHealth = Config.HeadquartersHealth;
+	for (int32 i = 0; i < Config.Waves.Num() && HeadquartersHealth > 0; i++) {
+		auto& result = outWaves.AddDefaulted_GetRef();
+		result.Wave = i;
+		PlayWave(Config.Waves[i], params.EnemyHealthScale, result);
+	}
+}
+
+void FBalanceSimulation::BuildMap(int32 seed)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BalanceSim_BuildMap);
+
+	FlowField.Reset();
+	Road.Reset();
+	RoadTiles.Reset();
+	TowerTiles.Reset();
+	Towers.Reset();
+
+	const auto dimensions = Config.ChunkDimensions;
+	const auto chunkWalk = URandomWalkLibrary::SelfAvoidingWalk(Config.MapSize, FRandomStream(seed));
+	const auto chunks = URandomWalkLibrary::GenerateChunkPaths(chunkWalk, seed, dimensions);
+
+	// Chunk paths run from Exit back to Entry, the road runs the other way
+	for (auto& chunk : chunks) {
+		const auto originX = chunk.ChunkCoordinate.X * dimensions;
+		const auto originY = chunk.ChunkCoordinate.Y * dimensions;
+		for (int32 i = chunk.Path.Num() - 1; i >= 0; i--) {
+			const auto tile = FCoordinate2D(originX + chunk.Path[i].X, originY + chunk.Path[i].Y);
+
+			bool bIsAlreadyInSet = false;
+			RoadTiles.Add(tile, &bIsAlreadyInSet);
+			if (!bIsAlreadyInSet) {
+				Road.Add(tile);
+				FlowField.SetTileWalkable(tile, true);
+			}
+		}
+	}
+
+	if (!Road.IsEmpty()) {
+		FlowField.SetGoal(Road.Last());
+	}
+}
+
+void FBalanceSimulation::PlaceTowers(const FBalanceTowerLayout& layout, float damageScale)
+{
+	for (auto& placement : layout.Towers) {
+		auto stats = Config.Towers.Find(placement.Tower);
+		if (!stats) {
+			UE_LOG(LogTemp, Warning, TEXT("Layout %s places tower %s, which isn't in the config"), *layout.Name, *placement.Tower.ToString());
+			continue;
+		}
+
+		auto tile = placement.Tile;
+		if (placement.RoadIndex != INDEX_NONE) {
+			if (Road.IsEmpty()) {
+				continue;
+			}
+
+			// The free tiles around that road tile, in the layout's neighbor order so the same Side is the same spot every run
+			const auto& roadTile = Road[FMath::Clamp(placement.RoadIndex, 0, Road.Num() - 1)];
+			FCoordinate2D candidates[FHexNeighbors::Num];
+			int32 numCandidates = 0;
+			ForEachHexNeighbor<FMapHexLayout>(roadTile, [&](const FCoordinate2D& neighbor) {
+				if (!RoadTiles.Contains(neighbor) && !TowerTiles.Contains(neighbor)) {
+					candidates[numCandidates++] = neighbor;
+				}
+			});
+
+			if (numCandidates == 0) {
+				UE_LOG(LogTemp, Verbose, TEXT("Layout %s: no room for %s next to road tile %d"), *layout.Name, *placement.Tower.ToString(), placement.RoadIndex);
+				continue;
+			}
+			tile = candidates[FMath::Abs(placement.Side) % numCandidates];
+		}
+
+		bool bIsAlreadyInSet = false;
+		TowerTiles.Add(tile, &bIsAlreadyInSet);
+		if (bIsAlreadyInSet) {
+			continue;
+		}
+
+		// Same as building on the road in game
+		if (RoadTiles.Contains(tile)) {
+			FlowField.SetTileBlocked(tile, true);
+		}
+
+		auto& tower = Towers.AddDefaulted_GetRef();
+		tower.Tile = tile;
+		tower.Damage = stats->Damage * damageScale;
+		tower.Range = FMath::Max(stats->Range, 0);
+		tower.FireInterval = FMath::Max(stats->FireInterval, MIN_FIRE_INTERVAL);
+	}
+}
+
+void FBalanceSimulation::PlayWave(const FBalanceWave& wave, float healthScale, FBalanceWaveResult& result)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BalanceSim_PlayWave);
+
+	const auto start = FPlatformTime::Seconds();
+
+	Spawns.Reset();
+	for (auto& group : wave.Groups) {
+		const auto typeId = EnemyTypeNames.IndexOfByKey(group.Enemy);
+		if (typeId == INDEX_NONE) {
+			UE_LOG(LogTemp, Warning, TEXT("Wave %d spawns enemy %s, which isn't in the config"), result.Wave, *group.Enemy.ToString());
+			continue;
+		}
+
+		for (int32 i = 0; i < group.Count; i++) {
+			Spawns.Add({ group.Delay + i * group.Interval, typeId });
+		}
+	}
+	Spawns.StableSort([](const FPendingSpawn& lhs, const FPendingSpawn& rhs) { return lhs.Time < rhs.Time; });
+
+	for (auto& tower : Towers) {
+		tower.Cooldown = 0.f;
+	}
+
+	const auto deltaTime = FMath::Max(Config.TimeStep, KINDA_SMALL_NUMBER);
+	auto time = 0.f;
+	auto nextSpawn = 0;
+	const auto headquartersHealthBefore = HeadquartersHealth;
+
+	while (HeadquartersHealth > 0 && (nextSpawn < Spawns.Num() || Enemies.Num() > 0)) {
+		if (time >= Config.MaxWaveSeconds || Road.IsEmpty()) {
+			result.bTimedOut = true;
+			break;
+		}
+
+		for (; nextSpawn < Spawns.Num() && Spawns[nextSpawn].Time <= time; nextSpawn++) {
+			auto& stats = *EnemyTypes[Spawns[nextSpawn].TypeId];
+
+			FEnemySpawnParams params;
+			params.TypeId = Spawns[nextSpawn].TypeId;
+			params.Tile = Road[0];
+			params.Speed = stats.Speed;
+			params.Health = stats.MaxHealth * healthScale;
+			Enemies.Spawn(params);
+			result.Spawned++;
+		}
+
+		ReachedGoal.Reset();
+		Enemies.Step(deltaTime, FlowField, ReachedGoal);
+		for (auto id : ReachedGoal) {
+			HeadquartersHealth -= EnemyTypes[Enemies.GetTypeId(id)]->Damage;
+			result.Leaked++;
+			Enemies.Remove(id);
+		}
+
+		FireTowers(deltaTime, result);
+
+		time += deltaTime;
+		result.Steps++;
+	}
+
+	// Whatever is left over after a timeout or a lost game doesn't carry into the next wave
+	Enemies.Reset();
+
+	result.HeadquartersDamage = headquartersHealthBefore - HeadquartersHealth;
+	result.HeadquartersHealth = FMath::Max(HeadquartersHealth, 0);
+	result.SimulatedSeconds = time;
+	result.WallSeconds = FPlatformTime::Seconds() - start;
+	INC_DWORD_STAT_BY(STAT_BalanceSim_Steps, result.Steps);
+}
+
+void FBalanceSimulation::FireTowers(float deltaTime, FBalanceWaveResult& result)
+{
+	if (Enemies.Num() == 0) {
+		for (auto& tower : Towers) {
+			tower.Cooldown = FMath::Max(tower.Cooldown - deltaTime, 0.f);
+		}
+		return;
+	}
+
+	for (auto& tower : Towers) {
+		tower.Cooldown -= deltaTime;
+
+		// Fast towers can get more than one shot per step
+		while (tower.Cooldown <= 0.f) {
+			const auto target = FindTarget(tower);
+			if (target == INDEX_NONE) {
+				tower.Cooldown = 0.f;
+				break;
+			}
+
+			if (Enemies.ApplyDamage(target, tower.Damage)) {
+				result.Killed++;
+				result.Bounty += EnemyTypes[Enemies.GetTypeId(target)]->Bounty;
+				Enemies.Remove(target);
+			}
+			tower.Cooldown += tower.FireInterval;
+		}
+	}
+}
+
+int32 FBalanceSimulation::FindTarget(const FTower& tower)
+{
+	QueryIds.Reset();
+	Enemies.GetSpatialIndex().Query(tower.Tile, tower.Range, QueryIds);
+
+	// Closest to the headquarters first, same as UEnemySimulationSubsystem::GetEnemiesInRange. Lowest id breaks ties
+	// so the order the index returns them in doesn't matter
+	auto best = INDEX_NONE;
+	auto bestTilesToGoal = TNumericLimits<int32>::Max();
+	for (auto id : QueryIds) {
+		auto tilesToGoal = Enemies.GetTilesToGoal(id);
+		if (tilesToGoal == INDEX_NONE) {
+			tilesToGoal = TNumericLimits<int32>::Max();
+		}
+
+		if (best == INDEX_NONE || tilesToGoal < bestTilesToGoal || (tilesToGoal == bestTilesToGoal && id < best)) {
+			best = id;
+			bestTilesToGoal = tilesToGoal;
+		}
+	}
+	return best;
+}
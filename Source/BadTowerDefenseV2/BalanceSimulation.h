@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "BalanceSimConfig.h"
+#include "EnemySimulation.h"
+#include "HexFlowField.h"
+#include "CoordinateHashMap.h"
+
+#include "CoreMinimal.h"
+
+/** One point of a balancing sweep */
+struct FBalanceRunParams {
+	int32 Seed = 0;
+	int32 LayoutIndex = INDEX_NONE;
+	float EnemyHealthScale = 1.f;
+	float TowerDamageScale = 1.f;
+};
+
+struct FBalanceWaveResult {
+	int32 Wave = 0;
+	int32 Spawned = 0;
+	int32 Killed = 0;
+	// Got to the headquarters
+	int32 Leaked = 0;
+	int32 HeadquartersDamage = 0;
+	// Left after the wave
+	int32 HeadquartersHealth = 0;
+	int32 Bounty = 0;
+	int32 Steps = 0;
+	float SimulatedSeconds = 0.f;
+	double WallSeconds = 0.0;
+	bool bTimedOut = false;
+};
+
+/**
+ * Plays the waves of a FBalanceSimConfig against a tower layout without a world: the map comes straight from the
+ * seed (same walk and chunk roads as the game), enemies move through FEnemySimulation on a FHexFlowField, and
+ * towers shoot the enemy in range closest to the headquarters. Time advances in fixed steps as fast as they can
+ * be computed, so the same run gives the same result on any machine.
+ *
+ * Instances share nothing but the (read only) config, so any number of them can run on different threads.
+ */
+class BADTOWERDEFENSEV2_API FBalanceSimulation
+{
+public:
+	explicit FBalanceSimulation(const FBalanceSimConfig& config);
+
+	/** Builds the map and plays every wave in order, until they're done or the headquarters falls. One result per wave played */
+	void Run(const FBalanceRunParams& params, TArray<FBalanceWaveResult>& outWaves);
+
+	int32 GetNumTowers() const { return Towers.Num(); }
+
+private:
+	struct FTower {
+		FCoordinate2D Tile;
+		float Damage = 0.f;
+		int32 Range = 0;
+		float FireInterval = 1.f;
+		// Until the next shot. Towers that had nothing to shoot at wait at zero
+		float Cooldown = 0.f;
+	};
+
+	struct FPendingSpawn {
+		float Time = 0.f;
+		int32 TypeId = 0;
+	};
+
+	void BuildMap(int32 seed);
+	void PlaceTowers(const FBalanceTowerLayout& layout, float damageScale);
+	void PlayWave(const FBalanceWave& wave, float healthScale, FBalanceWaveResult& result);
+	void FireTowers(float deltaTime, FBalanceWaveResult& result);
+	int32 FindTarget(const FTower& tower);
+
+	const FBalanceSimConfig& Config;
+
+	FHexFlowField FlowField;
+	FEnemySimulation Enemies;
+
+	// Road tiles from the spawn to the headquarters
+	TArray<FCoordinate2D> Road;
+	FCoordinateSet RoadTiles;
+	FCoordinateSet TowerTiles;
+	TArray<FTower> Towers;
+
+	// Indexed by the enemies' type id
+	TArray<FName> EnemyTypeNames;
+	TArray<const FEnemyUnitStats*> EnemyTypes;
+
+	int32 HeadquartersHealth = 0;
+
+	// Scratch, kept between waves
+	TArray<FPendingSpawn> Spawns;
+	TArray<int32> ReachedGoal;
+	TArray<int32> QueryIds;
+};
@@ -0,0 +1,310 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChunkFile.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+static_assert(PLATFORM_LITTLE_ENDIAN, "Chunk files are read and written in place, which assumes a little endian platform");
+
+static int32 GetWordsPerPlane(int32 dimensions)
+{
+	return FMath::DivideAndRoundUp(dimensions * dimensions, 64);
+}
+
+/// <summary>
+/// Header of a file with this many chunks and path tiles. Every offset only depends on those counts and the dimensions,
+/// so reading a file is just checking its header matches this
+/// </summary>
+static FChunkFileHeader MakeHeader(int32 seed, int32 dimensions, int32 numChunks, int32 numPathTiles)
+{
+	const auto tileGridSize = sizeof(uint64) * ChunkFile::NUM_TILE_TYPE_PLANES * GetWordsPerPlane(dimensions);
+
+	FChunkFileHeader header;
+	header.Dimensions = static_cast<uint16>(dimensions);
+	header.Seed = seed;
+	header.NumChunks = numChunks;
+	header.WalkOffset = sizeof(FChunkFileHeader);
+	header.RecordsOffset = Align(header.WalkOffset + sizeof(int32) * 2 * numChunks, 8);
+	header.TileGridsOffset = Align(header.RecordsOffset + sizeof(FChunkFileRecord) * numChunks, 8);
+	header.PathsOffset = header.TileGridsOffset + tileGridSize * numChunks;
+	header.NumPathTiles = numPathTiles;
+	header.FileSize = header.PathsOffset + sizeof(uint16) * numPathTiles;
+	return header;
+}
+
+bool FChunkFileView::Initialize(TConstArrayView<uint8> data)
+{
+	Header = nullptr;
+	Data = nullptr;
+
+	if (data.Num() < static_cast<int32>(sizeof(FChunkFileHeader))) {
+		return false;
+	}
+
+	const auto header = reinterpret_cast<const FChunkFileHeader*>(data.GetData());
+	if (header->Magic != ChunkFile::MAGIC || header->Version != ChunkFile::VERSION) {
+		UE_LOG(LogTemp, Warning, TEXT("Not a chunk file, or one of an unsupported version (%u)"), header->Version);
+		return false;
+	}
+	if (header->Dimensions < 1 || header->Dimensions > ChunkFile::MAX_DIMENSIONS || header->NumChunks < 0) {
+		return false;
+	}
+
+	// Keep the sizes in 64 bits so a corrupt count can't wrap around into something that looks right
+	const auto tileGridSize = static_cast<uint64>(sizeof(uint64)) * ChunkFile::NUM_TILE_TYPE_PLANES * GetWordsPerPlane(header->Dimensions);
+	const auto expectedSize = static_cast<uint64>(Align(sizeof(FChunkFileHeader) + sizeof(int32) * 2 * static_cast<uint64>(header->NumChunks), 8))
+		+ Align(sizeof(FChunkFileRecord) * static_cast<uint64>(header->NumChunks), 8)
+		+ tileGridSize * header->NumChunks
+		+ sizeof(uint16) * static_cast<uint64>(header->NumPathTiles);
+	if (expectedSize != static_cast<uint64>(data.Num()) || expectedSize != header->FileSize) {
+		UE_LOG(LogTemp, Warning, TEXT("Chunk file is truncated or corrupt (%d bytes, expected %llu)"), data.Num(), expectedSize);
+		return false;
+	}
+
+	// Files from other generators are still readable, see CanRegenerateChunks
+	auto expected = MakeHeader(header->Seed, header->Dimensions, header->NumChunks, header->NumPathTiles);
+	expected.GeneratorVersion = header->GeneratorVersion;
+	if (FMemory::Memcmp(header, &expected, sizeof(FChunkFileHeader)) != 0) {
+		return false;
+	}
+
+	// Records are small, so check them all now. Path tiles get checked per chunk when it's read
+	const auto numTiles = header->Dimensions * header->Dimensions;
+	const auto records = reinterpret_cast<const FChunkFileRecord*>(data.GetData() + header->RecordsOffset);
+	for (int32 i = 0; i < header->NumChunks; i++) {
+		const auto& record = records[i];
+		if (record.Entry >= numTiles || record.Exit >= numTiles
+			|| static_cast<uint64>(record.FirstPathTile) + record.PathLength > header->NumPathTiles) {
+			UE_LOG(LogTemp, Warning, TEXT("Chunk file record %d is corrupt"), i);
+			return false;
+		}
+	}
+
+	Header = header;
+	Data = data.GetData();
+	WordsPerPlane = GetWordsPerPlane(header->Dimensions);
+	return true;
+}
+
+FCoordinate2D FChunkFileView::ToLocalCoordinate(uint32 tileIndex) const
+{
+	return FCoordinate2D(tileIndex / Header->Dimensions, tileIndex % Header->Dimensions);
+}
+
+const FChunkFileRecord& FChunkFileView::GetRecord(int32 chunkIndex) const
+{
+	check(IsValid() && chunkIndex >= 0 && chunkIndex < Header->NumChunks);
+	return reinterpret_cast<const FChunkFileRecord*>(Data + Header->RecordsOffset)[chunkIndex];
+}
+
+const uint64* FChunkFileView::GetTileGrid(int32 chunkIndex) const
+{
+	check(IsValid() && chunkIndex >= 0 && chunkIndex < Header->NumChunks);
+	return reinterpret_cast<const uint64*>(Data + Header->TileGridsOffset) + chunkIndex * ChunkFile::NUM_TILE_TYPE_PLANES * WordsPerPlane;
+}
+
+FCoordinate2D FChunkFileView::GetChunkCoordinate(int32 chunkIndex) const
+{
+	check(IsValid() && chunkIndex >= 0 && chunkIndex < Header->NumChunks);
+	const auto walk = reinterpret_cast<const int32*>(Data + Header->WalkOffset);
+	return FCoordinate2D(walk[chunkIndex * 2], walk[chunkIndex * 2 + 1]);
+}
+
+void FChunkFileView::ReadChunkWalk(TArray<FCoordinate2D>& outChunkWalk) const
+{
+	outChunkWalk.Reset(GetNumChunks());
+	for (int32 i = 0; i < GetNumChunks(); i++) {
+		outChunkWalk.Add(GetChunkCoordinate(i));
+	}
+}
+
+FCoordinate2D FChunkFileView::GetEntry(int32 chunkIndex) const
+{
+	return ToLocalCoordinate(GetRecord(chunkIndex).Entry);
+}
+
+FCoordinate2D FChunkFileView::GetExit(int32 chunkIndex) const
+{
+	return ToLocalCoordinate(GetRecord(chunkIndex).Exit);
+}
+
+int32 FChunkFileView::GetPathLength(int32 chunkIndex) const
+{
+	return GetRecord(chunkIndex).PathLength;
+}
+
+FCoordinate2D FChunkFileView::GetPathTile(int32 chunkIndex, int32 pathIndex) const
+{
+	const auto& record = GetRecord(chunkIndex);
+	check(pathIndex >= 0 && pathIndex < record.PathLength);
+	const auto paths = reinterpret_cast<const uint16*>(Data + Header->PathsOffset);
+	return ToLocalCoordinate(paths[record.FirstPathTile + pathIndex]);
+}
+
+EHexTileType FChunkFileView::GetTileType(int32 chunkIndex, const FCoordinate2D& localTile) const
+{
+	const auto dimensions = GetDimensions();
+	check(localTile.X >= 0 && localTile.Y >= 0 && localTile.X < dimensions && localTile.Y < dimensions);
+
+	const auto tileIndex = localTile.X * dimensions + localTile.Y;
+	const auto word = tileIndex / 64;
+	const auto bit = tileIndex % 64;
+
+	const auto grid = GetTileGrid(chunkIndex);
+	uint8 type = 0;
+	for (int32 plane = 0; plane < ChunkFile::NUM_TILE_TYPE_PLANES; plane++) {
+		type |= ((grid[plane * WordsPerPlane + word] >> bit) & 1) << plane;
+	}
+	return type < static_cast<uint8>(EHexTileType::MAX) ? static_cast<EHexTileType>(type) : EHexTileType::Invalid;
+}
+
+bool FChunkFileView::ReadChunkPath(int32 chunkIndex, FChunkPath& outChunk) const
+{
+	const auto& record = GetRecord(chunkIndex);
+	const auto numTiles = GetDimensions() * GetDimensions();
+	const auto paths = reinterpret_cast<const uint16*>(Data + Header->PathsOffset) + record.FirstPathTile;
+
+	outChunk.ChunkCoordinate = GetChunkCoordinate(chunkIndex);
+	outChunk.Entry = ToLocalCoordinate(record.Entry);
+	outChunk.Exit = ToLocalCoordinate(record.Exit);
+	outChunk.Path.Reset(record.PathLength);
+	for (int32 i = 0; i < record.PathLength; i++) {
+		if (paths[i] >= numTiles) {
+			UE_LOG(LogTemp, Warning, TEXT("Chunk file path of chunk %d is corrupt"), chunkIndex);
+			outChunk.Path.Reset();
+			return false;
+		}
+		outChunk.Path.Add(ToLocalCoordinate(paths[i]));
+	}
+	return true;
+}
+
+void FChunkFileView::ReadTileTypes(int32 chunkIndex, TArray<EHexTileType>& outTileTypes) const
+{
+	const auto dimensions = GetDimensions();
+	outTileTypes.Reset(dimensions * dimensions);
+	for (int32 x = 0; x < dimensions; x++) {
+		for (int32 y = 0; y < dimensions; y++) {
+			outTileTypes.Add(GetTileType(chunkIndex, FCoordinate2D(x, y)));
+		}
+	}
+}
+
+FChunkFileWriter::FChunkFileWriter(TConstArrayView<FCoordinate2D> chunkWalk, int32 seed, int32 dimensions)
+	: ChunkWalk(chunkWalk)
+	, Seed(seed)
+	, Dimensions(FMath::Clamp(dimensions, 1, ChunkFile::MAX_DIMENSIONS))
+	, WordsPerPlane(GetWordsPerPlane(Dimensions))
+{
+	Records.Reserve(ChunkWalk.Num());
+	TileGrids.Reserve(ChunkWalk.Num() * ChunkFile::NUM_TILE_TYPE_PLANES * WordsPerPlane);
+}
+
+void FChunkFileWriter::AddChunk(const FChunkPath& chunk, TConstArrayView<EHexTileType> tileTypes)
+{
+	const auto numTiles = Dimensions * Dimensions;
+	auto toTileIndex = [this](const FCoordinate2D& tile) {
+		return static_cast<uint16>(FMath::Clamp(tile.X, 0, Dimensions - 1) * Dimensions + FMath::Clamp(tile.Y, 0, Dimensions - 1));
+	};
+
+	auto& record = Records.AddDefaulted_GetRef();
+	record.Entry = toTileIndex(chunk.Entry);
+	record.Exit = toTileIndex(chunk.Exit);
+	record.PathLength = static_cast<uint16>(FMath::Min(chunk.Path.Num(), static_cast<int32>(MAX_uint16)));
+	record.FirstPathTile = PathTiles.Num();
+	for (int32 i = 0; i < record.PathLength; i++) {
+		PathTiles.Add(toTileIndex(chunk.Path[i]));
+	}
+
+	const auto firstWord = TileGrids.AddZeroed(ChunkFile::NUM_TILE_TYPE_PLANES * WordsPerPlane);
+	auto setTileType = [&](int32 tileIndex, EHexTileType type) {
+		const auto word = tileIndex / 64;
+		const auto bit = 1ull << (tileIndex % 64);
+		for (int32 plane = 0; plane < ChunkFile::NUM_TILE_TYPE_PLANES; plane++) {
+			auto& planeWord = TileGrids[firstWord + plane * WordsPerPlane + word];
+			planeWord = (static_cast<uint8>(type) >> plane) & 1 ? planeWord | bit : planeWord & ~bit;
+		}
+	};
+
+	if (tileTypes.Num() == numTiles) {
+		for (int32 tileIndex = 0; tileIndex < numTiles; tileIndex++) {
+			setTileType(tileIndex, tileTypes[tileIndex]);
+		}
+	}
+	else {
+		for (int32 tileIndex = 0; tileIndex < numTiles; tileIndex++) {
+			setTileType(tileIndex, EHexTileType::Land);
+		}
+		for (int32 i = 0; i < record.PathLength; i++) {
+			setTileType(PathTiles[record.FirstPathTile + i], EHexTileType::Road);
+		}
+	}
+}
+
+TArray<uint8> FChunkFileWriter::Finish() const
+{
+	TArray<uint8> bytes;
+	if (Records.Num() != ChunkWalk.Num()) {
+		UE_LOG(LogTemp, Warning, TEXT("Chunk file has %d of %d chunks"), Records.Num(), ChunkWalk.Num());
+		return bytes;
+	}
+
+	const auto header = MakeHeader(Seed, Dimensions, ChunkWalk.Num(), PathTiles.Num());
+	bytes.SetNumZeroed(header.FileSize);
+
+	FMemory::Memcpy(bytes.GetData(), &header, sizeof(header));
+
+	auto walk = reinterpret_cast<int32*>(bytes.GetData() + header.WalkOffset);
+	for (int32 i = 0; i < ChunkWalk.Num(); i++) {
+		walk[i * 2] = ChunkWalk[i].X;
+		walk[i * 2 + 1] = ChunkWalk[i].Y;
+	}
+
+	FMemory::Memcpy(bytes.GetData() + header.RecordsOffset, Records.GetData(), Records.Num() * sizeof(FChunkFileRecord));
+	FMemory::Memcpy(bytes.GetData() + header.TileGridsOffset, TileGrids.GetData(), TileGrids.Num() * sizeof(uint64));
+	FMemory::Memcpy(bytes.GetData() + header.PathsOffset, PathTiles.GetData(), PathTiles.Num() * sizeof(uint16));
+	return bytes;
+}
+
+bool FChunkFileWriter::SaveToFile(const FString& fileName) const
+{
+	const auto bytes = Finish();
+	return !bytes.IsEmpty() && FFileHelper::SaveArrayToFile(bytes, *fileName);
+}
+
+FChunkFile::~FChunkFile()
+{
+	// The region has to go before the handle it was mapped from
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+}
+
+TUniquePtr<FChunkFile> FChunkFile::Open(const FString& fileName)
+{
+	TUniquePtr<FChunkFile> file(new FChunkFile());
+
+	auto& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+	file->MappedHandle.Reset(platformFile.OpenMapped(*fileName));
+	if (file->MappedHandle) {
+		file->MappedRegion.Reset(file->MappedHandle->MapRegion());
+	}
+
+	TConstArrayView<uint8> data;
+	if (file->MappedRegion) {
+		data = MakeArrayView(file->MappedRegion->GetMappedPtr(), static_cast<int32>(file->MappedRegion->GetMappedSize()));
+	}
+	else if (FFileHelper::LoadFileToArray(file->LoadedData, *fileName, FILEREAD_Silent)) {
+		data = file->LoadedData;
+	}
+	else {
+		return nullptr;
+	}
+
+	if (!file->View.Initialize(data)) {
+		return nullptr;
+	}
+	return file;
+}
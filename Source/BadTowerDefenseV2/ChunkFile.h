@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "FChunkPath.h"
+#include "HexTileType.h"
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Binary file holding a generated map: the chunk walk, every chunk's road and a tile type grid per chunk.
+ * Everything is fixed size or reached through an offset table, so a chunk can be read straight out of a memory
+ * mapped file without reading (or even paging in) any of the others.
+ *
+ * Layout, little endian, every section aligned to 8 bytes:
+ *   FChunkFileHeader
+ *   Walk        NumChunks x { int32 X, int32 Y }                   chunk coordinates
+ *   Records     NumChunks x FChunkFileRecord                      entry, exit and where the chunk's path is
+ *   Tile grids  NumChunks x 3 bit planes x ceil(dims^2 / 64) x uint64   bit b of a tile's type in plane b
+ *   Paths       uint16 local tile indices (X * dims + Y), in FChunkPath::Path order
+ *
+ * Bump ChunkFile::VERSION whenever the layout changes; older files are rejected rather than misread.
+ *
+ * The header also records which GENERATOR_VERSION wrote the roads. A file from an older generator still reads fine,
+ * but a corrupt chunk in it can't be regenerated: the generator would build a different road than the one saved.
+ */
+namespace ChunkFile
+{
+	constexpr uint32 MAGIC = 0x43445442; // "BTDC"
+	constexpr uint16 VERSION = 1;
+	// Bump whenever URandomWalkLibrary::GenerateChunkPath starts building different roads for the same seed
+	constexpr uint32 GENERATOR_VERSION = 1;
+	constexpr int32 NUM_TILE_TYPE_PLANES = 3;
+	constexpr int32 MAX_DIMENSIONS = 255;
+
+	static_assert(static_cast<int32>(EHexTileType::MAX) <= (1 << NUM_TILE_TYPE_PLANES), "Tile types don't fit the bit planes");
+}
+
+struct FChunkFileHeader {
+	uint32 Magic = ChunkFile::MAGIC;
+	uint16 Version = ChunkFile::VERSION;
+	uint16 Dimensions = 0;
+	int32 Seed = 0;
+	int32 NumChunks = 0;
+	uint32 WalkOffset = 0;
+	uint32 RecordsOffset = 0;
+	uint32 TileGridsOffset = 0;
+	uint32 PathsOffset = 0;
+	uint32 NumPathTiles = 0;
+	uint32 FileSize = 0;
+	uint32 GeneratorVersion = ChunkFile::GENERATOR_VERSION;
+	uint32 Padding = 0;
+};
+
+struct FChunkFileRecord {
+	uint16 Entry = 0;
+	uint16 Exit = 0;
+	uint16 PathLength = 0;
+	uint16 Padding = 0;
+	// Index of the chunk's first tile in the paths section
+	uint32 FirstPathTile = 0;
+};
+
+static_assert(sizeof(FChunkFileHeader) == 48 && sizeof(FChunkFileRecord) == 12, "Chunk file structs are written as is");
+
+/**
+ * Read-only view over the bytes of a chunk file, wherever they live (a mapped file, a loaded array, a pak).
+ * Nothing is copied: every accessor reads straight from the underlying memory, which has to outlive the view.
+ *
+ * Initialize checks the whole header and offset table once, after that the accessors only check() their arguments.
+ */
+class BADTOWERDEFENSEV2_API FChunkFileView
+{
+public:
+	/** Returns false (and leaves the view empty) if data isn't a valid chunk file of a version we can read */
+	bool Initialize(TConstArrayView<uint8> data);
+
+	bool IsValid() const { return Header != nullptr; }
+
+	int32 GetNumChunks() const { return Header->NumChunks; }
+	int32 GetDimensions() const { return Header->Dimensions; }
+	int32 GetSeed() const { return Header->Seed; }
+	uint32 GetGeneratorVersion() const { return Header->GeneratorVersion; }
+
+	/** Whether GenerateChunkPath rebuilds this file's roads exactly, i.e. whether a corrupt chunk may be regenerated */
+	bool CanRegenerateChunks() const { return Header->GeneratorVersion == ChunkFile::GENERATOR_VERSION; }
+
+	FCoordinate2D GetChunkCoordinate(int32 chunkIndex) const;
+	void ReadChunkWalk(TArray<FCoordinate2D>& outChunkWalk) const;
+
+	FCoordinate2D GetEntry(int32 chunkIndex) const;
+	FCoordinate2D GetExit(int32 chunkIndex) const;
+	int32 GetPathLength(int32 chunkIndex) const;
+	FCoordinate2D GetPathTile(int32 chunkIndex, int32 pathIndex) const;
+
+	/** localTile is a chunk-local coordinate */
+	EHexTileType GetTileType(int32 chunkIndex, const FCoordinate2D& localTile) const;
+
+	/** Decodes one chunk, reusing outChunk's path array. False if its path is corrupt */
+	bool ReadChunkPath(int32 chunkIndex, FChunkPath& outChunk) const;
+
+	/** Every tile type of a chunk, indexed like UMapUtilitiesLibrary::ConvertCoordinatesToIndex */
+	void ReadTileTypes(int32 chunkIndex, TArray<EHexTileType>& outTileTypes) const;
+
+private:
+	FCoordinate2D ToLocalCoordinate(uint32 tileIndex) const;
+	const FChunkFileRecord& GetRecord(int32 chunkIndex) const;
+	const uint64* GetTileGrid(int32 chunkIndex) const;
+
+	const FChunkFileHeader* Header = nullptr;
+	const uint8* Data = nullptr;
+	int32 WordsPerPlane = 0;
+};
+
+/**
+ * Builds a chunk file in memory. Chunks have to be added in walk order, one for every chunk of the walk.
+ */
+class BADTOWERDEFENSEV2_API FChunkFileWriter
+{
+public:
+	FChunkFileWriter(TConstArrayView<FCoordinate2D> chunkWalk, int32 seed, int32 dimensions = 8);
+
+	/** tileTypes is indexed like UMapUtilitiesLibrary::ConvertCoordinatesToIndex. Leave it empty for road on the path and land everywhere else */
+	void AddChunk(const FChunkPath& chunk, TConstArrayView<EHexTileType> tileTypes = {});
+
+	/** The finished file, or an empty array if chunks are missing */
+	TArray<uint8> Finish() const;
+
+	bool SaveToFile(const FString& fileName) const;
+
+private:
+	TArray<FCoordinate2D> ChunkWalk;
+	int32 Seed;
+	int32 Dimensions;
+	int32 WordsPerPlane;
+
+	TArray<FChunkFileRecord> Records;
+	TArray<uint64> TileGrids;
+	TArray<uint16> PathTiles;
+};
+
+/**
+ * A chunk file on disk, memory mapped where the platform supports it and loaded into memory where it doesn't.
+ * Either way GetView hands out a zero-copy view that stays valid for as long as this object lives.
+ */
+class BADTOWERDEFENSEV2_API FChunkFile
+{
+public:
+	~FChunkFile();
+
+	/** Null if the file is missing or isn't a valid chunk file */
+	static TUniquePtr<FChunkFile> Open(const FString& fileName);
+
+	const FChunkFileView& GetView() const { return View; }
+	bool IsMapped() const { return MappedRegion != nullptr; }
+
+private:
+	FChunkFile() = default;
+
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	// Only used where mapping isn't available
+	TArray<uint8> LoadedData;
+
+	FChunkFileView View;
+};
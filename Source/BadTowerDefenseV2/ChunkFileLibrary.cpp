@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChunkFileLibrary.h"
+#include "ChunkFile.h"
+#include "RandomWalkLibrary.h"
+
+#include "Misc/Paths.h"
+
+bool UChunkFileLibrary::SaveChunkFile(const FString& fileName, const TArray<FCoordinate2D>& chunkWalk, int32 seed, const TArray<FChunkPath>& chunks, int32 dimensions)
+{
+	if (chunks.Num() != chunkWalk.Num()) {
+		UE_LOG(LogTemp, Warning, TEXT("Can't save %d chunks for a walk of %d"), chunks.Num(), chunkWalk.Num());
+		return false;
+	}
+
+	FChunkFileWriter writer(chunkWalk, seed, dimensions);
+	for (auto& chunk : chunks) {
+		writer.AddChunk(chunk);
+	}
+	return writer.SaveToFile(fileName);
+}
+
+bool UChunkFileLibrary::SaveGeneratedMap(const FString& fileName, const TArray<FCoordinate2D>& chunkWalk, int32 seed, int32 dimensions)
+{
+	return SaveChunkFile(fileName, chunkWalk, seed, URandomWalkLibrary::GenerateChunkPaths(chunkWalk, seed, dimensions), dimensions);
+}
+
+bool UChunkFileLibrary::LoadChunkFile(const FString& fileName, TArray<FCoordinate2D>& outChunkWalk, int32& outSeed, TArray<FChunkPath>& outChunks, int32& outDimensions)
+{
+	auto file = FChunkFile::Open(fileName);
+	if (!file) {
+		return false;
+	}
+
+	auto& view = file->GetView();
+	view.ReadChunkWalk(outChunkWalk);
+	outSeed = view.GetSeed();
+	outDimensions = view.GetDimensions();
+
+	outChunks.SetNum(view.GetNumChunks());
+	for (int32 i = 0; i < outChunks.Num(); i++) {
+		if (view.ReadChunkPath(i, outChunks[i])) {
+			continue;
+		}
+
+		if (!view.CanRegenerateChunks()) {
+			UE_LOG(LogTemp, Error, TEXT("Chunk %d of %s is corrupt and the file is from generator version %u, which this build can't regenerate"), i, *fileName, view.GetGeneratorVersion());
+			outChunks.Reset();
+			return false;
+		}
+		outChunks[i] = URandomWalkLibrary::GenerateChunkPath(outChunkWalk, i, outSeed, outDimensions);
+	}
+	return true;
+}
+
+FString UChunkFileLibrary::GetCachedMapFileName(int32 seed, int32 mapSize, int32 dimensions)
+{
+	return FPaths::ProjectSavedDir() / TEXT("Maps") / FString::Printf(TEXT("%d_%d_%d.btdc"), seed, mapSize, dimensions);
+}
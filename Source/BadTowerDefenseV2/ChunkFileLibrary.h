@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "FChunkPath.h"
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "ChunkFileLibrary.generated.h"
+
+/**
+ * Blueprint access to chunk files (see ChunkFile.h), for resuming a run, caching seeds and menu backdrops
+ */
+UCLASS()
+class BADTOWERDEFENSEV2_API UChunkFileLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/** Saves already generated chunks, one per chunk of the walk in walk order */
+	UFUNCTION(BlueprintCallable, Category = "Chunk File")
+	static bool SaveChunkFile(const FString& fileName, const TArray<FCoordinate2D>& chunkWalk, int32 seed, const TArray<FChunkPath>& chunks, int32 dimensions = 8);
+
+	/** Generates every chunk of the walk and saves them, so the seed never has to be generated again */
+	UFUNCTION(BlueprintCallable, Category = "Chunk File")
+	static bool SaveGeneratedMap(const FString& fileName, const TArray<FCoordinate2D>& chunkWalk, int32 seed, int32 dimensions = 8);
+
+	/**
+	 * Reads the whole map back. To only read the chunks in view, stream it with UChunkStreamingSubsystem::StartStreamingFromFile.
+	 * Corrupt chunks are regenerated if the file was written by this generator version, otherwise loading fails
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chunk File")
+	static bool LoadChunkFile(const FString& fileName, TArray<FCoordinate2D>& outChunkWalk, int32& outSeed, TArray<FChunkPath>& outChunks, int32& outDimensions);
+
+	/** Where the map of a seed gets cached, under the project's saved directory */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chunk File")
+	static FString GetCachedMapFileName(int32 seed, int32 mapSize, int32 dimensions = 8);
+};
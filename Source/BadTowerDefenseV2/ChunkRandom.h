@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+
+#include "CoreMinimal.h"
+
+// Salts so each kind of decision made for a chunk gets its own sequence
+enum class EChunkRandomPurpose : uint32 {
+	Crossing = 1,
+	OpenEntry,
+	OpenExit,
+	Path,
+};
+
+/**
+ * Counter-based random numbers for chunk generation (SplitMix64). The n-th number is a pure function of
+ * (world seed, chunk coordinate, purpose, n), so any chunk can be generated on its own, in any order and on
+ * any thread, and always comes out the same.
+ *
+ * Use the indexed overloads to draw a specific number directly, or the others to draw the next one in
+ * sequence like FRandomStream does.
+ */
+struct FChunkRandom {
+	FChunkRandom(int32 seed, const FCoordinate2D& chunkCoordinate, EChunkRandomPurpose purpose)
+		: Key(FCoordinate2D::MixPackedKey(FCoordinate2D::MixPackedKey(static_cast<uint64>(static_cast<uint32>(seed)) << 32 | static_cast<uint32>(purpose)) + chunkCoordinate.ToPackedKey()))
+	{
+	}
+
+	uint64 GetUInt64(uint64 index) const {
+		return FCoordinate2D::MixPackedKey(Key + (index + 1) * 0x9E3779B97F4A7C15ull);
+	}
+
+	/** Number in [min, max], both inclusive */
+	int32 RandRange(uint64 index, int32 min, int32 max) const {
+		if (max <= min) {
+			return min;
+		}
+
+		// Scale the top 32 bits onto the range instead of using %, which would favor the low end
+		const auto range = static_cast<uint64>(static_cast<int64>(max) - min + 1);
+		return static_cast<int32>(min + static_cast<int64>(((GetUInt64(index) >> 32) * range) >> 32));
+	}
+
+	uint64 GetUInt64() const {
+		return GetUInt64(Counter++);
+	}
+
+	int32 RandRange(int32 min, int32 max) const {
+		return RandRange(Counter++, min, max);
+	}
+
+	/** How many numbers have been drawn in sequence so far */
+	uint64 GetCounter() const { return Counter; }
+
+private:
+	uint64 Key;
+
+	// Mutable for the same reason as FRandomStream's seed: drawing in sequence from a const stream is fine
+	mutable uint64 Counter = 0;
+};
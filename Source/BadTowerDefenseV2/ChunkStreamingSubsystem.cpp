@@ -0,0 +1,255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChunkStreamingSubsystem.h"
+#include "RandomWalkLibrary.h"
+#include "MapGenStats.h"
+
+void UChunkStreamingSubsystem::Deinitialize()
+{
+	StopStreaming();
+	Super::Deinitialize();
+}
+
+bool UChunkStreamingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UChunkStreamingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UChunkStreamingSubsystem, STATGROUP_Tickables);
+}
+
+void UChunkStreamingSubsystem::StartStreaming(const TArray<FCoordinate2D>& chunkWalk, int32 seed, int32 dimensions)
+{
+	StopStreaming();
+
+	ChunkWalk = MakeShared<const TArray<FCoordinate2D>>(chunkWalk);
+	Seed = seed;
+	Dimensions = dimensions;
+	CameraChunkIndex = 0;
+	EnemyFrontChunkIndex = 0;
+
+	ChunksAhead = FMath::Max(ChunksAhead, 0);
+	ChunksBehind = FMath::Max(ChunksBehind, 0);
+	MaxTasksInFlight = FMath::Max(MaxTasksInFlight, 1);
+
+	// Both focus windows have to fit, otherwise we'd evict chunks we're about to ask for again
+	const auto windowSize = ChunksBehind + ChunksAhead + 1;
+	MaxResidentChunks = FMath::Max(MaxResidentChunks, windowSize * 2);
+	Resident.Empty(MaxResidentChunks);
+}
+
+bool UChunkStreamingSubsystem::StartStreamingFromFile(const FString& fileName)
+{
+	TSharedPtr<const FChunkFile> chunkFile(FChunkFile::Open(fileName).Release());
+	if (!chunkFile.IsValid()) {
+		UE_LOG(LogTemp, Warning, TEXT("Couldn't open chunk file %s"), *fileName);
+		return false;
+	}
+
+	auto& view = chunkFile->GetView();
+	TArray<FCoordinate2D> chunkWalk;
+	view.ReadChunkWalk(chunkWalk);
+	StartStreaming(chunkWalk, view.GetSeed(), view.GetDimensions());
+
+	ChunkFile = chunkFile;
+	return true;
+}
+
+void UChunkStreamingSubsystem::StopStreaming()
+{
+	// Anything still generating only holds on to its own references to the walk and file, so it's safe to just drop it
+	Pending.Reset();
+	FailedChunks.Reset();
+
+	if (ChunkWalk.IsValid()) {
+		while (Resident.Num() > 0) {
+			EvictLeastRecentChunk();
+		}
+	}
+	ChunkWalk.Reset();
+	ChunkFile.Reset();
+
+	SET_DWORD_STAT(STAT_MapGen_ResidentChunks, 0);
+	SET_DWORD_STAT(STAT_MapGen_PendingChunks, 0);
+}
+
+void UChunkStreamingSubsystem::SetFocus(int32 cameraChunkIndex, int32 enemyFrontChunkIndex)
+{
+	CameraChunkIndex = cameraChunkIndex;
+	EnemyFrontChunkIndex = enemyFrontChunkIndex;
+}
+
+int32 UChunkStreamingSubsystem::FindChunkIndex(const FCoordinate2D& chunkCoordinate, int32 searchHint) const
+{
+	if (!ChunkWalk.IsValid()) {
+		return INDEX_NONE;
+	}
+
+	auto& walk = *ChunkWalk;
+	searchHint = FMath::Clamp(searchHint, 0, FMath::Max(walk.Num() - 1, 0));
+	for (int32 distance = 0; distance < walk.Num(); distance++) {
+		const auto after = searchHint + distance;
+		if (after < walk.Num() && walk[after] == chunkCoordinate) {
+			return after;
+		}
+
+		const auto before = searchHint - distance;
+		if (before >= 0 && walk[before] == chunkCoordinate) {
+			return before;
+		}
+
+		if (after >= walk.Num() && before < 0) {
+			break;
+		}
+	}
+	return INDEX_NONE;
+}
+
+bool UChunkStreamingSubsystem::GetResidentChunk(const FCoordinate2D& chunkCoordinate, FChunkPath& outChunk) const
+{
+	auto resident = Resident.Find(chunkCoordinate);
+	if (!resident) {
+		return false;
+	}
+
+	outChunk = resident->Chunk;
+	return true;
+}
+
+bool UChunkStreamingSubsystem::IsChunkResident(const FCoordinate2D& chunkCoordinate) const
+{
+	return Resident.Contains(chunkCoordinate);
+}
+
+int32 UChunkStreamingSubsystem::GetNumResidentChunks() const
+{
+	return Resident.Num();
+}
+
+bool UChunkStreamingSubsystem::IsInFocus(int32 chunkIndex) const
+{
+	auto inWindow = [this, chunkIndex](int32 focus) {
+		return chunkIndex >= focus - ChunksBehind && chunkIndex <= focus + ChunksAhead;
+	};
+	return inWindow(CameraChunkIndex) || inWindow(EnemyFrontChunkIndex);
+}
+
+/// <summary>
+/// Every chunk in either focus window, nearest to a focus first. Each chunk shows up once
+/// </summary>
+void UChunkStreamingSubsystem::GatherWantedChunks(TArray<int32>& outChunkIndices) const
+{
+	outChunkIndices.Reset();
+
+	const auto numChunks = ChunkWalk->Num();
+	const auto maxDistance = FMath::Max(ChunksAhead, ChunksBehind);
+	for (int32 distance = 0; distance <= maxDistance; distance++) {
+		for (auto focus : { CameraChunkIndex, EnemyFrontChunkIndex }) {
+			for (auto chunkIndex : { focus + distance, focus - distance }) {
+				if (chunkIndex >= 0 && chunkIndex < numChunks && IsInFocus(chunkIndex)) {
+					outChunkIndices.AddUnique(chunkIndex);
+				}
+			}
+		}
+	}
+}
+
+void UChunkStreamingSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!ChunkWalk.IsValid()) {
+		return;
+	}
+
+	MAPGEN_SCOPE(ChunkStreaming);
+
+	auto& walk = *ChunkWalk;
+
+	// Pick up finished chunks. Ones that went out of focus while generating are still worth keeping if there's room
+	int32 nodesExpanded = 0;
+	int32 chunksBuilt = 0;
+	for (int32 i = Pending.Num() - 1; i >= 0; i--) {
+		auto& pending = Pending[i];
+		if (!pending.Task.IsCompleted()) {
+			continue;
+		}
+
+		auto& generated = pending.Task.GetResult();
+		nodesExpanded += generated.NodesExpanded;
+		chunksBuilt++;
+
+		if (generated.bFailed) {
+			UE_LOG(LogTemp, Error, TEXT("Chunk %d is corrupt in the chunk file, which is from generator version %u. It can't be regenerated and won't load"),
+				pending.ChunkIndex, ChunkFile->GetView().GetGeneratorVersion());
+			FailedChunks.Add(pending.ChunkIndex);
+		}
+		else if (IsInFocus(pending.ChunkIndex) || Resident.Num() < MaxResidentChunks) {
+			AddResidentChunk(pending.ChunkIndex, MoveTemp(generated.Chunk));
+		}
+		Pending.RemoveAtSwap(i, 1, false);
+	}
+	MAPGEN_COUNTER_ADD(NodesExpanded, nodesExpanded);
+	MAPGEN_COUNTER_ADD(ChunksBuilt, chunksBuilt);
+
+	GatherWantedChunks(WantedChunks);
+
+	// Touch resident chunks furthest first, so the nearest ones end up most recently used
+	for (int32 i = WantedChunks.Num() - 1; i >= 0; i--) {
+		Resident.FindAndTouch(walk[WantedChunks[i]]);
+	}
+
+	// Queue up whatever's missing, nearest first
+	for (auto chunkIndex : WantedChunks) {
+		if (Pending.Num() >= MaxTasksInFlight) {
+			break;
+		}
+		if (Resident.Contains(walk[chunkIndex]) || FailedChunks.Contains(chunkIndex) || Pending.ContainsByPredicate([chunkIndex](const FPendingChunk& pending) { return pending.ChunkIndex == chunkIndex; })) {
+			continue;
+		}
+
+		auto& pending = Pending.AddDefaulted_GetRef();
+		pending.ChunkIndex = chunkIndex;
+		pending.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [walkRef = ChunkWalk.ToSharedRef(), chunkFile = ChunkFile, chunkIndex, seed = Seed, dimensions = Dimensions] {
+			FGeneratedChunk generated;
+			if (chunkFile.IsValid() && chunkFile->GetView().ReadChunkPath(chunkIndex, generated.Chunk)) {
+				return generated;
+			}
+
+			// Only a file from this generator version would get back the road it should have had
+			if (chunkFile.IsValid() && !chunkFile->GetView().CanRegenerateChunks()) {
+				generated.bFailed = true;
+				return generated;
+			}
+			generated.Chunk = URandomWalkLibrary::GenerateChunkPath(*walkRef, chunkIndex, seed, dimensions, &generated.NodesExpanded);
+			return generated;
+		});
+	}
+
+	SET_DWORD_STAT(STAT_MapGen_ResidentChunks, Resident.Num());
+	SET_DWORD_STAT(STAT_MapGen_PendingChunks, Pending.Num());
+}
+
+void UChunkStreamingSubsystem::AddResidentChunk(int32 chunkIndex, FChunkPath&& chunk)
+{
+	// Evict ourselves rather than letting the cache do it, so listeners hear about it
+	if (!Resident.Contains(chunk.ChunkCoordinate) && Resident.Num() >= Resident.Max()) {
+		EvictLeastRecentChunk();
+	}
+
+	FResidentChunk resident;
+	resident.ChunkIndex = chunkIndex;
+	resident.Chunk = MoveTemp(chunk);
+	Resident.Add(resident.Chunk.ChunkCoordinate, resident);
+
+	OnChunkLoaded.Broadcast(chunkIndex, resident.Chunk);
+}
+
+void UChunkStreamingSubsystem::EvictLeastRecentChunk()
+{
+	auto evicted = Resident.RemoveLeastRecent();
+	OnChunkEvicted.Broadcast(evicted.ChunkIndex, evicted.Chunk);
+}
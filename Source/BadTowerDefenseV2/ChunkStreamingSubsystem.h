@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "FChunkPath.h"
+#include "ChunkFile.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Containers/LruCache.h"
+#include "Tasks/Task.h"
+#include "ChunkStreamingSubsystem.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnChunkStreamingEvent, int32, ChunkIndex, const FChunkPath&, Chunk);
+
+/**
+ * Streams chunk paths in and out around the camera and the enemy front instead of building the whole map up front.
+ *
+ * Chunks within ChunksBehind / ChunksAhead of either focus are generated on background tasks (nearest first) and
+ * kept in an LRU cache keyed by chunk coordinate. Chunks in range are touched every tick, so once the cache is full
+ * the ones that fall out of range are evicted first. Every chunk only depends on the walk, the seed and its index
+ * (see URandomWalkLibrary::GenerateChunkPath), so a chunk that comes back in range is regenerated identically.
+ *
+ * Listen to OnChunkLoaded / OnChunkEvicted to spawn and destroy whatever represents a chunk in the world.
+ */
+UCLASS()
+class BADTOWERDEFENSEV2_API UChunkStreamingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Starts streaming the chunks of chunkWalk (e.g. from URandomWalkLibrary::SelfAvoidingWalk), dropping whatever was streamed before */
+	UFUNCTION(BlueprintCallable, Category = "Chunk Streaming")
+	void StartStreaming(const TArray<FCoordinate2D>& chunkWalk, int32 seed, int32 dimensions = 8);
+
+	/**
+	 * Same as StartStreaming, reading chunks out of a chunk file (see FChunkFileWriter) instead of generating them.
+	 * The file stays mapped while streaming and only the chunks in focus are ever decoded. False if it can't be opened.
+	 * Corrupt chunks are regenerated if the file is from this generator version, otherwise they never load
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chunk Streaming")
+	bool StartStreamingFromFile(const FString& fileName);
+
+	UFUNCTION(BlueprintCallable, Category = "Chunk Streaming")
+	void StopStreaming();
+
+	/** Walk indices of the chunk the camera is looking at and the furthest chunk enemies have reached */
+	UFUNCTION(BlueprintCallable, Category = "Chunk Streaming")
+	void SetFocus(int32 cameraChunkIndex, int32 enemyFrontChunkIndex);
+
+	/**
+	 * Index of chunkCoordinate in the walk, or INDEX_NONE. Searches outwards from searchHint (e.g. the current camera
+	 * focus), so looking up a chunk near the focus is cheap no matter how long the walk is.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chunk Streaming")
+	int32 FindChunkIndex(const FCoordinate2D& chunkCoordinate, int32 searchHint = 0) const;
+
+	/** Copies out a chunk if it's resident. Doesn't count as a use for the LRU cache */
+	UFUNCTION(BlueprintCallable, Category = "Chunk Streaming")
+	bool GetResidentChunk(const FCoordinate2D& chunkCoordinate, FChunkPath& outChunk) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chunk Streaming")
+	bool IsChunkResident(const FCoordinate2D& chunkCoordinate) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chunk Streaming")
+	int32 GetNumResidentChunks() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chunk Streaming")
+	int32 GetNumPendingChunks() const { return Pending.Num(); }
+
+	/** Chunks that were corrupt in the file and couldn't be regenerated */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Chunk Streaming")
+	int32 GetNumFailedChunks() const { return FailedChunks.Num(); }
+
+	UPROPERTY(BlueprintAssignable, Category = "Chunk Streaming")
+	FOnChunkStreamingEvent OnChunkLoaded;
+
+	UPROPERTY(BlueprintAssignable, Category = "Chunk Streaming")
+	FOnChunkStreamingEvent OnChunkEvicted;
+
+	// How many chunks past each focus (further along the walk) to keep resident
+	UPROPERTY(BlueprintReadWrite, Category = "Chunk Streaming")
+	int32 ChunksAhead = 4;
+
+	// How many chunks before each focus to keep resident
+	UPROPERTY(BlueprintReadWrite, Category = "Chunk Streaming")
+	int32 ChunksBehind = 2;
+
+	// Upper bound on resident chunks. Raised to fit both focus windows when streaming starts
+	UPROPERTY(BlueprintReadWrite, Category = "Chunk Streaming")
+	int32 MaxResidentChunks = 32;
+
+	// Background generation tasks allowed in flight at once
+	UPROPERTY(BlueprintReadWrite, Category = "Chunk Streaming")
+	int32 MaxTasksInFlight = 4;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FResidentChunk {
+		int32 ChunkIndex = INDEX_NONE;
+		FChunkPath Chunk;
+	};
+
+	struct FGeneratedChunk {
+		FChunkPath Chunk;
+		int32 NodesExpanded = 0;
+		bool bFailed = false;
+	};
+
+	struct FPendingChunk {
+		int32 ChunkIndex = INDEX_NONE;
+		UE::Tasks::TTask<FGeneratedChunk> Task;
+	};
+
+	bool IsInFocus(int32 chunkIndex) const;
+	void GatherWantedChunks(TArray<int32>& outChunkIndices) const;
+	void AddResidentChunk(int32 chunkIndex, FChunkPath&& chunk);
+	void EvictLeastRecentChunk();
+
+	// Shared with the generation tasks, which may outlive a StopStreaming
+	TSharedPtr<const TArray<FCoordinate2D>> ChunkWalk;
+	// Set when streaming from a file instead of generating
+	TSharedPtr<const FChunkFile> ChunkFile;
+	int32 Seed = 0;
+	int32 Dimensions = 8;
+
+	int32 CameraChunkIndex = 0;
+	int32 EnemyFrontChunkIndex = 0;
+
+	TLruCache<FCoordinate2D, FResidentChunk> Resident;
+	TArray<FPendingChunk> Pending;
+	// Never asked for again until streaming restarts
+	TSet<int32> FailedChunks;
+
+	// Scratch for Tick
+	TArray<int32> WantedChunks;
+};
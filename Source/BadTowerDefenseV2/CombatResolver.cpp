@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatResolver.h"
+
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("Combat"), STATGROUP_Combat, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Resolve"), STAT_Combat_Resolve, STATGROUP_Combat);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hits Resolved"), STAT_Combat_Hits, STATGROUP_Combat);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Deaths"), STAT_Combat_Deaths, STATGROUP_Combat);
+
+void FCombatResolver::Reset()
+{
+	Health.Reset();
+	MaxHealth.Reset();
+	Armor.Reset();
+	PendingDamage.Reset();
+	Reward.Reset();
+	LastHitBy.Reset();
+	Live.Reset();
+	WasHit.Reset();
+
+	FreeIds.Reset();
+	RemovedIds.Reset();
+	NumLive = 0;
+
+	HitTargets.Reset();
+	HitInstigators.Reset();
+	HitDamage.Reset();
+	HitCombatants.Reset();
+}
+
+int32 FCombatResolver::AddCombatant(const FCombatantParams& params)
+{
+	auto id = INDEX_NONE;
+	if (!FreeIds.IsEmpty()) {
+		id = FreeIds.Pop(false);
+	}
+	else {
+		id = Health.AddUninitialized();
+		MaxHealth.AddUninitialized();
+		Armor.AddUninitialized();
+		PendingDamage.AddUninitialized();
+		Reward.AddUninitialized();
+		LastHitBy.AddUninitialized();
+		Live.AddUninitialized();
+		WasHit.AddUninitialized();
+	}
+
+	Health[id] = params.MaxHealth;
+	MaxHealth[id] = params.MaxHealth;
+	Armor[id] = FMath::Max(params.Armor, 0.f);
+	PendingDamage[id] = 0.f;
+	Reward[id] = params.Reward;
+	LastHitBy[id] = INDEX_NONE;
+	Live[id] = true;
+	WasHit[id] = false;
+	NumLive++;
+
+	return id;
+}
+
+void FCombatResolver::RemoveCombatant(int32 id)
+{
+	if (!IsValid(id)) {
+		return;
+	}
+
+	// Zero health makes the apply pass leave it alone and any hit still queued against it get dropped
+	Live[id] = false;
+	Health[id] = 0.f;
+	RemovedIds.Add(id);
+	NumLive--;
+}
+
+void FCombatResolver::QueueHit(int32 target, float damage, int32 instigator)
+{
+	if (!IsAlive(target) || damage <= 0.f) {
+		return;
+	}
+
+	HitTargets.Add(target);
+	HitInstigators.Add(instigator);
+	HitDamage.Add(damage);
+}
+
+void FCombatResolver::SetHealth(int32 id, float health)
+{
+	if (IsValid(id)) {
+		Health[id] = FMath::Clamp(health, 0.f, MaxHealth[id]);
+	}
+}
+
+void FCombatResolver::SetArmor(int32 id, float armor)
+{
+	if (IsValid(id)) {
+		Armor[id] = FMath::Max(armor, 0.f);
+	}
+}
+
+void FCombatResolver::Resolve(TArray<FCombatDeath>& outDeaths)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Combat_Resolve);
+
+	// Hits queued against removed combatants were dropped when they were queued or get dropped below, so their ids
+	// can be handed out again. Done first so it happens on ticks without hits too
+	FreeIds.Append(RemovedIds);
+	RemovedIds.Reset();
+
+	const auto numHits = HitTargets.Num();
+	if (numHits == 0) {
+		return;
+	}
+	INC_DWORD_STAT_BY(STAT_Combat_Hits, numHits);
+
+	// 1. Armor, one multiply per hit. The only gather is the target's armor
+	auto hitDamage = HitDamage.GetData();
+	auto hitTargets = HitTargets.GetData();
+	auto armor = Armor.GetData();
+	for (int32 i = 0; i < numHits; i++) {
+		hitDamage[i] *= 100.f / (100.f + armor[hitTargets[i]]);
+	}
+
+	// 2. Sum the hits per target. Targets that died or were removed since their hit was queued get nothing
+	for (int32 i = 0; i < numHits; i++) {
+		const auto target = hitTargets[i];
+		if (Health[target] <= 0.f) {
+			continue;
+		}
+
+		PendingDamage[target] += hitDamage[i];
+		LastHitBy[target] = HitInstigators[i];
+		if (!WasHit[target]) {
+			WasHit[target] = true;
+			HitCombatants.Add(target);
+		}
+	}
+
+	// 3. Every combatant at once, no branches. Free slots have zero health and zero pending damage
+	auto health = Health.GetData();
+	auto pendingDamage = PendingDamage.GetData();
+	const auto numCombatants = Health.Num();
+	for (int32 id = 0; id < numCombatants; id++) {
+		health[id] = FMath::Max(health[id] - pendingDamage[id], 0.f);
+		pendingDamage[id] = 0.f;
+	}
+
+	// Anyone hit this tick who's at zero now died this tick, step 2 skipped the ones that were dead already
+	for (auto id : HitCombatants) {
+		WasHit[id] = false;
+		if (health[id] <= 0.f) {
+			auto& death = outDeaths.AddDefaulted_GetRef();
+			death.Id = id;
+			death.Killer = LastHitBy[id];
+			death.Reward = Reward[id];
+			INC_DWORD_STAT(STAT_Combat_Deaths);
+		}
+	}
+
+	HitTargets.Reset();
+	HitInstigators.Reset();
+	HitDamage.Reset();
+	HitCombatants.Reset();
+}
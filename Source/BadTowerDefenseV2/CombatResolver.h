@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FCombatantParams {
+	float MaxHealth = 100.f;
+	float Armor = 0.f;
+	// Paid out when this combatant dies
+	int32 Reward = 0;
+};
+
+struct FCombatDeath {
+	int32 Id = INDEX_NONE;
+	// Instigator of the hit queued last, in queue order, among the ones that killed it. INDEX_NONE if that hit had no instigator
+	int32 Killer = INDEX_NONE;
+	int32 Reward = 0;
+};
+
+/**
+ * Health and armor of every combatant (enemies and towers) in flat arrays, and every hit queued during a tick,
+ * resolved together in one pass instead of one damage event per hit.
+ *
+ * Resolve works in three loops, each over plain float arrays:
+ *   1. mitigate every hit by its target's armor
+ *   2. add each hit's damage to its target's pending damage
+ *   3. take pending damage off every combatant's health
+ * and only then looks at who died, so the order hits were queued in within a tick doesn't change how much damage
+ * anyone takes or who dies. It does decide who gets the kill: FCombatDeath::Killer is the last hit in queue order.
+ *
+ * Armor reduces damage by armor / (100 + armor): 100 armor halves it, and it never quite reaches immunity.
+ *
+ * Combatants are identified by the id AddCombatant returns. Ids of removed combatants are only reused after the
+ * next Resolve, so hits queued against a combatant removed this tick never land on a new one.
+ */
+class BADTOWERDEFENSEV2_API FCombatResolver
+{
+public:
+	/** Removes every combatant and drops every queued hit */
+	void Reset();
+
+	int32 AddCombatant(const FCombatantParams& params);
+	void RemoveCombatant(int32 id);
+
+	/** Queues a hit for the next Resolve. Hits on combatants that are dead or removed by then are dropped */
+	void QueueHit(int32 target, float damage, int32 instigator = INDEX_NONE);
+
+	/**
+	 * Applies every queued hit. Combatants that died are appended to outDeaths and stay in, dead, until removed.
+	 * Call it every tick, even without hits, it's also what frees the ids of removed combatants
+	 */
+	void Resolve(TArray<FCombatDeath>& outDeaths);
+
+	bool IsValid(int32 id) const {
+		return Live.IsValidIndex(id) && Live[id];
+	}
+
+	bool IsAlive(int32 id) const {
+		return IsValid(id) && Health[id] > 0.f;
+	}
+
+	float GetHealth(int32 id) const { return Health[id]; }
+	float GetMaxHealth(int32 id) const { return MaxHealth[id]; }
+	float GetArmor(int32 id) const { return Armor[id]; }
+
+	void SetHealth(int32 id, float health);
+	void SetArmor(int32 id, float armor);
+
+	int32 Num() const { return NumLive; }
+	int32 GetNumQueuedHits() const { return HitTargets.Num(); }
+
+private:
+	// Per combatant, indexed by id
+	TArray<float> Health;
+	TArray<float> MaxHealth;
+	TArray<float> Armor;
+	TArray<float> PendingDamage;
+	TArray<int32> Reward;
+	TArray<int32> LastHitBy;
+	TArray<bool> Live;
+	TArray<bool> WasHit;
+
+	TArray<int32> FreeIds;
+	// Removed since the last Resolve, free from the one after
+	TArray<int32> RemovedIds;
+	int32 NumLive = 0;
+
+	// Per queued hit
+	TArray<int32> HitTargets;
+	TArray<int32> HitInstigators;
+	TArray<float> HitDamage;
+
+	// Targets hit since the last Resolve, each once
+	TArray<int32> HitCombatants;
+};
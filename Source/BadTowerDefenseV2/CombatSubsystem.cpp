@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatSubsystem.h"
+
+#include "GameFramework/Actor.h"
+
+void UCombatSubsystem::Deinitialize()
+{
+	Resolver.Reset();
+	IdToCombatant.Empty();
+	CombatantToId.Empty();
+	Super::Deinitialize();
+}
+
+bool UCombatSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UCombatSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatSubsystem::RegisterCombatant(AActor* combatant, float maxHealth, float armor, int32 reward)
+{
+	if (!combatant || CombatantToId.Contains(combatant)) {
+		return;
+	}
+
+	FCombatantParams params;
+	params.MaxHealth = maxHealth;
+	params.Armor = armor;
+	params.Reward = reward;
+
+	const auto id = Resolver.AddCombatant(params);
+	if (id >= IdToCombatant.Num()) {
+		IdToCombatant.SetNum(id + 1);
+	}
+	IdToCombatant[id] = combatant;
+	CombatantToId.Add(combatant, id);
+}
+
+void UCombatSubsystem::UnregisterCombatant(AActor* combatant)
+{
+	RemoveId(FindId(combatant));
+}
+
+void UCombatSubsystem::RemoveId(int32 id)
+{
+	if (!Resolver.IsValid(id)) {
+		return;
+	}
+
+	CombatantToId.Remove(IdToCombatant[id]);
+	IdToCombatant[id] = TObjectKey<AActor>();
+	Resolver.RemoveCombatant(id);
+}
+
+int32 UCombatSubsystem::FindId(AActor* combatant) const
+{
+	auto id = CombatantToId.Find(combatant);
+	return id ? *id : INDEX_NONE;
+}
+
+bool UCombatSubsystem::QueueAttack(AActor* target, float damage, AActor* instigator)
+{
+	const auto targetId = FindId(target);
+	if (!Resolver.IsAlive(targetId)) {
+		return false;
+	}
+
+	Resolver.QueueHit(targetId, damage, FindId(instigator));
+	return true;
+}
+
+bool UCombatSubsystem::IsAlive(AActor* combatant) const
+{
+	return Resolver.IsAlive(FindId(combatant));
+}
+
+float UCombatSubsystem::GetHealth(AActor* combatant) const
+{
+	const auto id = FindId(combatant);
+	return Resolver.IsValid(id) ? Resolver.GetHealth(id) : 0.f;
+}
+
+float UCombatSubsystem::GetHealthFraction(AActor* combatant) const
+{
+	const auto id = FindId(combatant);
+	if (!Resolver.IsValid(id) || Resolver.GetMaxHealth(id) <= 0.f) {
+		return 0.f;
+	}
+	return Resolver.GetHealth(id) / Resolver.GetMaxHealth(id);
+}
+
+void UCombatSubsystem::SetArmor(AActor* combatant, float armor)
+{
+	Resolver.SetArmor(FindId(combatant), armor);
+}
+
+void UCombatSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Destroyed without unregistering. Their hits get dropped by Resolve
+	for (int32 id = 0; id < IdToCombatant.Num(); id++) {
+		if (Resolver.IsValid(id) && !IdToCombatant[id].ResolveObjectPtr()) {
+			RemoveId(id);
+		}
+	}
+
+	// Even without hits, Resolve frees the ids removed since the last one
+	Deaths.Reset();
+	Resolver.Resolve(Deaths);
+	if (Deaths.IsEmpty()) {
+		return;
+	}
+
+	// Killers can die in the same tick, so nobody is removed until everyone has been announced. Handlers can register
+	// combatants and reuse ids freed by this Resolve, so every id is turned into its actor before the first broadcast
+	Victims.Reset();
+	Killers.Reset();
+	for (auto& death : Deaths) {
+		Victims.Add(IdToCombatant[death.Id].ResolveObjectPtr());
+		Killers.Add(IdToCombatant.IsValidIndex(death.Killer) ? IdToCombatant[death.Killer].ResolveObjectPtr() : nullptr);
+	}
+
+	// Everything below can run Blueprint code that queues more attacks or registers more combatants, which is fine:
+	// those land next tick. Deaths, Victims and Killers are ours until the next Resolve
+	int32 totalReward = 0;
+	for (int32 i = 0; i < Deaths.Num(); i++) {
+		totalReward += Deaths[i].Reward;
+		OnCombatantKilled.Broadcast(Victims[i], Killers[i], Deaths[i].Reward);
+	}
+
+	for (int32 i = 0; i < Deaths.Num(); i++) {
+		RemoveId(Deaths[i].Id);
+
+		if (bDestroyKilledCombatants && IsValid(Victims[i])) {
+			Victims[i]->Destroy();
+		}
+	}
+
+	if (totalReward != 0) {
+		OnRewardsEarned.Broadcast(totalReward);
+	}
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CombatResolver.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "CombatSubsystem.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnCombatantKilled, AActor*, Victim, AActor*, Killer, int32, Reward);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCombatRewardsEarned, int32, Reward);
+
+/**
+ * Damage for every enemy and tower in one place. Attacks (BTT_AttackTower) and projectile impacts queue a hit here
+ * instead of going through ApplyDamage, and once per tick every queued hit is resolved in one pass (FCombatResolver).
+ * Deaths and the rewards for them come out at the end of that tick, after all the damage is in.
+ *
+ * Health and armor live here rather than on the actors: register each unit with its stats when it spawns and ask
+ * here for its health.
+ */
+UCLASS()
+class BADTOWERDEFENSEV2_API UCombatSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	void RegisterCombatant(AActor* combatant, float maxHealth, float armor = 0.f, int32 reward = 0);
+
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	void UnregisterCombatant(AActor* combatant);
+
+	/** Lands at the end of this tick. Returns false if target isn't a living combatant */
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	bool QueueAttack(AActor* target, float damage, AActor* instigator = nullptr);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Combat")
+	bool IsAlive(AActor* combatant) const;
+
+	/** 0 for actors that aren't registered */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Combat")
+	float GetHealth(AActor* combatant) const;
+
+	/** Health over max health, for health bars */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Combat")
+	float GetHealthFraction(AActor* combatant) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	void SetArmor(AActor* combatant, float armor);
+
+	/** Once per death, after every hit of the tick is resolved. Killer is the instigator of the last hit queued against it that tick, and can be null */
+	UPROPERTY(BlueprintAssignable, Category = "Combat")
+	FOnCombatantKilled OnCombatantKilled;
+
+	/** Once per tick anyone died, with the sum of their rewards */
+	UPROPERTY(BlueprintAssignable, Category = "Combat")
+	FOnCombatRewardsEarned OnRewardsEarned;
+
+	// Destroy combatants when they die. Turn off to handle death (animations, pooling) in OnCombatantKilled instead
+	UPROPERTY(BlueprintReadWrite, Category = "Combat")
+	bool bDestroyKilledCombatants = true;
+
+	const FCombatResolver& GetResolver() const { return Resolver; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	int32 FindId(AActor* combatant) const;
+	void RemoveId(int32 id);
+
+	FCombatResolver Resolver;
+
+	// Indexed by id. Keys stay unique once the combatant is destroyed, so stale ones can still be removed
+	TArray<TObjectKey<AActor>> IdToCombatant;
+	TMap<TObjectKey<AActor>, int32> CombatantToId;
+
+	// Scratch for Resolve
+	TArray<FCombatDeath> Deaths;
+	// Deaths[i]'s victim and killer, looked up before any of them is announced
+	TArray<AActor*> Victims;
+	TArray<AActor*> Killers;
+};
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoordinateHashMap.h"
+
+void FCoordinateHashIndex::Reserve(int32 num)
+{
+	const auto numSlots = static_cast<int32>(FMath::RoundUpToPowerOfTwo(FMath::Max(num * 2, MIN_SLOTS)));
+	if (numSlots > Slots.Num()) {
+		Rehash(numSlots);
+	}
+}
+
+void FCoordinateHashIndex::Reset()
+{
+	for (auto& slot : Slots) {
+		slot.Index = INDEX_NONE;
+	}
+	NumKeys = 0;
+}
+
+void FCoordinateHashIndex::Empty()
+{
+	Slots.Empty();
+	Mask = 0;
+	NumKeys = 0;
+}
+
+int32 FCoordinateHashIndex::FindSlot(uint64 key) const
+{
+	if (Slots.IsEmpty()) {
+		return INDEX_NONE;
+	}
+
+	// There's always an empty slot, so this stops
+	for (auto slot = GetHomeSlot(key); ; slot = (slot + 1) & Mask) {
+		auto& entry = Slots[slot];
+		if (entry.Index == INDEX_NONE) {
+			return INDEX_NONE;
+		}
+		if (entry.Key == key) {
+			return static_cast<int32>(slot);
+		}
+	}
+}
+
+int32 FCoordinateHashIndex::Find(uint64 key) const
+{
+	const auto slot = FindSlot(key);
+	return slot != INDEX_NONE ? Slots[slot].Index : INDEX_NONE;
+}
+
+int32 FCoordinateHashIndex::FindOrAdd(uint64 key, int32 newIndex)
+{
+	if ((NumKeys + 1) * 2 > Slots.Num()) {
+		Rehash(FMath::Max(Slots.Num() * 2, MIN_SLOTS));
+	}
+
+	auto slot = GetHomeSlot(key);
+	while (Slots[slot].Index != INDEX_NONE) {
+		if (Slots[slot].Key == key) {
+			return Slots[slot].Index;
+		}
+		slot = (slot + 1) & Mask;
+	}
+
+	Slots[slot].Key = key;
+	Slots[slot].Index = newIndex;
+	NumKeys++;
+	return INDEX_NONE;
+}
+
+int32 FCoordinateHashIndex::Remove(uint64 key)
+{
+	const auto slot = FindSlot(key);
+	if (slot == INDEX_NONE) {
+		return INDEX_NONE;
+	}
+
+	const auto removedIndex = Slots[slot].Index;
+	NumKeys--;
+
+	// Backward shift instead of tombstones: pull later entries of the same probe run into the hole, as long as
+	// the hole is still on their way from their home slot
+	auto hole = static_cast<uint32>(slot);
+	for (auto next = (hole + 1) & Mask; Slots[next].Index != INDEX_NONE; next = (next + 1) & Mask) {
+		const auto home = GetHomeSlot(Slots[next].Key);
+		if (((next - home) & Mask) >= ((next - hole) & Mask)) {
+			Slots[hole] = Slots[next];
+			hole = next;
+		}
+	}
+	Slots[hole].Index = INDEX_NONE;
+
+	return removedIndex;
+}
+
+void FCoordinateHashIndex::Reindex(uint64 key, int32 newIndex)
+{
+	const auto slot = FindSlot(key);
+	check(slot != INDEX_NONE);
+	Slots[slot].Index = newIndex;
+}
+
+void FCoordinateHashIndex::Rehash(int32 numSlots)
+{
+	auto oldSlots = MoveTemp(Slots);
+
+	Slots.SetNumUninitialized(numSlots);
+	Mask = static_cast<uint32>(numSlots - 1);
+	for (auto& slot : Slots) {
+		slot.Index = INDEX_NONE;
+	}
+
+	for (auto& entry : oldSlots) {
+		if (entry.Index == INDEX_NONE) {
+			continue;
+		}
+
+		auto slot = GetHomeSlot(entry.Key);
+		while (Slots[slot].Index != INDEX_NONE) {
+			slot = (slot + 1) & Mask;
+		}
+		Slots[slot] = entry;
+	}
+}
@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+
+#include "CoreMinimal.h"
+
+/**
+ * Open addressing (linear probing) table from a packed coordinate key to an index in an element array owned by
+ * the caller. Slots hold the key itself, so probing never touches the elements.
+ *
+ * Used by TCoordinateMap and FCoordinateSet, which keep their elements densely packed in insertion order.
+ */
+class BADTOWERDEFENSEV2_API FCoordinateHashIndex {
+public:
+	/** Makes room for num keys without rehashing */
+	void Reserve(int32 num);
+
+	/** Forgets every key but keeps the slots allocated */
+	void Reset();
+
+	/** Forgets every key and frees the slots */
+	void Empty();
+
+	/** Element index stored for key, or INDEX_NONE */
+	int32 Find(uint64 key) const;
+
+	/** Element index already stored for key, or INDEX_NONE after storing newIndex for it */
+	int32 FindOrAdd(uint64 key, int32 newIndex);
+
+	/** Element index that was stored for key, or INDEX_NONE if it wasn't there */
+	int32 Remove(uint64 key);
+
+	/** Points an existing key at a different element, for when the owner moves it */
+	void Reindex(uint64 key, int32 newIndex);
+
+private:
+	struct FSlot {
+		uint64 Key;
+		int32 Index;
+	};
+
+	// Always a power of two. At most half of the slots are in use, so probe runs stay short
+	static constexpr int32 MIN_SLOTS = 16;
+
+	int32 FindSlot(uint64 key) const;
+	void Rehash(int32 numSlots);
+
+	uint32 GetHomeSlot(uint64 key) const {
+		return static_cast<uint32>(FCoordinate2D::MixPackedKey(key)) & Mask;
+	}
+
+	TArray<FSlot> Slots;
+	uint32 Mask = 0;
+	int32 NumKeys = 0;
+};
+
+/**
+ * Flat hash map from FCoordinate2D to ValueType. Keys and values live in two arrays in insertion order, so
+ * iterating is a linear walk. Remove fills the gap with the last element, the same way TArray::RemoveAtSwap does.
+ */
+template<typename ValueType>
+class TCoordinateMap {
+public:
+	void Reserve(int32 num) {
+		HashIndex.Reserve(num);
+		Keys.Reserve(num);
+		Values.Reserve(num);
+	}
+
+	/** Removes everything but keeps the memory around for the next use */
+	void Reset() {
+		HashIndex.Reset();
+		Keys.Reset();
+		Values.Reset();
+	}
+
+	void Empty() {
+		HashIndex.Empty();
+		Keys.Empty();
+		Values.Empty();
+	}
+
+	int32 Num() const { return Keys.Num(); }
+	bool IsEmpty() const { return Keys.IsEmpty(); }
+
+	bool Contains(const FCoordinate2D& key) const {
+		return HashIndex.Find(key.ToPackedKey()) != INDEX_NONE;
+	}
+
+	ValueType* Find(const FCoordinate2D& key) {
+		const auto index = HashIndex.Find(key.ToPackedKey());
+		return index != INDEX_NONE ? &Values[index] : nullptr;
+	}
+
+	const ValueType* Find(const FCoordinate2D& key) const {
+		const auto index = HashIndex.Find(key.ToPackedKey());
+		return index != INDEX_NONE ? &Values[index] : nullptr;
+	}
+
+	/** Adds key, or overwrites its value if it's already there (same as TMap::Add) */
+	ValueType& Add(const FCoordinate2D& key, const ValueType& value) {
+		auto& result = FindOrAdd(key);
+		result = value;
+		return result;
+	}
+
+	ValueType& FindOrAdd(const FCoordinate2D& key) {
+		const auto index = HashIndex.FindOrAdd(key.ToPackedKey(), Keys.Num());
+		if (index != INDEX_NONE) {
+			return Values[index];
+		}
+
+		Keys.Add(key);
+		return Values.AddDefaulted_GetRef();
+	}
+
+	bool Remove(const FCoordinate2D& key) {
+		const auto index = HashIndex.Remove(key.ToPackedKey());
+		if (index == INDEX_NONE) {
+			return false;
+		}
+
+		const auto last = Keys.Num() - 1;
+		if (index != last) {
+			Keys[index] = Keys[last];
+			Values[index] = MoveTemp(Values[last]);
+			HashIndex.Reindex(Keys[index].ToPackedKey(), index);
+		}
+		Keys.Pop(false);
+		Values.Pop(false);
+		return true;
+	}
+
+	/** Keys in insertion order, lined up with GetValues */
+	TConstArrayView<FCoordinate2D> GetKeys() const { return Keys; }
+	TArrayView<ValueType> GetValues() { return Values; }
+	TConstArrayView<ValueType> GetValues() const { return Values; }
+
+private:
+	FCoordinateHashIndex HashIndex;
+	TArray<FCoordinate2D> Keys;
+	TArray<ValueType> Values;
+};
+
+/** TCoordinateMap without the values */
+class FCoordinateSet {
+public:
+	void Reserve(int32 num) {
+		HashIndex.Reserve(num);
+		Keys.Reserve(num);
+	}
+
+	/** Removes everything but keeps the memory around for the next use */
+	void Reset() {
+		HashIndex.Reset();
+		Keys.Reset();
+	}
+
+	void Empty() {
+		HashIndex.Empty();
+		Keys.Empty();
+	}
+
+	int32 Num() const { return Keys.Num(); }
+	bool IsEmpty() const { return Keys.IsEmpty(); }
+
+	bool Contains(const FCoordinate2D& key) const {
+		return HashIndex.Find(key.ToPackedKey()) != INDEX_NONE;
+	}
+
+	/** Same as TSet::Add */
+	void Add(const FCoordinate2D& key, bool* bIsAlreadyInSetPtr = nullptr) {
+		const bool bAlreadyInSet = HashIndex.FindOrAdd(key.ToPackedKey(), Keys.Num()) != INDEX_NONE;
+		if (!bAlreadyInSet) {
+			Keys.Add(key);
+		}
+		if (bIsAlreadyInSetPtr) {
+			*bIsAlreadyInSetPtr = bAlreadyInSet;
+		}
+	}
+
+	bool Remove(const FCoordinate2D& key) {
+		const auto index = HashIndex.Remove(key.ToPackedKey());
+		if (index == INDEX_NONE) {
+			return false;
+		}
+
+		const auto last = Keys.Num() - 1;
+		if (index != last) {
+			Keys[index] = Keys[last];
+			HashIndex.Reindex(Keys[index].ToPackedKey(), index);
+		}
+		Keys.Pop(false);
+		return true;
+	}
+
+	/** Keys in insertion order */
+	TConstArrayView<FCoordinate2D> GetKeys() const { return Keys; }
+
+	const FCoordinate2D* begin() const { return Keys.GetData(); }
+	const FCoordinate2D* end() const { return Keys.GetData() + Keys.Num(); }
+
+private:
+	FCoordinateHashIndex HashIndex;
+	TArray<FCoordinate2D> Keys;
+};
@@ -0,0 +1,262 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySimulation.h"
+#include "HexFlowField.h"
+#include "MapUtilitiesLibrary.h"
+
+#include "Async/ParallelFor.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("EnemySimulation"), STATGROUP_EnemySimulation, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Integrate"), STAT_EnemySimulation_Integrate, STATGROUP_EnemySimulation);
+DECLARE_CYCLE_STAT(TEXT("Retarget"), STAT_EnemySimulation_Retarget, STATGROUP_EnemySimulation);
+
+// Enemies per ParallelFor task. Big enough that the per-task overhead disappears, small enough to spread a wave over every core
+constexpr int32 INTEGRATE_BATCH_SIZE = 1024;
+
+// Within this distance of a tile center counts as being on it
+constexpr float ARRIVAL_TOLERANCE = 0.5f;
+
+FEnemySimulation::FEnemySimulation(float tileSize, int32 chunkDimensions)
+	: TileSize(tileSize > 0.f ? tileSize : 100.f)
+	, SpatialIndex(chunkDimensions)
+{
+}
+
+void FEnemySimulation::Reset()
+{
+	SpatialIndex.Reset();
+	IdToIndex.Reset();
+
+	Ids.Reset();
+	TypeIds.Reset();
+	PositionX.Reset();
+	PositionY.Reset();
+	TargetX.Reset();
+	TargetY.Reset();
+	Speed.Reset();
+	Health.Reset();
+	DistanceTravelled.Reset();
+	TilesToGoal.Reset();
+	Tiles.Reset();
+	TargetTiles.Reset();
+	StepFlags.Reset();
+	StepLeftover.Reset();
+}
+
+void FEnemySimulation::Reserve(int32 num)
+{
+	IdToIndex.Reserve(num);
+
+	Ids.Reserve(num);
+	TypeIds.Reserve(num);
+	PositionX.Reserve(num);
+	PositionY.Reserve(num);
+	TargetX.Reserve(num);
+	TargetY.Reserve(num);
+	Speed.Reserve(num);
+	Health.Reserve(num);
+	DistanceTravelled.Reserve(num);
+	TilesToGoal.Reserve(num);
+	Tiles.Reserve(num);
+	TargetTiles.Reserve(num);
+	StepFlags.Reserve(num);
+	StepLeftover.Reserve(num);
+}
+
+int32 FEnemySimulation::Spawn(const FEnemySpawnParams& params)
+{
+	const auto id = SpatialIndex.Add(params.Tile);
+	if (id >= IdToIndex.Num()) {
+		IdToIndex.SetNum(id + 1);
+	}
+	IdToIndex[id] = Ids.Add(id);
+
+	// Spawned sitting on its tile's center, so the first step picks where to go
+	const auto location = UMapUtilitiesLibrary::ConvertGlobalCoordinateToWorldLocation(params.Tile, TileSize);
+	TypeIds.Add(params.TypeId);
+	PositionX.Add(location.X);
+	PositionY.Add(location.Y);
+	TargetX.Add(location.X);
+	TargetY.Add(location.Y);
+	Speed.Add(params.Speed);
+	Health.Add(params.Health);
+	DistanceTravelled.Add(0.f);
+	TilesToGoal.Add(INDEX_NONE);
+	Tiles.Add(params.Tile);
+	TargetTiles.Add(params.Tile);
+	StepFlags.Add(0);
+	StepLeftover.Add(0.f);
+
+	return id;
+}
+
+void FEnemySimulation::Remove(int32 id)
+{
+	if (!IsValid(id)) {
+		return;
+	}
+
+	// Swap the last enemy into the hole so the arrays stay dense
+	const auto index = IdToIndex[id];
+	Ids.RemoveAtSwap(index, 1, false);
+	TypeIds.RemoveAtSwap(index, 1, false);
+	PositionX.RemoveAtSwap(index, 1, false);
+	PositionY.RemoveAtSwap(index, 1, false);
+	TargetX.RemoveAtSwap(index, 1, false);
+	TargetY.RemoveAtSwap(index, 1, false);
+	Speed.RemoveAtSwap(index, 1, false);
+	Health.RemoveAtSwap(index, 1, false);
+	DistanceTravelled.RemoveAtSwap(index, 1, false);
+	TilesToGoal.RemoveAtSwap(index, 1, false);
+	Tiles.RemoveAtSwap(index, 1, false);
+	TargetTiles.RemoveAtSwap(index, 1, false);
+	StepFlags.RemoveAtSwap(index, 1, false);
+	StepLeftover.RemoveAtSwap(index, 1, false);
+
+	if (Ids.IsValidIndex(index)) {
+		IdToIndex[Ids[index]] = index;
+	}
+	IdToIndex[id] = INDEX_NONE;
+	SpatialIndex.Remove(id);
+}
+
+bool FEnemySimulation::ApplyDamage(int32 id, float damage)
+{
+	if (!IsValid(id)) {
+		return false;
+	}
+
+	auto& health = Health[IdToIndex[id]];
+	if (health <= 0.f) {
+		return false;
+	}
+
+	health -= damage;
+	return health <= 0.f;
+}
+
+FVector FEnemySimulation::GetLocation(int32 id) const
+{
+	const auto index = IdToIndex[id];
+	return FVector(PositionX[index], PositionY[index], 0.0);
+}
+
+void FEnemySimulation::Integrate(float deltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemySimulation_Integrate);
+
+	const auto num = Ids.Num();
+	const auto halfTile = TileSize * 0.5f;
+	const auto numBatches = FMath::DivideAndRoundUp(num, INTEGRATE_BATCH_SIZE);
+
+	// Plain loops over flat arrays with no calls and no branches the compiler can't turn into selects,
+	// so each batch vectorizes
+	ParallelFor(numBatches, [&](int32 batch) {
+		const auto first = batch * INTEGRATE_BATCH_SIZE;
+		const auto last = FMath::Min(first + INTEGRATE_BATCH_SIZE, num);
+
+		auto positionX = PositionX.GetData();
+		auto positionY = PositionY.GetData();
+		auto distanceTravelled = DistanceTravelled.GetData();
+		auto stepFlags = StepFlags.GetData();
+		auto stepLeftover = StepLeftover.GetData();
+		const auto targetX = TargetX.GetData();
+		const auto targetY = TargetY.GetData();
+		const auto speed = Speed.GetData();
+
+		for (int32 i = first; i < last; i++) {
+			const auto dx = targetX[i] - positionX[i];
+			const auto dy = targetY[i] - positionY[i];
+			const auto distance = FMath::Sqrt(dx * dx + dy * dy);
+			const auto budget = speed[i] * deltaTime;
+			const auto step = FMath::Min(budget, distance);
+			const auto scale = distance > 0.f ? step / distance : 0.f;
+
+			positionX[i] += dx * scale;
+			positionY[i] += dy * scale;
+			distanceTravelled[i] += step;
+			stepLeftover[i] = budget - step;
+
+			const auto remaining = distance - step;
+			stepFlags[i] = (remaining <= halfTile ? CrossedIntoTarget : 0) | (remaining <= ARRIVAL_TOLERANCE ? ReachedTarget : 0);
+		}
+	}, numBatches <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+/// <summary>
+/// Integrate for a single enemy: moves it up to distance toward its target and returns its step flags. Used for
+/// the rest of a step after a retarget
+/// </summary>
+uint8 FEnemySimulation::Advance(int32 index, float distance)
+{
+	const auto dx = TargetX[index] - PositionX[index];
+	const auto dy = TargetY[index] - PositionY[index];
+	const auto toTarget = FMath::Sqrt(dx * dx + dy * dy);
+	const auto step = FMath::Min(distance, toTarget);
+	const auto scale = toTarget > 0.f ? step / toTarget : 0.f;
+
+	PositionX[index] += dx * scale;
+	PositionY[index] += dy * scale;
+	DistanceTravelled[index] += step;
+	StepLeftover[index] = distance - step;
+
+	const auto remaining = toTarget - step;
+	return (remaining <= TileSize * 0.5f ? CrossedIntoTarget : 0) | (remaining <= ARRIVAL_TOLERANCE ? ReachedTarget : 0);
+}
+
+bool FEnemySimulation::Retarget(int32 index, const FHexFlowField& flowField)
+{
+	FCoordinate2D nextTile;
+	if (!flowField.GetNextTile(Tiles[index], nextTile)) {
+		// Nowhere to go (e.g. walled in by towers), wait on this tile until the field changes
+		TilesToGoal[index] = INDEX_NONE;
+		return false;
+	}
+
+	const auto location = UMapUtilitiesLibrary::ConvertGlobalCoordinateToWorldLocation(nextTile, TileSize);
+	TargetTiles[index] = nextTile;
+	TargetX[index] = location.X;
+	TargetY[index] = location.Y;
+	TilesToGoal[index] = flowField.GetDistanceToGoal(nextTile);
+	return true;
+}
+
+void FEnemySimulation::Step(float deltaTime, const FHexFlowField& flowField, TArray<int32>& outReachedGoal)
+{
+	Integrate(deltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_EnemySimulation_Retarget);
+
+	// Only enemies near a tile center have anything to do here, and they only touch the flow field and their own
+	// two tiles in the spatial index
+	for (int32 i = 0; i < Ids.Num(); i++) {
+		auto flags = StepFlags[i];
+		if (flags == 0) {
+			continue;
+		}
+
+		// Whatever is left of the step after reaching a target is walked toward the next one, which can reach that
+		// one too on long steps
+		while (true) {
+			if ((flags & CrossedIntoTarget) && Tiles[i] != TargetTiles[i]) {
+				Tiles[i] = TargetTiles[i];
+				SpatialIndex.Move(Ids[i], Tiles[i]);
+			}
+
+			if (!(flags & ReachedTarget)) {
+				break;
+			}
+			if (flowField.GetDistanceToGoal(Tiles[i]) == 0) {
+				outReachedGoal.Add(Ids[i]);
+				break;
+			}
+			if (!Retarget(i, flowField) || StepLeftover[i] <= 0.f) {
+				break;
+			}
+			flags = Advance(i, StepLeftover[i]);
+		}
+	}
+}
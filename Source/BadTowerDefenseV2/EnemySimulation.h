@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "EnemySpatialIndex.h"
+
+#include "CoreMinimal.h"
+
+class FHexFlowField;
+
+struct FEnemySpawnParams {
+	int32 TypeId = 0;
+	FCoordinate2D Tile;
+	float Speed = 100.f;
+	float Health = 100.f;
+};
+
+/**
+ * Every enemy of a wave in one structure-of-arrays store instead of one actor each. Step moves all of them along the
+ * flow field at once: a parallel pass integrates positions over the flat arrays, then a serial pass retargets the
+ * few enemies that reached a tile center and re-buckets the ones that crossed into another tile. Enemies that reach a
+ * tile center partway through a step walk the rest of it toward their next tile, so how far they get doesn't depend
+ * on the step size.
+ *
+ * Enemies are identified by the id Spawn returns, which is also their handle in GetSpatialIndex. Ids of removed
+ * enemies get reused. The arrays themselves are dense and get reordered when enemies are removed, so only hold on
+ * to ids, never to array indices.
+ */
+class BADTOWERDEFENSEV2_API FEnemySimulation
+{
+public:
+	explicit FEnemySimulation(float tileSize = 100.f, int32 chunkDimensions = 8);
+
+	/** Removes every enemy. Keeps the memory for the next wave */
+	void Reset();
+
+	void Reserve(int32 num);
+
+	int32 Spawn(const FEnemySpawnParams& params);
+	void Remove(int32 id);
+
+	/** Returns true if that killed the enemy. Dead enemies stay in until they're removed */
+	bool ApplyDamage(int32 id, float damage);
+
+	/** Advances every enemy by deltaTime. Ids of enemies standing on the goal are appended to outReachedGoal, every step until they are removed */
+	void Step(float deltaTime, const FHexFlowField& flowField, TArray<int32>& outReachedGoal);
+
+	bool IsValid(int32 id) const {
+		return IdToIndex.IsValidIndex(id) && IdToIndex[id] != INDEX_NONE;
+	}
+
+	int32 Num() const { return Ids.Num(); }
+
+	int32 GetTypeId(int32 id) const { return TypeIds[IdToIndex[id]]; }
+	float GetHealth(int32 id) const { return Health[IdToIndex[id]]; }
+	const FCoordinate2D& GetTile(int32 id) const { return Tiles[IdToIndex[id]]; }
+	FVector GetLocation(int32 id) const;
+
+	/** Tiles the enemy still has to cover to the goal (from its current target), INDEX_NONE if it can't get there */
+	int32 GetTilesToGoal(int32 id) const { return TilesToGoal[IdToIndex[id]]; }
+
+	/** World units the enemy has walked since it spawned */
+	float GetDistanceTravelled(int32 id) const { return DistanceTravelled[IdToIndex[id]]; }
+
+	float GetTileSize() const { return TileSize; }
+	const FEnemySpatialIndex& GetSpatialIndex() const { return SpatialIndex; }
+
+	// Dense views, index i is the same enemy in all of them
+	TConstArrayView<int32> GetIds() const { return Ids; }
+	TConstArrayView<int32> GetTypeIds() const { return TypeIds; }
+	TConstArrayView<float> GetPositionsX() const { return PositionX; }
+	TConstArrayView<float> GetPositionsY() const { return PositionY; }
+
+private:
+	enum EStepFlags : uint8 {
+		CrossedIntoTarget = 1 << 0,
+		ReachedTarget = 1 << 1,
+	};
+
+	void Integrate(float deltaTime);
+	uint8 Advance(int32 index, float distance);
+	bool Retarget(int32 index, const FHexFlowField& flowField);
+
+	float TileSize;
+
+	FEnemySpatialIndex SpatialIndex;
+
+	// Sparse id -> dense index, INDEX_NONE for free ids
+	TArray<int32> IdToIndex;
+
+	TArray<int32> Ids;
+	TArray<int32> TypeIds;
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> TargetX;
+	TArray<float> TargetY;
+	TArray<float> Speed;
+	TArray<float> Health;
+	TArray<float> DistanceTravelled;
+	TArray<int32> TilesToGoal;
+	TArray<FCoordinate2D> Tiles;
+	TArray<FCoordinate2D> TargetTiles;
+	TArray<uint8> StepFlags;
+	// Distance left of the current step after reaching the target, walked toward the next target once it's picked
+	TArray<float> StepLeftover;
+};
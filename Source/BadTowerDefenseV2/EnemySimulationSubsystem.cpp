@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySimulationSubsystem.h"
+#include "HexFlowFieldSubsystem.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+void UEnemySimulationSubsystem::Deinitialize()
+{
+	// The proxy actor goes down with the world
+	Simulation.Reset();
+	EnemyTypes.Empty();
+	ProxyComponents.Empty();
+	ProxyActor = nullptr;
+	Super::Deinitialize();
+}
+
+bool UEnemySimulationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UEnemySimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemySimulationSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemySimulationSubsystem::EnsureSimulation()
+{
+	if (bSimulationInitialized) {
+		return;
+	}
+
+	// Enemies walk from tile center to tile center, so they have to agree with the flow field on where those are
+	auto flowField = GetWorld()->GetSubsystem<UHexFlowFieldSubsystem>();
+	Simulation = FEnemySimulation(flowField ? flowField->TileSize : 100.f);
+	bSimulationInitialized = true;
+}
+
+int32 UEnemySimulationSubsystem::RegisterEnemyType(FName name, const FEnemyUnitStats& stats)
+{
+	const auto typeId = EnemyTypes.Add({ name, stats });
+	ProxyComponents.Add(CreateProxyComponent(stats));
+	return typeId;
+}
+
+void UEnemySimulationSubsystem::RegisterEnemyTypes(UDataTable* enemyTable)
+{
+	if (!enemyTable) {
+		return;
+	}
+
+	if (enemyTable->GetRowStruct() != FEnemyUnitStats::StaticStruct()) {
+		UE_LOG(LogTemp, Warning, TEXT("%s doesn't use FEnemyUnitStats rows"), *enemyTable->GetName());
+		return;
+	}
+
+	enemyTable->ForeachRow<FEnemyUnitStats>(TEXT("RegisterEnemyTypes"), [this](const FName& rowName, const FEnemyUnitStats& stats) {
+		RegisterEnemyType(rowName, stats);
+	});
+}
+
+int32 UEnemySimulationSubsystem::FindEnemyType(FName name) const
+{
+	return EnemyTypes.IndexOfByPredicate([&](const FEnemyType& type) {
+		return type.Name == name;
+	});
+}
+
+UInstancedStaticMeshComponent* UEnemySimulationSubsystem::CreateProxyComponent(const FEnemyUnitStats& stats)
+{
+	if (!stats.Mesh) {
+		return nullptr;
+	}
+
+	if (!ProxyActor) {
+		FActorSpawnParameters spawnParameters;
+		spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		ProxyActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, spawnParameters);
+
+		auto root = NewObject<USceneComponent>(ProxyActor);
+		ProxyActor->SetRootComponent(root);
+		root->RegisterComponent();
+	}
+
+	// Just visuals: hits and range checks go through the simulation, never through these
+	auto component = NewObject<UInstancedStaticMeshComponent>(ProxyActor);
+	component->SetStaticMesh(stats.Mesh);
+	component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	component->SetCanEverAffectNavigation(false);
+	component->SetupAttachment(ProxyActor->GetRootComponent());
+	component->RegisterComponent();
+	ProxyActor->AddInstanceComponent(component);
+	return component;
+}
+
+int32 UEnemySimulationSubsystem::SpawnEnemy(int32 typeId, const FCoordinate2D& tile)
+{
+	if (!EnemyTypes.IsValidIndex(typeId)) {
+		return INDEX_NONE;
+	}
+
+	EnsureSimulation();
+
+	const auto& stats = EnemyTypes[typeId].Stats;
+	FEnemySpawnParams params;
+	params.TypeId = typeId;
+	params.Tile = tile;
+	params.Speed = stats.Speed;
+	params.Health = stats.MaxHealth;
+	return Simulation.Spawn(params);
+}
+
+void UEnemySimulationSubsystem::RemoveEnemy(int32 enemyId)
+{
+	Simulation.Remove(enemyId);
+}
+
+void UEnemySimulationSubsystem::ClearEnemies()
+{
+	Simulation.Reset();
+	// Pick the tile size up again with the next wave, in case the map changed
+	bSimulationInitialized = false;
+	UpdateProxies();
+}
+
+bool UEnemySimulationSubsystem::DamageEnemy(int32 enemyId, float damage)
+{
+	if (!Simulation.ApplyDamage(enemyId, damage)) {
+		return false;
+	}
+
+	const auto typeId = Simulation.GetTypeId(enemyId);
+	const auto location = Simulation.GetLocation(enemyId);
+	Simulation.Remove(enemyId);
+	OnEnemyKilled.Broadcast(enemyId, typeId, location);
+	return true;
+}
+
+FVector UEnemySimulationSubsystem::GetEnemyLocation(int32 enemyId) const
+{
+	return Simulation.IsValid(enemyId) ? Simulation.GetLocation(enemyId) : FVector::ZeroVector;
+}
+
+int32 UEnemySimulationSubsystem::GetEnemiesInRange(const FCoordinate2D& tile, int32 range, TArray<int32>& outEnemyIds, int32 maxResults) const
+{
+	outEnemyIds.Reset();
+
+	QueryIds.Reset();
+	Simulation.GetSpatialIndex().Query(tile, range, QueryIds);
+
+	// Sort on (tiles left to the headquarters, id). Enemies that can't get there go last
+	SortKeys.Reset();
+	for (auto id : QueryIds) {
+		const auto tilesToGoal = Simulation.GetTilesToGoal(id);
+		SortKeys.Emplace(tilesToGoal == INDEX_NONE ? TNumericLimits<int32>::Max() : tilesToGoal, id);
+	}
+	SortKeys.Sort([](const TPair<int32, int32>& lhs, const TPair<int32, int32>& rhs) {
+		return lhs.Key != rhs.Key ? lhs.Key < rhs.Key : lhs.Value < rhs.Value;
+	});
+
+	const auto count = maxResults > 0 ? FMath::Min(maxResults, SortKeys.Num()) : SortKeys.Num();
+	outEnemyIds.Reserve(count);
+	for (int32 i = 0; i < count; i++) {
+		outEnemyIds.Add(SortKeys[i].Value);
+	}
+	return count;
+}
+
+void UEnemySimulationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	auto flowField = GetWorld()->GetSubsystem<UHexFlowFieldSubsystem>();
+	if (flowField && Simulation.Num() > 0) {
+		ReachedGoal.Reset();
+		Simulation.Step(DeltaTime, flowField->GetFlowField(), ReachedGoal);
+
+		for (auto id : ReachedGoal) {
+			const auto typeId = Simulation.GetTypeId(id);
+			const auto location = Simulation.GetLocation(id);
+			Simulation.Remove(id);
+			OnEnemyReachedGoal.Broadcast(id, typeId, location);
+		}
+	}
+
+	UpdateProxies();
+}
+
+void UEnemySimulationSubsystem::UpdateProxies()
+{
+	ProxyTransforms.SetNum(EnemyTypes.Num());
+	for (auto& transforms : ProxyTransforms) {
+		transforms.Reset();
+	}
+
+	const auto typeIds = Simulation.GetTypeIds();
+	const auto positionsX = Simulation.GetPositionsX();
+	const auto positionsY = Simulation.GetPositionsY();
+	for (int32 i = 0; i < typeIds.Num(); i++) {
+		const auto typeId = typeIds[i];
+		if (ProxyComponents[typeId]) {
+			ProxyTransforms[typeId].Emplace(FQuat::Identity, FVector(positionsX[i], positionsY[i], ProxyHeight), EnemyTypes[typeId].Stats.MeshScale);
+		}
+	}
+
+	for (int32 typeId = 0; typeId < ProxyComponents.Num(); typeId++) {
+		auto component = ProxyComponents[typeId].Get();
+		if (!component) {
+			continue;
+		}
+
+		// Update in place while the count holds, only rebuild the instance list on frames where enemies of this type spawned or died
+		const auto& transforms = ProxyTransforms[typeId];
+		if (component->GetInstanceCount() == transforms.Num()) {
+			if (!transforms.IsEmpty()) {
+				component->BatchUpdateInstancesTransforms(0, transforms, true, true, true);
+			}
+		}
+		else {
+			component->ClearInstances();
+			component->AddInstances(transforms, false, true);
+		}
+	}
+}
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "EnemySimulation.h"
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemySimulationSubsystem.generated.h"
+
+class UDataTable;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/** Stats of one kind of simulated enemy. Row struct for enemy data tables, mirroring BPS_EnemyUnit_StatsBase */
+USTRUCT(BlueprintType)
+struct FEnemyUnitStats : public FTableRowBase {
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy")
+	float MaxHealth = 100.f;
+
+	// World units per second
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy")
+	float Speed = 150.f;
+
+	// Damage dealt to the headquarters on arrival
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy")
+	int32 Damage = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy")
+	int32 Bounty = 1;
+
+	// Drawn as one instance of this per enemy
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy")
+	TObjectPtr<UStaticMesh> Mesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy")
+	FVector MeshScale = FVector(1.f);
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnSimulatedEnemyEvent, int32, EnemyId, int32, TypeId, const FVector&, Location);
+
+/**
+ * Runs whole waves of enemies through FEnemySimulation instead of one actor (movement component, behavior tree,
+ * tick) per enemy. They follow UHexFlowFieldSubsystem's flow field and are drawn as one instanced static mesh
+ * per enemy type, so thousands of them cost one simulation pass and one instance buffer update per type a frame.
+ *
+ * Register the enemy types first (from a data table of FEnemyUnitStats or one by one), then spawn by type id.
+ */
+UCLASS()
+class BADTOWERDEFENSEV2_API UEnemySimulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Returns the type id to spawn this kind of enemy with */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Simulation")
+	int32 RegisterEnemyType(FName name, const FEnemyUnitStats& stats);
+
+	/** Registers every row of a data table with FEnemyUnitStats rows, named after the row */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Simulation")
+	void RegisterEnemyTypes(UDataTable* enemyTable);
+
+	/** INDEX_NONE if no type was registered under that name */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Enemy Simulation")
+	int32 FindEnemyType(FName name) const;
+
+	/** Returns the new enemy's id, or INDEX_NONE if typeId isn't registered */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Simulation")
+	int32 SpawnEnemy(int32 typeId, const FCoordinate2D& tile);
+
+	UFUNCTION(BlueprintCallable, Category = "Enemy Simulation")
+	void RemoveEnemy(int32 enemyId);
+
+	/** Removes every enemy, e.g. between levels */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Simulation")
+	void ClearEnemies();
+
+	/** Returns true if that killed the enemy, in which case it's removed and OnEnemyKilled fires */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Simulation")
+	bool DamageEnemy(int32 enemyId, float damage);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Enemy Simulation")
+	bool IsEnemyAlive(int32 enemyId) const { return Simulation.IsValid(enemyId); }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Enemy Simulation")
+	FVector GetEnemyLocation(int32 enemyId) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Enemy Simulation")
+	int32 GetNumEnemies() const { return Simulation.Num(); }
+
+	/** Ids of the enemies within range tiles of tile, nearest to the headquarters first. maxResults <= 0 returns all of them */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Simulation")
+	int32 GetEnemiesInRange(const FCoordinate2D& tile, int32 range, TArray<int32>& outEnemyIds, int32 maxResults = 0) const;
+
+	const FEnemySimulation& GetSimulation() const { return Simulation; }
+
+	UPROPERTY(BlueprintAssignable, Category = "Enemy Simulation")
+	FOnSimulatedEnemyEvent OnEnemyKilled;
+
+	/** The enemy got to the headquarters. It's removed right after this */
+	UPROPERTY(BlueprintAssignable, Category = "Enemy Simulation")
+	FOnSimulatedEnemyEvent OnEnemyReachedGoal;
+
+	// Height the enemy meshes are drawn at
+	UPROPERTY(BlueprintReadWrite, Category = "Enemy Simulation")
+	float ProxyHeight = 0.f;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FEnemyType {
+		FName Name;
+		FEnemyUnitStats Stats;
+	};
+
+	void EnsureSimulation();
+	UInstancedStaticMeshComponent* CreateProxyComponent(const FEnemyUnitStats& stats);
+	void UpdateProxies();
+
+	FEnemySimulation Simulation;
+	bool bSimulationInitialized = false;
+
+	TArray<FEnemyType> EnemyTypes;
+
+	UPROPERTY()
+	TObjectPtr<AActor> ProxyActor;
+
+	// One per enemy type, null for types without a mesh
+	UPROPERTY()
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> ProxyComponents;
+
+	// Scratch, kept between frames
+	TArray<int32> ReachedGoal;
+	TArray<TArray<FTransform>> ProxyTransforms;
+	mutable TArray<int32> QueryIds;
+	mutable TArray<TPair<int32, int32>> SortKeys;
+};
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySpatialIndex.h"
+#include "MapUtilitiesLibrary.h"
+
+FEnemySpatialIndex::FEnemySpatialIndex(int32 chunkDimensions)
+	: ChunkDimensions(FMath::Max(chunkDimensions, 1))
+{
+}
+
+void FEnemySpatialIndex::Reset()
+{
+	Enemies.Reset();
+	FreeHandles.Reset();
+	TileBuckets.Reset();
+	ChunkCounts.Reset();
+	NumLive = 0;
+}
+
+int32 FEnemySpatialIndex::Add(const FCoordinate2D& tile)
+{
+	const auto handle = FreeHandles.IsEmpty() ? Enemies.AddDefaulted() : FreeHandles.Pop(false);
+
+	auto& enemy = Enemies[handle];
+	enemy.Tile = tile;
+	enemy.bLive = true;
+	NumLive++;
+
+	AddToBuckets(handle);
+	return handle;
+}
+
+void FEnemySpatialIndex::Remove(int32 handle)
+{
+	if (!IsValid(handle)) {
+		return;
+	}
+
+	RemoveFromBuckets(handle);
+	Enemies[handle].bLive = false;
+	FreeHandles.Add(handle);
+	NumLive--;
+}
+
+void FEnemySpatialIndex::Move(int32 handle, const FCoordinate2D& tile)
+{
+	if (!IsValid(handle) || Enemies[handle].Tile == tile) {
+		return;
+	}
+
+	RemoveFromBuckets(handle);
+	Enemies[handle].Tile = tile;
+	AddToBuckets(handle);
+}
+
+void FEnemySpatialIndex::AddToBuckets(int32 handle)
+{
+	auto& enemy = Enemies[handle];
+
+	auto& bucket = TileBuckets.FindOrAdd(enemy.Tile);
+	enemy.SlotInTile = bucket.Add(handle);
+
+	ChunkCounts.FindOrAdd(UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(enemy.Tile, ChunkDimensions))++;
+}
+
+void FEnemySpatialIndex::RemoveFromBuckets(int32 handle)
+{
+	auto& enemy = Enemies[handle];
+
+	auto bucket = TileBuckets.Find(enemy.Tile);
+	check(bucket && (*bucket)[enemy.SlotInTile] == handle);
+
+	// Swap the last enemy of the tile into our slot so removing stays O(1)
+	bucket->RemoveAtSwap(enemy.SlotInTile, 1, false);
+	if (bucket->IsValidIndex(enemy.SlotInTile)) {
+		Enemies[(*bucket)[enemy.SlotInTile]].SlotInTile = enemy.SlotInTile;
+	}
+	if (bucket->IsEmpty()) {
+		TileBuckets.Remove(enemy.Tile);
+	}
+	enemy.SlotInTile = INDEX_NONE;
+
+	const auto chunk = UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(enemy.Tile, ChunkDimensions);
+	auto count = ChunkCounts.Find(chunk);
+	check(count && *count > 0);
+	if (--*count == 0) {
+		ChunkCounts.Remove(chunk);
+	}
+}
+
+int32 FEnemySpatialIndex::GetNumOnTile(const FCoordinate2D& tile) const
+{
+	auto bucket = TileBuckets.Find(tile);
+	return bucket ? bucket->Num() : 0;
+}
+
+int32 FEnemySpatialIndex::GetNumInChunk(const FCoordinate2D& chunkCoordinate) const
+{
+	auto count = ChunkCounts.Find(chunkCoordinate);
+	return count ? *count : 0;
+}
+
+void FEnemySpatialIndex::Query(const FCoordinate2D& center, int32 range, TArray<int32>& outHandles) const
+{
+	if (range < 0 || NumLive == 0) {
+		return;
+	}
+
+	// Every tile within range hexes lies inside this box, rows further away just use less of it
+	const auto minTile = FCoordinate2D(center.X - range, center.Y - range);
+	const auto maxTile = FCoordinate2D(center.X + range, center.Y + range);
+	const auto minChunk = UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(minTile, ChunkDimensions);
+	const auto maxChunk = UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(maxTile, ChunkDimensions);
+
+	for (int32 chunkX = minChunk.X; chunkX <= maxChunk.X; chunkX++) {
+		for (int32 chunkY = minChunk.Y; chunkY <= maxChunk.Y; chunkY++) {
+			if (!ChunkCounts.Contains(FCoordinate2D(chunkX, chunkY))) {
+				continue;
+			}
+
+			const auto firstX = FMath::Max(minTile.X, chunkX * ChunkDimensions);
+			const auto lastX = FMath::Min(maxTile.X, (chunkX + 1) * ChunkDimensions - 1);
+			const auto firstY = FMath::Max(minTile.Y, chunkY * ChunkDimensions);
+			const auto lastY = FMath::Min(maxTile.Y, (chunkY + 1) * ChunkDimensions - 1);
+
+			for (int32 x = firstX; x <= lastX; x++) {
+				for (int32 y = firstY; y <= lastY; y++) {
+					const auto tile = FCoordinate2D(x, y);
+					if (!center.IsWithinHexRange(tile, range)) {
+						continue;
+					}
+
+					if (auto bucket = TileBuckets.Find(tile)) {
+						outHandles.Append(*bucket);
+					}
+				}
+			}
+		}
+	}
+}
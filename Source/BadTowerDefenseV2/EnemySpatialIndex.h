@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "CoordinateHashMap.h"
+
+#include "CoreMinimal.h"
+
+/**
+ * Buckets enemies by the global hex tile they're on, with a count per chunk on top so range queries can skip
+ * whole chunks nobody is in. Moving an enemy only touches the two tiles involved, and a range query only visits
+ * the tiles within range, so neither depends on how many enemies there are elsewhere.
+ *
+ * Enemies are identified by the handle Add returns. Handles of removed enemies get reused.
+ */
+class BADTOWERDEFENSEV2_API FEnemySpatialIndex
+{
+public:
+	explicit FEnemySpatialIndex(int32 chunkDimensions = 8);
+
+	/** Drops every enemy. Keeps the memory for the next wave */
+	void Reset();
+
+	int32 Add(const FCoordinate2D& tile);
+	void Remove(int32 handle);
+	void Move(int32 handle, const FCoordinate2D& tile);
+
+	bool IsValid(int32 handle) const {
+		return Enemies.IsValidIndex(handle) && Enemies[handle].bLive;
+	}
+
+	const FCoordinate2D& GetTile(int32 handle) const {
+		check(IsValid(handle));
+		return Enemies[handle].Tile;
+	}
+
+	int32 Num() const { return NumLive; }
+
+	/** One past the highest handle currently in use, for iterating over every handle */
+	int32 GetMaxHandle() const { return Enemies.Num(); }
+
+	int32 GetNumOnTile(const FCoordinate2D& tile) const;
+	int32 GetNumInChunk(const FCoordinate2D& chunkCoordinate) const;
+
+	/** Appends the handle of every enemy within range hexes of center (0 is just the center tile) to outHandles */
+	void Query(const FCoordinate2D& center, int32 range, TArray<int32>& outHandles) const;
+
+private:
+	struct FEnemy {
+		FCoordinate2D Tile;
+		// Where the enemy is in its tile's bucket
+		int32 SlotInTile = INDEX_NONE;
+		bool bLive = false;
+	};
+
+	void AddToBuckets(int32 handle);
+	void RemoveFromBuckets(int32 handle);
+
+	int32 ChunkDimensions;
+	int32 NumLive = 0;
+
+	TArray<FEnemy> Enemies;
+	TArray<int32> FreeHandles;
+
+	TCoordinateMap<TArray<int32>> TileBuckets;
+	TCoordinateMap<int32> ChunkCounts;
+};
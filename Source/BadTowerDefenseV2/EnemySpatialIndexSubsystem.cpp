@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySpatialIndexSubsystem.h"
+#include "HexFlowFieldSubsystem.h"
+#include "MapUtilitiesLibrary.h"
+
+#include "GameFramework/Actor.h"
+
+void UEnemySpatialIndexSubsystem::Deinitialize()
+{
+	Index.Reset();
+	HandleToEnemy.Reset();
+	EnemyToHandle.Reset();
+	Super::Deinitialize();
+}
+
+bool UEnemySpatialIndexSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UEnemySpatialIndexSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemySpatialIndexSubsystem, STATGROUP_Tickables);
+}
+
+float UEnemySpatialIndexSubsystem::GetTileSize() const
+{
+	// The flow field owns the tile size so the two can't disagree about which tile an enemy is on
+	auto flowField = GetWorld()->GetSubsystem<UHexFlowFieldSubsystem>();
+	return flowField ? flowField->TileSize : 100.f;
+}
+
+FCoordinate2D UEnemySpatialIndexSubsystem::GetEnemyTile(const AActor* enemy, float tileSize) const
+{
+	return UMapUtilitiesLibrary::ConvertWorldLocationToGlobalCoordinate(enemy->GetActorLocation(), tileSize);
+}
+
+void UEnemySpatialIndexSubsystem::RegisterEnemy(AActor* enemy)
+{
+	if (!enemy || EnemyToHandle.Contains(enemy)) {
+		return;
+	}
+
+	const auto handle = Index.Add(GetEnemyTile(enemy, GetTileSize()));
+	if (handle >= HandleToEnemy.Num()) {
+		HandleToEnemy.SetNum(handle + 1);
+	}
+	HandleToEnemy[handle] = enemy;
+	EnemyToHandle.Add(enemy, handle);
+}
+
+void UEnemySpatialIndexSubsystem::UnregisterEnemy(AActor* enemy)
+{
+	int32 handle = INDEX_NONE;
+	if (!EnemyToHandle.RemoveAndCopyValue(enemy, handle)) {
+		return;
+	}
+
+	Index.Remove(handle);
+	HandleToEnemy[handle] = TObjectKey<AActor>();
+}
+
+void UEnemySpatialIndexSubsystem::UpdateEnemy(AActor* enemy)
+{
+	auto handle = EnemyToHandle.Find(enemy);
+	if (handle && enemy) {
+		Index.Move(*handle, GetEnemyTile(enemy, GetTileSize()));
+	}
+}
+
+void UEnemySpatialIndexSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const auto tileSize = GetTileSize();
+	for (int32 handle = 0; handle < HandleToEnemy.Num(); handle++) {
+		if (!Index.IsValid(handle)) {
+			continue;
+		}
+
+		auto enemy = HandleToEnemy[handle].ResolveObjectPtr();
+		if (!enemy) {
+			// Destroyed without unregistering
+			EnemyToHandle.Remove(HandleToEnemy[handle]);
+			Index.Remove(handle);
+			HandleToEnemy[handle] = TObjectKey<AActor>();
+			continue;
+		}
+
+		// Move doesn't touch the buckets unless the tile actually changed
+		Index.Move(handle, GetEnemyTile(enemy, tileSize));
+	}
+}
+
+int32 UEnemySpatialIndexSubsystem::GetEnemiesInRange(const FVector& worldLocation, int32 range, TArray<AActor*>& outEnemies, int32 maxResults)
+{
+	return GetEnemiesInRangeOfTile(UMapUtilitiesLibrary::ConvertWorldLocationToGlobalCoordinate(worldLocation, GetTileSize()), range, outEnemies, maxResults);
+}
+
+int32 UEnemySpatialIndexSubsystem::GetEnemiesInRangeOfTile(const FCoordinate2D& tile, int32 range, TArray<AActor*>& outEnemies, int32 maxResults)
+{
+	outEnemies.Reset();
+
+	QueryHandles.Reset();
+	Index.Query(tile, range, QueryHandles);
+
+	// Sort on (tiles left to the headquarters, handle). Enemies the flow field can't route go last
+	auto flowField = GetWorld()->GetSubsystem<UHexFlowFieldSubsystem>();
+	SortKeys.Reset();
+	for (auto handle : QueryHandles) {
+		auto distance = flowField ? flowField->GetDistanceToGoal(Index.GetTile(handle)) : INDEX_NONE;
+		SortKeys.Emplace(distance == INDEX_NONE ? TNumericLimits<int32>::Max() : distance, handle);
+	}
+	SortKeys.Sort([](const TPair<int32, int32>& lhs, const TPair<int32, int32>& rhs) {
+		return lhs.Key != rhs.Key ? lhs.Key < rhs.Key : lhs.Value < rhs.Value;
+	});
+
+	const auto count = maxResults > 0 ? FMath::Min(maxResults, SortKeys.Num()) : SortKeys.Num();
+	outEnemies.Reserve(count);
+	for (int32 i = 0; i < count; i++) {
+		if (auto enemy = HandleToEnemy[SortKeys[i].Value].ResolveObjectPtr()) {
+			outEnemies.Add(enemy);
+		}
+	}
+	return outEnemies.Num();
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "EnemySpatialIndex.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "EnemySpatialIndexSubsystem.generated.h"
+
+/**
+ * Keeps every live enemy bucketed by hex tile so towers can find targets without overlap queries.
+ *
+ * Enemies register when they spawn. Every tick each one is re-bucketed if it moved to another tile, and enemies
+ * that were destroyed without unregistering are dropped. Range queries come back ordered nearest to the
+ * headquarters first, by flow field distance (see UHexFlowFieldSubsystem).
+ */
+UCLASS()
+class BADTOWERDEFENSEV2_API UEnemySpatialIndexSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	UFUNCTION(BlueprintCallable, Category = "Enemy Spatial Index")
+	void RegisterEnemy(AActor* enemy);
+
+	UFUNCTION(BlueprintCallable, Category = "Enemy Spatial Index")
+	void UnregisterEnemy(AActor* enemy);
+
+	/** Re-buckets one enemy right away instead of waiting for the next tick */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Spatial Index")
+	void UpdateEnemy(AActor* enemy);
+
+	/**
+	 * Enemies within range tiles of worldLocation, nearest to the headquarters first.
+	 * maxResults <= 0 returns all of them. Returns the number found.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Spatial Index")
+	int32 GetEnemiesInRange(const FVector& worldLocation, int32 range, TArray<AActor*>& outEnemies, int32 maxResults = 0);
+
+	/** Same as GetEnemiesInRange, around a global tile */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Spatial Index")
+	int32 GetEnemiesInRangeOfTile(const FCoordinate2D& tile, int32 range, TArray<AActor*>& outEnemies, int32 maxResults = 0);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Enemy Spatial Index")
+	int32 GetNumEnemies() const { return Index.Num(); }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Enemy Spatial Index")
+	int32 GetNumEnemiesOnTile(const FCoordinate2D& tile) const { return Index.GetNumOnTile(tile); }
+
+	const FEnemySpatialIndex& GetIndex() const { return Index; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	float GetTileSize() const;
+	FCoordinate2D GetEnemyTile(const AActor* enemy, float tileSize) const;
+
+	FEnemySpatialIndex Index;
+
+	// Indexed by handle, null for free handles. Keys stay unique once the enemy is destroyed, so stale ones can still be removed
+	TArray<TObjectKey<AActor>> HandleToEnemy;
+	TMap<TObjectKey<AActor>, int32> EnemyToHandle;
+
+	// Scratch for queries
+	TArray<int32> QueryHandles;
+	TArray<TPair<int32, int32>> SortKeys;
+};
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+
+#include "CoreMinimal.h"
+#include "FChunkPath.generated.h"
+
+/**
+ * The generated road through a single chunk. Entry, Exit and Path are all chunk-local coordinates.
+ */
+USTRUCT(BlueprintType)
+struct FChunkPath {
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(BlueprintReadWrite, Category = "Chunk")
+	FCoordinate2D ChunkCoordinate;
+
+	// Tile the road comes in through (connects to the previous chunk's Exit)
+	UPROPERTY(BlueprintReadWrite, Category = "Chunk")
+	FCoordinate2D Entry;
+
+	// Tile the road leaves through (connects to the next chunk's Entry)
+	UPROPERTY(BlueprintReadWrite, Category = "Chunk")
+	FCoordinate2D Exit;
+
+	// Road tiles from Exit back to Entry, same order as URandomWalkLibrary::DijkstraRandomPath
+	UPROPERTY(BlueprintReadWrite, Category = "Chunk")
+	TArray<FCoordinate2D> Path;
+};
@@ -35,7 +35,44 @@ struct FCoordinate2D {
 		return Tie(lhs.X, lhs.Y) < Tie(rhs.X, rhs.Y);
 	}
 
+	// Axial column of the tile in the map's hex layout (rows along Y, odd rows shifted towards +X). The axial row is Y.
+	// See HexMath.h for the rest of the cube/axial helpers
+	int32 GetAxialQ() const {
+		return X - (Y >> 1);
+	}
+
+	/** Number of steps to other through neighboring tiles */
+	int32 GetHexDistance(const FCoordinate2D& other) const {
+		const auto dq = GetAxialQ() - other.GetAxialQ();
+		const auto dr = Y - other.Y;
+		return (FMath::Abs(dq) + FMath::Abs(dr) + FMath::Abs(dq + dr)) / 2;
+	}
+
+	bool IsWithinHexRange(const FCoordinate2D& other, int32 range) const {
+		return GetHexDistance(other) <= range;
+	}
+
+	// X in the high half, Y in the low half, so every coordinate gets its own key
+	uint64 ToPackedKey() const {
+		return static_cast<uint64>(static_cast<uint32>(X)) << 32 | static_cast<uint32>(Y);
+	}
+
+	static FCoordinate2D FromPackedKey(uint64 key) {
+		return FCoordinate2D(static_cast<int32>(static_cast<uint32>(key >> 32)), static_cast<int32>(static_cast<uint32>(key)));
+	}
+
+	// SplitMix64 finalizer. Small signed coordinates only differ in a few low (or sign extended high) bits,
+	// so they need every input bit spread over the whole output before we take a bucket from it
+	static constexpr uint64 MixPackedKey(uint64 key) {
+		key ^= key >> 30;
+		key *= 0xBF58476D1CE4E5B9ull;
+		key ^= key >> 27;
+		key *= 0x94D049BB133111EBull;
+		key ^= key >> 31;
+		return key;
+	}
+
 	friend uint32 GetTypeHash(const FCoordinate2D& obj) {
-		return obj.X * 402653189 ^ obj.Y * 805306457;
+		return static_cast<uint32>(MixPackedKey(obj.ToPackedKey()));
 	}
 };
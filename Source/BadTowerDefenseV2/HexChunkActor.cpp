@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HexChunkActor.h"
+#include "MapUtilitiesLibrary.h"
+
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+
+constexpr int32 NUM_TILE_TYPES = static_cast<int32>(EHexTileType::MAX);
+
+AHexChunkActor::AHexChunkActor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	const auto tileTypeEnum = StaticEnum<EHexTileType>();
+	for (int32 type = 0; type < NUM_TILE_TYPES; type++) {
+		const auto name = FName(*FString::Printf(TEXT("%sTiles"), *tileTypeEnum->GetNameStringByIndex(type)));
+		auto component = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(name);
+		component->SetupAttachment(RootComponent);
+		// Custom data 0: whether the tile is occupied (SetTileOccupied)
+		component->NumCustomDataFloats = 1;
+		TileComponents.Add(component);
+	}
+
+	InstanceTiles.SetNum(NUM_TILE_TYPES);
+}
+
+bool AHexChunkActor::IsValidLocalTile(const FCoordinate2D& localTile) const
+{
+	return localTile.X >= 0 && localTile.Y >= 0 && localTile.X < Dimensions && localTile.Y < Dimensions;
+}
+
+int32 AHexChunkActor::GetTileIndex(const FCoordinate2D& localTile) const
+{
+	// Same as UMapUtilitiesLibrary::ConvertCoordinatesToIndex
+	return localTile.X * Dimensions + localTile.Y;
+}
+
+FTransform AHexChunkActor::GetTileTransform(int32 tileIndex) const
+{
+	// Row offsets depend on the global row, so go through global coordinates rather than laying out a local grid
+	const auto origin = FCoordinate2D(ChunkCoordinate.X * Dimensions, ChunkCoordinate.Y * Dimensions);
+	const auto tile = FCoordinate2D(origin.X + tileIndex / Dimensions, origin.Y + tileIndex % Dimensions);
+
+	const auto location = UMapUtilitiesLibrary::ConvertGlobalCoordinateToWorldLocation(tile, TileSize)
+		- UMapUtilitiesLibrary::ConvertGlobalCoordinateToWorldLocation(origin, TileSize);
+	return FTransform(location);
+}
+
+void AHexChunkActor::ClearTiles()
+{
+	for (auto component : TileComponents) {
+		component->ClearInstances();
+	}
+	for (auto& instanceTiles : InstanceTiles) {
+		instanceTiles.Reset();
+	}
+
+	TileTypes.Reset();
+	TileInstances.Reset();
+	TileOccupied.Reset();
+	Dimensions = 0;
+}
+
+void AHexChunkActor::BuildFromChunkPath(const FChunkPath& chunk, int32 dimensions)
+{
+	TArray<EHexTileType> tileTypes;
+	tileTypes.Init(EHexTileType::Land, dimensions * dimensions);
+	for (auto& tile : chunk.Path) {
+		if (tile.X >= 0 && tile.Y >= 0 && tile.X < dimensions && tile.Y < dimensions) {
+			tileTypes[tile.X * dimensions + tile.Y] = EHexTileType::Road;
+		}
+	}
+
+	BuildFromTileTypes(chunk.ChunkCoordinate, tileTypes, dimensions);
+}
+
+void AHexChunkActor::BuildFromTileTypes(const FCoordinate2D& chunkCoordinate, TConstArrayView<EHexTileType> tileTypes, int32 dimensions)
+{
+	ClearTiles();
+
+	const auto numTiles = dimensions * dimensions;
+	if (tileTypes.Num() != numTiles) {
+		return;
+	}
+
+	ChunkCoordinate = chunkCoordinate;
+	Dimensions = dimensions;
+
+	TileTypes.Append(tileTypes.GetData(), tileTypes.Num());
+	TileInstances.Init(INDEX_NONE, numTiles);
+	TileOccupied.Init(false, numTiles);
+
+	SetActorLocation(UMapUtilitiesLibrary::ConvertGlobalCoordinateToWorldLocation(
+		FCoordinate2D(ChunkCoordinate.X * dimensions, ChunkCoordinate.Y * dimensions), TileSize));
+
+	// One AddInstances per type instead of one AddInstance per tile, so each component builds its tree once
+	TArray<FTransform> transforms;
+	transforms.Reserve(numTiles);
+	for (int32 type = 0; type < NUM_TILE_TYPES; type++) {
+		transforms.Reset();
+		auto& instanceTiles = InstanceTiles[type];
+		for (int32 tileIndex = 0; tileIndex < numTiles; tileIndex++) {
+			if (static_cast<int32>(TileTypes[tileIndex]) == type) {
+				TileInstances[tileIndex] = instanceTiles.Add(tileIndex);
+				transforms.Add(GetTileTransform(tileIndex));
+			}
+		}
+
+		if (!transforms.IsEmpty()) {
+			TileComponents[type]->AddInstances(transforms, false);
+		}
+	}
+}
+
+void AHexChunkActor::AddTileInstance(int32 tileIndex)
+{
+	const auto type = static_cast<int32>(TileTypes[tileIndex]);
+	auto component = TileComponents[type].Get();
+
+	const auto instance = component->AddInstance(GetTileTransform(tileIndex));
+	check(instance == InstanceTiles[type].Num());
+	InstanceTiles[type].Add(tileIndex);
+	TileInstances[tileIndex] = instance;
+
+	if (TileOccupied[tileIndex]) {
+		component->SetCustomDataValue(instance, 0, 1.f, true);
+	}
+}
+
+void AHexChunkActor::RemoveTileInstance(int32 tileIndex)
+{
+	const auto type = static_cast<int32>(TileTypes[tileIndex]);
+	const auto instance = TileInstances[tileIndex];
+
+	// The HISM fills the hole with its last instance, so follow that instance to its new index
+	TileComponents[type]->RemoveInstance(instance);
+
+	auto& instanceTiles = InstanceTiles[type];
+	instanceTiles.RemoveAtSwap(instance, 1, false);
+	if (instanceTiles.IsValidIndex(instance)) {
+		TileInstances[instanceTiles[instance]] = instance;
+	}
+	TileInstances[tileIndex] = INDEX_NONE;
+}
+
+void AHexChunkActor::SetTileType(const FCoordinate2D& localTile, EHexTileType type)
+{
+	if (!IsValidLocalTile(localTile) || type == EHexTileType::MAX) {
+		return;
+	}
+
+	const auto tileIndex = GetTileIndex(localTile);
+	if (TileTypes[tileIndex] == type) {
+		return;
+	}
+
+	RemoveTileInstance(tileIndex);
+	TileTypes[tileIndex] = type;
+	AddTileInstance(tileIndex);
+}
+
+EHexTileType AHexChunkActor::GetTileType(const FCoordinate2D& localTile) const
+{
+	return IsValidLocalTile(localTile) ? TileTypes[GetTileIndex(localTile)] : EHexTileType::Invalid;
+}
+
+void AHexChunkActor::SetTileOccupied(const FCoordinate2D& localTile, bool bOccupied)
+{
+	if (!IsValidLocalTile(localTile)) {
+		return;
+	}
+
+	const auto tileIndex = GetTileIndex(localTile);
+	if (TileOccupied[tileIndex] == bOccupied) {
+		return;
+	}
+
+	TileOccupied[tileIndex] = bOccupied;
+	TileComponents[static_cast<int32>(TileTypes[tileIndex])]->SetCustomDataValue(TileInstances[tileIndex], 0, bOccupied ? 1.f : 0.f, true);
+}
+
+bool AHexChunkActor::IsTileOccupied(const FCoordinate2D& localTile) const
+{
+	return IsValidLocalTile(localTile) && TileOccupied[GetTileIndex(localTile)];
+}
+
+int32 AHexChunkActor::GetNumTileInstances(EHexTileType type) const
+{
+	auto component = GetTileComponent(type);
+	return component ? component->GetInstanceCount() : 0;
+}
+
+UHierarchicalInstancedStaticMeshComponent* AHexChunkActor::GetTileComponent(EHexTileType type) const
+{
+	const auto index = static_cast<int32>(type);
+	return TileComponents.IsValidIndex(index) ? TileComponents[index].Get() : nullptr;
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "FChunkPath.h"
+#include "HexTileType.h"
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "HexChunkActor.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+
+/**
+ * A whole chunk of tiles as one actor: one hierarchical instanced static mesh per tile type, one instance per tile.
+ * Replaces spawning a tile actor per hex (64 actors for a default sized chunk) with one actor and a handful of
+ * components.
+ *
+ * Changing a tile's type moves its instance from one component to the other, and marking a tile occupied (e.g. by a
+ * tower) only writes that instance's custom data, so neither rebuilds the chunk.
+ */
+UCLASS(Blueprintable)
+class BADTOWERDEFENSEV2_API AHexChunkActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AHexChunkActor();
+
+	/** Lays out every tile of chunk: road tiles on its path, land everywhere else. Moves the actor to the chunk */
+	UFUNCTION(BlueprintCallable, Category = "Hex Chunk")
+	void BuildFromChunkPath(const FChunkPath& chunk, int32 dimensions = 8);
+
+	/** Lays out a chunk from one tile type per tile, indexed like UMapUtilitiesLibrary::ConvertCoordinatesToIndex (e.g. from FChunkFileView::ReadTileTypes) */
+	void BuildFromTileTypes(const FCoordinate2D& chunkCoordinate, TConstArrayView<EHexTileType> tileTypes, int32 dimensions = 8);
+
+	/** Removes every tile instance */
+	UFUNCTION(BlueprintCallable, Category = "Hex Chunk")
+	void ClearTiles();
+
+	/** localTile is a chunk-local coordinate */
+	UFUNCTION(BlueprintCallable, Category = "Hex Chunk")
+	void SetTileType(const FCoordinate2D& localTile, EHexTileType type);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Hex Chunk")
+	EHexTileType GetTileType(const FCoordinate2D& localTile) const;
+
+	/** Sets the tile's per-instance custom data 0 to 1 (occupied) or 0, for the tile material to react to */
+	UFUNCTION(BlueprintCallable, Category = "Hex Chunk")
+	void SetTileOccupied(const FCoordinate2D& localTile, bool bOccupied);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Hex Chunk")
+	bool IsTileOccupied(const FCoordinate2D& localTile) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Hex Chunk")
+	FCoordinate2D GetChunkCoordinate() const { return ChunkCoordinate; }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Hex Chunk")
+	int32 GetNumTileInstances(EHexTileType type) const;
+
+	UHierarchicalInstancedStaticMeshComponent* GetTileComponent(EHexTileType type) const;
+
+	// Distance between the centers of neighboring tiles
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Hex Chunk")
+	float TileSize = 100.f;
+
+private:
+	bool IsValidLocalTile(const FCoordinate2D& localTile) const;
+	int32 GetTileIndex(const FCoordinate2D& localTile) const;
+	FTransform GetTileTransform(int32 tileIndex) const;
+
+	void AddTileInstance(int32 tileIndex);
+	void RemoveTileInstance(int32 tileIndex);
+
+	// One per EHexTileType, meshes and materials are set per component in the Blueprint
+	UPROPERTY(VisibleAnywhere, Category = "Hex Chunk")
+	TArray<TObjectPtr<UHierarchicalInstancedStaticMeshComponent>> TileComponents;
+
+	FCoordinate2D ChunkCoordinate;
+	int32 Dimensions = 0;
+
+	// Per tile, indexed like UMapUtilitiesLibrary::ConvertCoordinatesToIndex
+	TArray<EHexTileType> TileTypes;
+	TArray<int32> TileInstances;
+	TArray<bool> TileOccupied;
+
+	// Per tile type, the tile each instance stands for
+	TArray<TArray<int32>> InstanceTiles;
+};
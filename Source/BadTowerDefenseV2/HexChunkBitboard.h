@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+
+#include "CoreMinimal.h"
+
+/**
+ * One bit per tile of a default sized (8x8) chunk, using the same index as UMapUtilitiesLibary::ConvertCoordinatesToIndex
+ * (bit X * 8 + Y). Neighbor expansion follows the map's hex layout (FMapHexLayout): X +/- 1 is a shift by 8,
+ * Y +/- 1 a shift by 1, and the diagonal neighbors depend on the parity of Y, which is just a mask on the bit index.
+ *
+ * That turns flood fills and "does this tower block the path?" into a handful of shifts per step.
+ */
+struct BADTOWERDEFENSEV2_API FHexChunkBitboard {
+	static constexpr int32 Dimensions = 8;
+
+	static constexpr uint64 AllTiles = ~0ull;
+	static constexpr uint64 FirstY = 0x0101010101010101ull;
+	static constexpr uint64 LastY = 0x8080808080808080ull;
+	static constexpr uint64 FirstX = 0x00000000000000FFull;
+	static constexpr uint64 LastX = 0xFF00000000000000ull;
+	static constexpr uint64 EvenY = 0x5555555555555555ull;
+	static constexpr uint64 OddY = 0xAAAAAAAAAAAAAAAAull;
+
+	static constexpr uint64 Border = FirstX | LastX | FirstY | LastY;
+	static constexpr uint64 Corners = (1ull << 0) | (1ull << 7) | (1ull << 56) | (1ull << 63);
+	static constexpr uint64 NonCornerEdges = Border & ~Corners;
+
+	// Tiles that can be walked on at all
+	uint64 Walkable = AllTiles;
+	// Tiles with a tower on them, never walkable while occupied
+	uint64 Tower = 0;
+	// Tiles on the chunk's road
+	uint64 Path = 0;
+
+	static constexpr bool IsInBounds(const FCoordinate2D& tile) {
+		return tile.X >= 0 && tile.Y >= 0 && tile.X < Dimensions && tile.Y < Dimensions;
+	}
+
+	static constexpr uint64 BitOf(const FCoordinate2D& tile) {
+		return IsInBounds(tile) ? 1ull << (tile.X * Dimensions + tile.Y) : 0;
+	}
+
+	static constexpr bool Contains(uint64 tiles, const FCoordinate2D& tile) {
+		return (tiles & BitOf(tile)) != 0;
+	}
+
+	static constexpr bool IsNonCornerEdgeTile(const FCoordinate2D& tile) {
+		return Contains(NonCornerEdges, tile);
+	}
+
+	/** Every tile in tiles plus all of their neighbors */
+	static constexpr uint64 Dilate(uint64 tiles) {
+		return tiles
+			| (tiles << 8) | (tiles >> 8)                                   // X + 1, X - 1
+			| ((tiles & ~LastY) << 1) | ((tiles & ~FirstY) >> 1)            // Y + 1, Y - 1
+			| ((tiles & EvenY & ~LastY) >> 7) | ((tiles & EvenY & ~FirstY) >> 9) // even Y: (X - 1, Y + 1), (X - 1, Y - 1)
+			| ((tiles & OddY & ~LastY) << 9) | ((tiles & OddY & ~FirstY) << 7);  // odd Y: (X + 1, Y + 1), (X + 1, Y - 1)
+	}
+
+	/** Just the neighbors of tiles, not the tiles themselves */
+	static constexpr uint64 Neighbors(uint64 tiles) {
+		return Dilate(tiles) & ~tiles;
+	}
+
+	/** All tiles in passable that can be reached from seeds without leaving passable */
+	static uint64 FloodFill(uint64 seeds, uint64 passable) {
+		auto reached = seeds & passable;
+		while (true) {
+			auto next = Dilate(reached) & passable;
+			if (next == reached) {
+				return reached;
+			}
+			reached = next;
+		}
+	}
+
+	static bool IsReachable(const FCoordinate2D& from, const FCoordinate2D& to, uint64 passable) {
+		const auto target = BitOf(to);
+		if (!target || !(passable & target)) {
+			return false;
+		}
+
+		// Same as FloodFill, but stop as soon as we get there
+		auto reached = BitOf(from) & passable;
+		while (!(reached & target)) {
+			auto next = Dilate(reached) & passable;
+			if (next == reached) {
+				return false;
+			}
+			reached = next;
+		}
+		return true;
+	}
+
+	uint64 GetPassable() const {
+		return Walkable & ~Tower;
+	}
+
+	/** Would putting a tower on tile cut entry off from exit? */
+	bool WouldBlockPath(const FCoordinate2D& tile, const FCoordinate2D& entry, const FCoordinate2D& exit) const {
+		return !IsReachable(entry, exit, GetPassable() & ~BitOf(tile));
+	}
+
+	static void SetTile(uint64& tiles, const FCoordinate2D& tile, bool bSet) {
+		tiles = bSet ? tiles | BitOf(tile) : tiles & ~BitOf(tile);
+	}
+
+	static uint64 FromTiles(TConstArrayView<FCoordinate2D> tiles) {
+		uint64 result = 0;
+		for (auto& tile : tiles) {
+			result |= BitOf(tile);
+		}
+		return result;
+	}
+
+	static TArray<FCoordinate2D> ToTiles(uint64 tiles) {
+		TArray<FCoordinate2D> result;
+		result.Reserve(FMath::CountBits(tiles));
+		while (tiles) {
+			const auto index = static_cast<int32>(FMath::CountTrailingZeros64(tiles));
+			result.Emplace(index / Dimensions, index % Dimensions);
+			tiles &= tiles - 1;
+		}
+		return result;
+	}
+};
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HexFlowField.h"
+#include "HexLayout.h"
+#include "MapGenStats.h"
+
+void FHexFlowField::Reset()
+{
+	Walkable.Reset();
+	Blocked.Reset();
+	Field.Reset();
+	bHasGoal = false;
+	bDirty = false;
+}
+
+void FHexFlowField::SetTileWalkable(const FCoordinate2D& tile, bool bWalkable)
+{
+	if (bWalkable) {
+		bool bAlreadyInSet = false;
+		Walkable.Add(tile, &bAlreadyInSet);
+		bDirty |= !bAlreadyInSet;
+	}
+	else {
+		bDirty |= Walkable.Remove(tile);
+	}
+}
+
+void FHexFlowField::SetTileBlocked(const FCoordinate2D& tile, bool bBlocked)
+{
+	if (bBlocked) {
+		bool bAlreadyInSet = false;
+		Blocked.Add(tile, &bAlreadyInSet);
+		bDirty |= !bAlreadyInSet;
+	}
+	else {
+		bDirty |= Blocked.Remove(tile);
+	}
+}
+
+void FHexFlowField::SetGoal(const FCoordinate2D& tile)
+{
+	bDirty |= !bHasGoal || Goal != tile;
+	Goal = tile;
+	bHasGoal = true;
+}
+
+void FHexFlowField::ClearGoal()
+{
+	bDirty |= bHasGoal;
+	bHasGoal = false;
+}
+
+void FHexFlowField::Rebuild()
+{
+	MAPGEN_SCOPE(FlowFieldRebuild);
+
+	bDirty = false;
+	Field.Reset();
+	Frontier.Reset();
+
+	if (!bHasGoal || !IsPassable(Goal)) {
+		return;
+	}
+
+	// Every step costs the same, so a plain breadth-first search visits tiles in order of distance
+	Field.Reserve(Walkable.Num());
+	Field.Add(Goal, { 0, Goal });
+	Frontier.Add(Goal);
+
+	for (int32 head = 0; head < Frontier.Num(); head++) {
+		const auto current = Frontier[head];
+		const auto distance = Field.Find(current)->Distance + 1;
+
+		ForEachHexNeighbor<FMapHexLayout>(current, [&](const FCoordinate2D& neighbor) {
+			if (!IsPassable(neighbor) || Field.Contains(neighbor)) {
+				return;
+			}
+
+			Field.Add(neighbor, { distance, current });
+			Frontier.Add(neighbor);
+		});
+	}
+}
+
+bool FHexFlowField::GetNextTile(const FCoordinate2D& tile, FCoordinate2D& outNextTile) const
+{
+	if (auto flow = Field.Find(tile)) {
+		outNextTile = flow->NextTile;
+		return true;
+	}
+
+	// Off the field, head back on to it wherever it's closest to the goal
+	auto bestDistance = TNumericLimits<int32>::Max();
+	ForEachHexNeighbor<FMapHexLayout>(tile, [&](const FCoordinate2D& neighbor) {
+		auto flow = Field.Find(neighbor);
+		if (flow && flow->Distance < bestDistance) {
+			bestDistance = flow->Distance;
+			outNextTile = neighbor;
+		}
+	});
+	return bestDistance != TNumericLimits<int32>::Max();
+}
+
+int32 FHexFlowField::GetDistanceToGoal(const FCoordinate2D& tile) const
+{
+	auto flow = Field.Find(tile);
+	return flow ? flow->Distance : INDEX_NONE;
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "CoordinateHashMap.h"
+
+#include "CoreMinimal.h"
+
+/**
+ * Flow field over global hex tiles: one breadth-first pass out from the goal (the headquarters) gives every
+ * reachable tile its distance to the goal and the neighbor to step to next, so any number of units can
+ * look up where to go without pathfinding on their own.
+ *
+ * Changing tiles or the goal only marks the field dirty; call Rebuild once after a batch of changes.
+ */
+class BADTOWERDEFENSEV2_API FHexFlowField
+{
+public:
+	/** Forgets every tile and the goal. Keeps the memory for the next map */
+	void Reset();
+
+	void SetTileWalkable(const FCoordinate2D& tile, bool bWalkable);
+
+	/** Blocked tiles (e.g. under a tower) stay walkable but are skipped until they're unblocked */
+	void SetTileBlocked(const FCoordinate2D& tile, bool bBlocked);
+
+	void SetGoal(const FCoordinate2D& tile);
+	void ClearGoal();
+
+	bool IsDirty() const { return bDirty; }
+
+	void Rebuild();
+
+	/**
+	 * The tile to step to from tile. The goal points at itself. A tile that isn't on the field (e.g. a unit that got
+	 * pushed off the road) points at its neighbor that is closest to the goal. Returns false if there's neither.
+	 */
+	bool GetNextTile(const FCoordinate2D& tile, FCoordinate2D& outNextTile) const;
+
+	/** Number of steps from tile to the goal, or INDEX_NONE if it can't get there */
+	int32 GetDistanceToGoal(const FCoordinate2D& tile) const;
+
+	int32 GetNumReachableTiles() const { return Field.Num(); }
+
+private:
+	struct FFlowTile {
+		int32 Distance = 0;
+		FCoordinate2D NextTile;
+	};
+
+	bool IsPassable(const FCoordinate2D& tile) const {
+		return Walkable.Contains(tile) && !Blocked.Contains(tile);
+	}
+
+	FCoordinateSet Walkable;
+	FCoordinateSet Blocked;
+
+	FCoordinate2D Goal;
+	bool bHasGoal = false;
+	bool bDirty = false;
+
+	TCoordinateMap<FFlowTile> Field;
+	TArray<FCoordinate2D> Frontier;
+};
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HexFlowFieldSubsystem.h"
+#include "MapUtilitiesLibrary.h"
+
+void UHexFlowFieldSubsystem::Deinitialize()
+{
+	FlowField.Reset();
+	Super::Deinitialize();
+}
+
+bool UHexFlowFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UHexFlowFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHexFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+void UHexFlowFieldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// However many tiles changed this frame, that's one rebuild
+	RebuildIfDirty();
+}
+
+void UHexFlowFieldSubsystem::RebuildIfDirty()
+{
+	if (FlowField.IsDirty()) {
+		FlowField.Rebuild();
+	}
+}
+
+void UHexFlowFieldSubsystem::AddChunkPath(const FChunkPath& chunk, int32 dimensions)
+{
+	SetChunkPathWalkable(chunk, dimensions, true);
+}
+
+void UHexFlowFieldSubsystem::RemoveChunkPath(const FChunkPath& chunk, int32 dimensions)
+{
+	SetChunkPathWalkable(chunk, dimensions, false);
+}
+
+void UHexFlowFieldSubsystem::SetChunkPathWalkable(const FChunkPath& chunk, int32 dimensions, bool bWalkable)
+{
+	const auto originX = chunk.ChunkCoordinate.X * dimensions;
+	const auto originY = chunk.ChunkCoordinate.Y * dimensions;
+	for (auto& tile : chunk.Path) {
+		FlowField.SetTileWalkable(FCoordinate2D(originX + tile.X, originY + tile.Y), bWalkable);
+	}
+}
+
+void UHexFlowFieldSubsystem::SetTilesWalkable(const TArray<FCoordinate2D>& tiles, bool bWalkable)
+{
+	for (auto& tile : tiles) {
+		FlowField.SetTileWalkable(tile, bWalkable);
+	}
+}
+
+void UHexFlowFieldSubsystem::SetTileBlocked(const FCoordinate2D& tile, bool bBlocked)
+{
+	FlowField.SetTileBlocked(tile, bBlocked);
+}
+
+void UHexFlowFieldSubsystem::SetGoal(const FCoordinate2D& tile)
+{
+	FlowField.SetGoal(tile);
+}
+
+void UHexFlowFieldSubsystem::SetGoalFromWorldLocation(const FVector& worldLocation)
+{
+	FlowField.SetGoal(UMapUtilitiesLibrary::ConvertWorldLocationToGlobalCoordinate(worldLocation, TileSize));
+}
+
+void UHexFlowFieldSubsystem::ClearFlowField()
+{
+	FlowField.Reset();
+}
+
+bool UHexFlowFieldSubsystem::GetNextTile(const FCoordinate2D& tile, FCoordinate2D& outNextTile) const
+{
+	return FlowField.GetNextTile(tile, outNextTile);
+}
+
+int32 UHexFlowFieldSubsystem::GetDistanceToGoal(const FCoordinate2D& tile) const
+{
+	return FlowField.GetDistanceToGoal(tile);
+}
+
+FVector UHexFlowFieldSubsystem::GetFlowDirection(const FVector& worldLocation) const
+{
+	const auto tile = UMapUtilitiesLibrary::ConvertWorldLocationToGlobalCoordinate(worldLocation, TileSize);
+
+	FCoordinate2D nextTile;
+	if (!FlowField.GetNextTile(tile, nextTile)) {
+		return FVector::ZeroVector;
+	}
+
+	// At the goal this heads for the middle of the tile, and stops once it's close enough instead of jittering around it
+	const auto target = UMapUtilitiesLibrary::ConvertGlobalCoordinateToWorldLocation(nextTile, TileSize);
+	const auto offset = FVector(target.X - worldLocation.X, target.Y - worldLocation.Y, 0.0);
+	if (offset.SizeSquared() <= FMath::Square(ArrivalRadius)) {
+		return FVector::ZeroVector;
+	}
+	return offset.GetUnsafeNormal();
+}
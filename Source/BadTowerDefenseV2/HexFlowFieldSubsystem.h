@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "FChunkPath.h"
+#include "HexFlowField.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HexFlowFieldSubsystem.generated.h"
+
+/**
+ * Shared navigation for enemy units. The map manager adds the road of every chunk and the headquarters tile,
+ * towers block and unblock their tiles, and the flow field is rebuilt at most once per frame after any of
+ * that changes. Units then ask for their next tile or direction, which is a lookup instead of a path query.
+ */
+UCLASS()
+class BADTOWERDEFENSEV2_API UHexFlowFieldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Makes the road through a chunk walkable */
+	UFUNCTION(BlueprintCallable, Category = "Flow Field")
+	void AddChunkPath(const FChunkPath& chunk, int32 dimensions = 8);
+
+	/** Undoes AddChunkPath, e.g. when the chunk streams out */
+	UFUNCTION(BlueprintCallable, Category = "Flow Field")
+	void RemoveChunkPath(const FChunkPath& chunk, int32 dimensions = 8);
+
+	/** Global tiles */
+	UFUNCTION(BlueprintCallable, Category = "Flow Field")
+	void SetTilesWalkable(const TArray<FCoordinate2D>& tiles, bool bWalkable = true);
+
+	UFUNCTION(BlueprintCallable, Category = "Flow Field")
+	void SetTileBlocked(const FCoordinate2D& tile, bool bBlocked);
+
+	/** The tile everything flows towards, i.e. where the headquarters is */
+	UFUNCTION(BlueprintCallable, Category = "Flow Field")
+	void SetGoal(const FCoordinate2D& tile);
+
+	UFUNCTION(BlueprintCallable, Category = "Flow Field")
+	void SetGoalFromWorldLocation(const FVector& worldLocation);
+
+	/** Removes every tile and the goal */
+	UFUNCTION(BlueprintCallable, Category = "Flow Field")
+	void ClearFlowField();
+
+	/** Rebuilds right away instead of waiting for the next tick, if anything changed */
+	UFUNCTION(BlueprintCallable, Category = "Flow Field")
+	void RebuildIfDirty();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Flow Field")
+	bool GetNextTile(const FCoordinate2D& tile, FCoordinate2D& outNextTile) const;
+
+	/** Number of tiles between tile and the goal, or -1 if it can't get there */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Flow Field")
+	int32 GetDistanceToGoal(const FCoordinate2D& tile) const;
+
+	/**
+	 * Unit direction (in the XY plane) from worldLocation towards the center of the next tile. Zero if there's nowhere
+	 * to go, or on the goal tile within ArrivalRadius of its center
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Flow Field")
+	FVector GetFlowDirection(const FVector& worldLocation) const;
+
+	const FHexFlowField& GetFlowField() const { return FlowField; }
+
+	// Distance between neighboring tile centers in world units, see UMapUtilitiesLibrary::ConvertGlobalCoordinateToWorldLocation
+	UPROPERTY(BlueprintReadWrite, Category = "Flow Field")
+	float TileSize = 100.f;
+
+	// How close to the goal's center counts as arrived, same as the enemy simulation's tolerance
+	UPROPERTY(BlueprintReadWrite, Category = "Flow Field")
+	float ArrivalRadius = 0.5f;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void SetChunkPathWalkable(const FChunkPath& chunk, int32 dimensions, bool bWalkable);
+
+	FHexFlowField FlowField;
+};
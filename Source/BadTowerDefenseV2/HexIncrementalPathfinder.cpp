@@ -0,0 +1,379 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HexIncrementalPathfinder.h"
+#include "HexChunkBitboard.h"
+#include "HexLayout.h"
+
+constexpr int64 INFINITE_COST = TNumericLimits<int64>::Max();
+
+static int64 AddCost(int64 lhs, int64 rhs)
+{
+	return lhs == INFINITE_COST || rhs == INFINITE_COST ? INFINITE_COST : lhs + rhs;
+}
+
+void FHexIncrementalPathfinder::Initialize(const FChunkRandom& random, int32 dimensions, const FCoordinate2D& start, const FCoordinate2D& end)
+{
+	Costs.Initialize(random, dimensions);
+	Dimensions = Costs.GetDimensions();
+	Start = start;
+	End = end;
+
+	const auto tileCount = Dimensions * Dimensions;
+	Blocked.Init(false, tileCount);
+	OnPath.Init(false, tileCount);
+	CostSoFar.Init(INFINITE_COST, tileCount);
+	Lookahead.Init(INFINITE_COST, tileCount);
+	Keys.SetNumUninitialized(tileCount, false);
+	HeapSlot.Init(INDEX_NONE, tileCount);
+	Heap.Reset();
+	BlockedBits = 0;
+	Path.Reset();
+	NodesExpanded = 0;
+
+	if (!IsInBounds(start) || !IsInBounds(end)) {
+		StartIndex = INDEX_NONE;
+		EndIndex = INDEX_NONE;
+		bDirty = false;
+		return;
+	}
+
+	StartIndex = ToIndex(start);
+	EndIndex = ToIndex(end);
+
+	// The first UpdatePath is a plain A* search, every one after that only repairs
+	UpdateVertex(StartIndex);
+	bDirty = true;
+}
+
+bool FHexIncrementalPathfinder::IsInBounds(const FCoordinate2D& tile) const
+{
+	return tile.X >= 0 && tile.Y >= 0 && tile.X < Dimensions && tile.Y < Dimensions;
+}
+
+bool FHexIncrementalPathfinder::SetTileBlocked(const FCoordinate2D& tile, bool bBlocked)
+{
+	if (StartIndex == INDEX_NONE || !IsInBounds(tile)) {
+		return false;
+	}
+
+	const auto index = ToIndex(tile);
+	if (Blocked[index] == bBlocked) {
+		return false;
+	}
+
+	Blocked[index] = bBlocked;
+	if (Dimensions == FHexChunkBitboard::Dimensions) {
+		FHexChunkBitboard::SetTile(BlockedBits, tile, bBlocked);
+	}
+
+	// Only the cost of entering this tile changed, so only its own lookahead is out of date
+	UpdateVertex(index);
+	bDirty = true;
+	return true;
+}
+
+bool FHexIncrementalPathfinder::IsTileBlocked(const FCoordinate2D& tile) const
+{
+	return IsInBounds(tile) && Blocked[ToIndex(tile)];
+}
+
+bool FHexIncrementalPathfinder::IsOnPath(const FCoordinate2D& tile) const
+{
+	return IsInBounds(tile) && OnPath[ToIndex(tile)];
+}
+
+int64 FHexIncrementalPathfinder::GetPathCost(const TArray<FCoordinate2D>& path) const
+{
+	if (path.IsEmpty() || StartIndex == INDEX_NONE) {
+		return INDEX_NONE;
+	}
+
+	// The start is where the path comes from, it's never entered
+	int64 cost = 0;
+	for (int32 i = 0; i < path.Num() - 1; i++) {
+		if (!IsInBounds(path[i])) {
+			return INDEX_NONE;
+		}
+		const auto tileCost = GetCost(ToIndex(path[i]));
+		if (tileCost == INFINITE_COST) {
+			return INDEX_NONE;
+		}
+		cost += tileCost;
+	}
+	return cost;
+}
+
+bool FHexIncrementalPathfinder::UpdatePath()
+{
+	if (!bDirty) {
+		return false;
+	}
+	bDirty = false;
+
+	NodesExpanded = 0;
+	ComputeShortestPath();
+
+	TArray<FCoordinate2D> newPath;
+	ExtractPath(newPath);
+	if (newPath == Path) {
+		return false;
+	}
+
+	for (auto& tile : Path) {
+		OnPath[ToIndex(tile)] = false;
+	}
+	Path = MoveTemp(newPath);
+	for (auto& tile : Path) {
+		OnPath[ToIndex(tile)] = true;
+	}
+	return true;
+}
+
+bool FHexIncrementalPathfinder::WouldDisconnect(const FCoordinate2D& tile) const
+{
+	if (StartIndex == INDEX_NONE || !IsInBounds(tile)) {
+		return false;
+	}
+
+	const auto index = ToIndex(tile);
+	if (Blocked[index]) {
+		// Blocking it again changes nothing
+		return false;
+	}
+
+	// The current path doesn't go through it, so it survives
+	if (!bDirty && HasPath() && !OnPath[index]) {
+		return false;
+	}
+
+	return !IsReachableWithout(index);
+}
+
+/// <summary>
+/// Whether end can still be reached from start with index blocked on top of the blocked tiles
+/// </summary>
+bool FHexIncrementalPathfinder::IsReachableWithout(int32 index) const
+{
+	if (index == StartIndex || index == EndIndex) {
+		return false;
+	}
+
+	if (Dimensions == FHexChunkBitboard::Dimensions) {
+		// Default chunk size, the tile index is the bit index
+		return FHexChunkBitboard::IsReachable(Start, End, ~BlockedBits & ~(1ull << index));
+	}
+
+	if (Blocked[StartIndex] || Blocked[EndIndex]) {
+		return false;
+	}
+
+	FloodReached.Init(false, Dimensions * Dimensions);
+	FloodQueue.Reset();
+	FloodReached[index] = true;
+	FloodReached[StartIndex] = true;
+	FloodQueue.Add(StartIndex);
+	for (int32 head = 0; head < FloodQueue.Num(); head++) {
+		const auto current = FloodQueue[head];
+		if (current == EndIndex) {
+			return true;
+		}
+
+		ForEachHexNeighborInBounds<FMapHexLayout>(ToTile(current), Dimensions, [this](const FCoordinate2D& neighbor) {
+			const auto neighborIndex = ToIndex(neighbor);
+			if (!FloodReached[neighborIndex] && !Blocked[neighborIndex]) {
+				FloodReached[neighborIndex] = true;
+				FloodQueue.Add(neighborIndex);
+			}
+		});
+	}
+	return false;
+}
+
+int64 FHexIncrementalPathfinder::GetCost(int32 index) const
+{
+	return Blocked[index] ? INFINITE_COST : Costs.GetEnterCost(index, EndIndex);
+}
+
+FHexIncrementalPathfinder::FKey FHexIncrementalPathfinder::CalculateKey(int32 index) const
+{
+	const auto cost = FMath::Min(CostSoFar[index], Lookahead[index]);
+	return { AddCost(cost, Costs.GetHeuristic(index, End)), cost };
+}
+
+void FHexIncrementalPathfinder::UpdateVertex(int32 index)
+{
+	if (index == StartIndex) {
+		Lookahead[index] = Blocked[index] ? INFINITE_COST : 0;
+	}
+	else {
+		// Steps cost whatever the tile stepped onto costs, so the cheapest way in is through the cheapest neighbor
+		auto cheapestNeighbor = INFINITE_COST;
+		ForEachHexNeighborInBounds<FMapHexLayout>(ToTile(index), Dimensions, [this, &cheapestNeighbor](const FCoordinate2D& neighbor) {
+			cheapestNeighbor = FMath::Min(cheapestNeighbor, CostSoFar[ToIndex(neighbor)]);
+		});
+		Lookahead[index] = AddCost(cheapestNeighbor, GetCost(index));
+	}
+
+	if (CostSoFar[index] != Lookahead[index]) {
+		HeapPushOrUpdate(index);
+	}
+	else {
+		HeapRemove(index);
+	}
+}
+
+void FHexIncrementalPathfinder::ComputeShortestPath()
+{
+	auto keyLess = [](const FKey& lhs, const FKey& rhs) {
+		return lhs.Primary != rhs.Primary ? lhs.Primary < rhs.Primary : lhs.Secondary < rhs.Secondary;
+	};
+
+	// Ties with the end's key are expanded too: stepping onto the end is free, so its neighbors can share its key,
+	// and walking the path back needs them settled
+	while (!Heap.IsEmpty() && (!keyLess(CalculateKey(EndIndex), Keys[Heap[0]]) || Lookahead[EndIndex] != CostSoFar[EndIndex])) {
+		const auto current = HeapPop();
+		NodesExpanded++;
+
+		if (CostSoFar[current] > Lookahead[current]) {
+			// Got cheaper, settle it
+			CostSoFar[current] = Lookahead[current];
+		}
+		else {
+			// Got more expensive, forget it and let its neighbors find it a new way in
+			CostSoFar[current] = INFINITE_COST;
+			UpdateVertex(current);
+		}
+
+		ForEachHexNeighborInBounds<FMapHexLayout>(ToTile(current), Dimensions, [this](const FCoordinate2D& neighbor) {
+			UpdateVertex(ToIndex(neighbor));
+		});
+	}
+}
+
+void FHexIncrementalPathfinder::ExtractPath(TArray<FCoordinate2D>& outPath) const
+{
+	outPath.Reset();
+	if (StartIndex == INDEX_NONE || CostSoFar[EndIndex] == INFINITE_COST) {
+		return;
+	}
+
+	// Walk back from the end, always to the neighbor it was cheapest to come from. Ties go to the lower index like FHexPathfinder
+	const auto tileCount = Dimensions * Dimensions;
+	auto current = EndIndex;
+	while (current != StartIndex) {
+		outPath.Emplace(ToTile(current));
+
+		auto previous = INDEX_NONE;
+		ForEachHexNeighborInBounds<FMapHexLayout>(ToTile(current), Dimensions, [this, &previous](const FCoordinate2D& neighbor) {
+			const auto neighborIndex = ToIndex(neighbor);
+			if (Blocked[neighborIndex] || CostSoFar[neighborIndex] == INFINITE_COST) {
+				return;
+			}
+			if (previous == INDEX_NONE || CostSoFar[neighborIndex] < CostSoFar[previous]
+				|| (CostSoFar[neighborIndex] == CostSoFar[previous] && neighborIndex < previous)) {
+				previous = neighborIndex;
+			}
+		});
+
+		if (previous == INDEX_NONE || outPath.Num() >= tileCount) {
+			outPath.Reset();
+			return;
+		}
+		current = previous;
+	}
+	outPath.Emplace(Start);
+}
+
+bool FHexIncrementalPathfinder::HeapLess(int32 lhs, int32 rhs) const
+{
+	auto& lhsKey = Keys[lhs];
+	auto& rhsKey = Keys[rhs];
+	if (lhsKey.Primary != rhsKey.Primary) {
+		return lhsKey.Primary < rhsKey.Primary;
+	}
+	if (lhsKey.Secondary != rhsKey.Secondary) {
+		return lhsKey.Secondary < rhsKey.Secondary;
+	}
+	return lhs < rhs;
+}
+
+void FHexIncrementalPathfinder::HeapPushOrUpdate(int32 index)
+{
+	Keys[index] = CalculateKey(index);
+
+	auto slot = HeapSlot[index];
+	if (slot == INDEX_NONE) {
+		slot = Heap.Add(index);
+		HeapSlot[index] = slot;
+		HeapSiftUp(slot);
+		return;
+	}
+
+	// Unlike FHexPathfinder, keys can go up as well as down
+	HeapSiftUp(slot);
+	HeapSiftDown(HeapSlot[index]);
+}
+
+void FHexIncrementalPathfinder::HeapRemove(int32 index)
+{
+	const auto slot = HeapSlot[index];
+	if (slot == INDEX_NONE) {
+		return;
+	}
+
+	const auto last = Heap.Pop(false);
+	HeapSlot[index] = INDEX_NONE;
+	if (last != index) {
+		Heap[slot] = last;
+		HeapSlot[last] = slot;
+		HeapSiftUp(slot);
+		HeapSiftDown(HeapSlot[last]);
+	}
+}
+
+int32 FHexIncrementalPathfinder::HeapPop()
+{
+	const auto top = Heap[0];
+	HeapRemove(top);
+	return top;
+}
+
+void FHexIncrementalPathfinder::HeapSiftUp(int32 slot)
+{
+	const auto index = Heap[slot];
+	while (slot > 0) {
+		const auto parent = (slot - 1) / 2;
+		if (!HeapLess(index, Heap[parent])) {
+			break;
+		}
+		Heap[slot] = Heap[parent];
+		HeapSlot[Heap[slot]] = slot;
+		slot = parent;
+	}
+	Heap[slot] = index;
+	HeapSlot[index] = slot;
+}
+
+void FHexIncrementalPathfinder::HeapSiftDown(int32 slot)
+{
+	const auto index = Heap[slot];
+	const auto count = Heap.Num();
+	while (true) {
+		auto child = slot * 2 + 1;
+		if (child >= count) {
+			break;
+		}
+		if (child + 1 < count && HeapLess(Heap[child + 1], Heap[child])) {
+			child++;
+		}
+		if (!HeapLess(Heap[child], index)) {
+			break;
+		}
+		Heap[slot] = Heap[child];
+		HeapSlot[Heap[slot]] = slot;
+		slot = child;
+	}
+	Heap[slot] = index;
+	HeapSlot[index] = slot;
+}
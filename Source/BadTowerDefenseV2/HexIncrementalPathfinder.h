@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "ChunkRandom.h"
+#include "HexPathfinder.h"
+
+#include "CoreMinimal.h"
+
+/**
+ * Lifelong Planning A* (LPA*) over a single chunk, for keeping a chunk's road up to date while towers block and
+ * unblock its tiles.
+ *
+ * Tile costs come from an FHexPathfinder initialized exactly like chunk generation does, so with nothing blocked
+ * the path costs the same as the road the chunk was generated with. It's usually that road too, but where several
+ * roads tie on cost (e.g. along the border) it can be another one. Blocked tiles can't be entered at all. The search state
+ * (cost so far, one-step lookahead, frontier) is kept between updates, so blocking or unblocking a tile only
+ * re-expands the tiles whose cost actually changed instead of searching the whole chunk again.
+ *
+ * Costs belong to the tiles rather than the steps between them, so a tile changing only touches that tile's
+ * lookahead before the search repairs the rest.
+ */
+class BADTOWERDEFENSEV2_API FHexIncrementalPathfinder
+{
+public:
+	/** Same weights as URandomWalkLibrary::GenerateChunkPath uses for this chunk. Clears every blocked tile */
+	void Initialize(const FChunkRandom& random, int32 dimensions, const FCoordinate2D& start, const FCoordinate2D& end);
+
+	/** Returns false if nothing changed. The path is only repaired by the next UpdatePath */
+	bool SetTileBlocked(const FCoordinate2D& tile, bool bBlocked);
+
+	bool IsTileBlocked(const FCoordinate2D& tile) const;
+
+	/** Repairs the path after tiles were blocked or unblocked. Returns true if the path changed */
+	bool UpdatePath();
+
+	/** False if the blocked tiles cut start off from end. As of the last UpdatePath */
+	bool HasPath() const { return !Path.IsEmpty(); }
+
+	/** From end back to start (both inclusive), same order as FHexPathfinder::FindPath. As of the last UpdatePath */
+	const TArray<FCoordinate2D>& GetPath() const { return Path; }
+
+	bool IsOnPath(const FCoordinate2D& tile) const;
+
+	/** What walking path (from end back to start) costs with the current blocked tiles. INDEX_NONE if it crosses one */
+	int64 GetPathCost(const TArray<FCoordinate2D>& path) const;
+
+	/**
+	 * Would blocking tile leave no way from start to end? Cheap enough to call every frame: tiles off the current
+	 * path can't cut it, and for default sized chunks the rest is a bitboard flood fill.
+	 */
+	bool WouldDisconnect(const FCoordinate2D& tile) const;
+
+	/** Number of tiles expanded by the last UpdatePath */
+	int32 GetNodesExpanded() const { return NodesExpanded; }
+
+	const FCoordinate2D& GetStart() const { return Start; }
+	const FCoordinate2D& GetEnd() const { return End; }
+
+private:
+	struct FKey {
+		int64 Primary;
+		int64 Secondary;
+	};
+
+	bool IsInBounds(const FCoordinate2D& tile) const;
+	int32 ToIndex(const FCoordinate2D& tile) const { return tile.X * Dimensions + tile.Y; }
+	FCoordinate2D ToTile(int32 index) const { return FCoordinate2D(index / Dimensions, index % Dimensions); }
+
+	int64 GetCost(int32 index) const;
+	FKey CalculateKey(int32 index) const;
+	void UpdateVertex(int32 index);
+	void ComputeShortestPath();
+	void ExtractPath(TArray<FCoordinate2D>& outPath) const;
+	bool IsReachableWithout(int32 index) const;
+
+	bool HeapLess(int32 lhs, int32 rhs) const;
+	void HeapPushOrUpdate(int32 index);
+	void HeapRemove(int32 index);
+	int32 HeapPop();
+	void HeapSiftUp(int32 slot);
+	void HeapSiftDown(int32 slot);
+
+	FHexPathfinder Costs;
+
+	int32 Dimensions = 0;
+	FCoordinate2D Start;
+	FCoordinate2D End;
+	int32 StartIndex = INDEX_NONE;
+	int32 EndIndex = INDEX_NONE;
+
+	bool bDirty = false;
+	int32 NodesExpanded = 0;
+
+	// Per tile, indexed like UMapUtilitiesLibrary::ConvertCoordinatesToIndex
+	TArray<bool> Blocked;
+	TArray<bool> OnPath;
+	TArray<int64> CostSoFar;
+	// One-step lookahead: the cheapest cost so far of any neighbor plus the cost of entering the tile
+	TArray<int64> Lookahead;
+	TArray<FKey> Keys;
+	TArray<int32> HeapSlot;
+	TArray<int32> Heap;
+
+	// Same as Blocked, for default sized chunks (FHexChunkBitboard)
+	uint64 BlockedBits = 0;
+
+	TArray<FCoordinate2D> Path;
+
+	// Flood fill scratch for chunks that don't fit a bitboard
+	mutable TArray<int32> FloodQueue;
+	mutable TArray<bool> FloodReached;
+};
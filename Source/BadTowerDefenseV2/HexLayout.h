@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+
+#include "CoreMinimal.h"
+
+struct FHexOffset {
+	int8 X;
+	int8 Y;
+};
+
+/**
+ * Hex offset layouts as compile-time policies. Each layout has one neighbor table per parity of the
+ * axis its rows/columns are shifted along, and ParityOf picks the table for a tile.
+ *
+ * Iterate with ForEachHexNeighbor / GetHexNeighborTiles below; neither allocates.
+ */
+
+// Layout of the generated map (URandomWalkLibrary::GetAllNeighbors): rows run along Y and Y parity picks the table
+struct FMapHexLayout {
+	static constexpr int32 ParityOf(const FCoordinate2D& tile) { return tile.Y & 1; }
+
+	static constexpr FHexOffset Offsets[2][6] = {
+		{ {-1, 0}, {-1, -1}, {0, -1}, {1, 0}, {0, 1}, {-1, 1} },
+		{ {-1, 0}, {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1} },
+	};
+};
+
+struct FOddRHexLayout {
+	static constexpr int32 ParityOf(const FCoordinate2D& tile) { return tile.X & 1; }
+
+	static constexpr FHexOffset Offsets[2][6] = {
+		{ {1, 0}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}, {0, 1} },
+		{ {1, 0}, {1, -1}, {0, -1}, {-1, 0}, {0, 1}, {1, 1} },
+	};
+};
+
+struct FEvenRHexLayout {
+	static constexpr int32 ParityOf(const FCoordinate2D& tile) { return tile.X & 1; }
+
+	static constexpr FHexOffset Offsets[2][6] = {
+		{ {1, 0}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}, {0, 1} },
+		{ {1, 0}, {1, -1}, {0, -1}, {-1, 0}, {0, 1}, {1, 1} },
+	};
+};
+
+struct FOddQHexLayout {
+	static constexpr int32 ParityOf(const FCoordinate2D& tile) { return tile.X & 1; }
+
+	static constexpr FHexOffset Offsets[2][6] = {
+		{ {1, 1}, {1, 0}, {0, -1}, {-1, 0}, {-1, 1}, {0, 1} },
+		{ {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {0, 1} },
+	};
+};
+
+struct FEvenQHexLayout {
+	static constexpr int32 ParityOf(const FCoordinate2D& tile) { return tile.X & 1; }
+
+	static constexpr FHexOffset Offsets[2][6] = {
+		{ {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {0, 1} },
+		{ {1, 1}, {1, 0}, {0, -1}, {-1, 0}, {-1, 1}, {0, 1} },
+	};
+};
+
+// Axial layout (the same six offsets for every tile), used by URandomWalkLibrary::GetHexNeighbors
+struct FAxialHexLayout {
+	static constexpr int32 ParityOf(const FCoordinate2D&) { return 0; }
+
+	static constexpr FHexOffset Offsets[2][6] = {
+		{ {-1, 0}, {-1, -1}, {1, 0}, {1, 1}, {0, -1}, {0, 1} },
+		{ {-1, 0}, {-1, -1}, {1, 0}, {1, 1}, {0, -1}, {0, 1} },
+	};
+};
+
+/** The six neighbors of a tile, stored inline */
+struct FHexNeighbors {
+	static constexpr int32 Num = 6;
+
+	FCoordinate2D Tiles[Num];
+
+	const FCoordinate2D* begin() const { return Tiles; }
+	const FCoordinate2D* end() const { return Tiles + Num; }
+	const FCoordinate2D& operator[](int32 index) const { return Tiles[index]; }
+};
+
+template<typename LayoutType, typename VisitorType>
+FORCEINLINE void ForEachHexNeighbor(const FCoordinate2D& tile, VisitorType&& visitor)
+{
+	const auto& offsets = LayoutType::Offsets[LayoutType::ParityOf(tile)];
+	for (auto& offset : offsets) {
+		visitor(FCoordinate2D(tile.X + offset.X, tile.Y + offset.Y));
+	}
+}
+
+/** Same as ForEachHexNeighbor, skipping neighbors outside of a dimensions x dimensions chunk */
+template<typename LayoutType, typename VisitorType>
+FORCEINLINE void ForEachHexNeighborInBounds(const FCoordinate2D& tile, int32 dimensions, VisitorType&& visitor)
+{
+	ForEachHexNeighbor<LayoutType>(tile, [&](const FCoordinate2D& neighbor) {
+		if (neighbor.X >= 0 && neighbor.Y >= 0 && neighbor.X < dimensions && neighbor.Y < dimensions) {
+			visitor(neighbor);
+		}
+	});
+}
+
+template<typename LayoutType>
+FORCEINLINE FHexNeighbors GetHexNeighborTiles(const FCoordinate2D& tile)
+{
+	FHexNeighbors result;
+	auto count = 0;
+	ForEachHexNeighbor<LayoutType>(tile, [&](const FCoordinate2D& neighbor) {
+		result.Tiles[count++] = neighbor;
+	});
+	return result;
+}
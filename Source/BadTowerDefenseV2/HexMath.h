@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+
+#include "CoreMinimal.h"
+
+/**
+ * Cube and axial hex coordinates for the map's layout (FMapHexLayout: rows run along Y, odd rows are shifted
+ * half a tile towards +X). Axial q = X - floor(Y / 2), r = Y, and cube adds s = -q - r.
+ *
+ * Distance, range, ring and line functions work in axial space and hand back global FCoordinate2D tiles.
+ * Ranges and rings up to HEX_MATH_TABLE_RADIUS come straight out of a spiral table built at compile time.
+ */
+
+// Largest radius the spiral table covers. Anything bigger is still supported, just generated on the fly
+#ifndef HEX_MATH_TABLE_RADIUS
+#define HEX_MATH_TABLE_RADIUS 8
+#endif
+
+struct FHexAxial {
+	int32 Q = 0;
+	int32 R = 0;
+
+	constexpr int32 GetS() const { return -Q - R; }
+
+	friend constexpr bool operator==(const FHexAxial& lhs, const FHexAxial& rhs) {
+		return lhs.Q == rhs.Q && lhs.R == rhs.R;
+	}
+};
+
+struct FHexCube {
+	int32 Q = 0;
+	int32 R = 0;
+	int32 S = 0;
+
+	friend constexpr bool operator==(const FHexCube& lhs, const FHexCube& rhs) {
+		return lhs.Q == rhs.Q && lhs.R == rhs.R && lhs.S == rhs.S;
+	}
+};
+
+struct FHexAxialOffset {
+	int8 Q;
+	int8 R;
+};
+
+namespace HexMath
+{
+	// Axial directions, counter-clockwise starting at +X. Same neighbors as FMapHexLayout, in a different order
+	inline constexpr FHexAxialOffset Directions[6] = {
+		{ 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, 0 }, { -1, 1 }, { 0, 1 },
+	};
+
+	constexpr FHexAxial ToAxial(const FCoordinate2D& tile) {
+		return FHexAxial{ tile.X - (tile.Y >> 1), tile.Y };
+	}
+
+	inline FCoordinate2D FromAxial(const FHexAxial& axial) {
+		return FCoordinate2D(axial.Q + (axial.R >> 1), axial.R);
+	}
+
+	constexpr FHexCube ToCube(const FHexAxial& axial) {
+		return FHexCube{ axial.Q, axial.R, axial.GetS() };
+	}
+
+	constexpr FHexAxial ToAxial(const FHexCube& cube) {
+		return FHexAxial{ cube.Q, cube.R };
+	}
+
+	constexpr FHexCube ToCube(const FCoordinate2D& tile) {
+		return ToCube(ToAxial(tile));
+	}
+
+	inline FCoordinate2D FromCube(const FHexCube& cube) {
+		return FromAxial(ToAxial(cube));
+	}
+
+	constexpr int32 GetDistance(const FHexAxial& a, const FHexAxial& b) {
+		const auto dq = a.Q - b.Q;
+		const auto dr = a.R - b.R;
+		const auto ds = dq + dr;
+		return ((dq < 0 ? -dq : dq) + (dr < 0 ? -dr : dr) + (ds < 0 ? -ds : ds)) / 2;
+	}
+
+	/** Number of tiles within radius of a tile, the tile itself included */
+	constexpr int32 GetNumTilesInRange(int32 radius) {
+		return radius < 0 ? 0 : 1 + 3 * radius * (radius + 1);
+	}
+
+	/** Number of tiles exactly radius steps away from a tile */
+	constexpr int32 GetNumTilesInRing(int32 radius) {
+		return radius < 0 ? 0 : (radius == 0 ? 1 : 6 * radius);
+	}
+
+	/** The hex nearest to fractional axial coordinates, rounded in cube space */
+	inline FHexAxial RoundAxial(double q, double r) {
+		const auto s = -q - r;
+
+		auto roundedQ = FMath::RoundToDouble(q);
+		auto roundedR = FMath::RoundToDouble(r);
+		const auto roundedS = FMath::RoundToDouble(s);
+
+		// The component that was rounded the most is the one that's off, so rebuild it from the other two
+		const auto errorQ = FMath::Abs(roundedQ - q);
+		const auto errorR = FMath::Abs(roundedR - r);
+		const auto errorS = FMath::Abs(roundedS - s);
+		if (errorQ > errorR && errorQ > errorS) {
+			roundedQ = -roundedR - roundedS;
+		}
+		else if (errorR > errorS) {
+			roundedR = -roundedQ - roundedS;
+		}
+
+		return FHexAxial{ static_cast<int32>(roundedQ), static_cast<int32>(roundedR) };
+	}
+
+	/**
+	 * Axial offsets of every tile within MaxRadius of the origin, ordered as a spiral: the origin, then ring 1,
+	 * ring 2 and so on. Ring k starts at GetRingStart(k) and has GetNumTilesInRing(k) entries, each ring going
+	 * counter-clockwise from its -X/+Y corner.
+	 */
+	template<int32 MaxRadius>
+	struct TSpiralTable {
+		static_assert(MaxRadius >= 0 && MaxRadius <= 127, "Offsets are stored as int8");
+
+		static constexpr int32 Num = GetNumTilesInRange(MaxRadius);
+
+		FHexAxialOffset Offsets[Num] = {};
+
+		static constexpr int32 GetRingStart(int32 radius) {
+			return GetNumTilesInRange(radius - 1);
+		}
+
+		constexpr TSpiralTable() {
+			auto count = 1;
+			for (int32 radius = 1; radius <= MaxRadius; radius++) {
+				// Start radius steps towards direction 4, then walk radius steps along each direction
+				int32 q = Directions[4].Q * radius;
+				int32 r = Directions[4].R * radius;
+				for (auto& direction : Directions) {
+					for (int32 step = 0; step < radius; step++) {
+						Offsets[count++] = FHexAxialOffset{ static_cast<int8>(q), static_cast<int8>(r) };
+						q += direction.Q;
+						r += direction.R;
+					}
+				}
+			}
+		}
+	};
+
+	inline constexpr TSpiralTable<HEX_MATH_TABLE_RADIUS> SpiralTable;
+
+	/** Calls visitor with every tile exactly radius steps from center */
+	template<typename VisitorType>
+	void ForEachTileInRing(const FCoordinate2D& center, int32 radius, VisitorType&& visitor)
+	{
+		if (radius < 0) {
+			return;
+		}
+
+		const auto origin = ToAxial(center);
+		if (radius <= HEX_MATH_TABLE_RADIUS) {
+			const auto first = SpiralTable.GetRingStart(radius);
+			const auto last = first + GetNumTilesInRing(radius);
+			for (int32 i = first; i < last; i++) {
+				const auto& offset = SpiralTable.Offsets[i];
+				visitor(FromAxial(FHexAxial{ origin.Q + offset.Q, origin.R + offset.R }));
+			}
+			return;
+		}
+
+		auto tile = FHexAxial{ origin.Q + Directions[4].Q * radius, origin.R + Directions[4].R * radius };
+		for (auto& direction : Directions) {
+			for (int32 step = 0; step < radius; step++) {
+				visitor(FromAxial(tile));
+				tile.Q += direction.Q;
+				tile.R += direction.R;
+			}
+		}
+	}
+
+	/** Calls visitor with every tile within radius steps of center, nearest rings first */
+	template<typename VisitorType>
+	void ForEachTileInRange(const FCoordinate2D& center, int32 radius, VisitorType&& visitor)
+	{
+		if (radius < 0) {
+			return;
+		}
+
+		const auto origin = ToAxial(center);
+		const auto tableCount = GetNumTilesInRange(FMath::Min(radius, HEX_MATH_TABLE_RADIUS));
+		for (int32 i = 0; i < tableCount; i++) {
+			const auto& offset = SpiralTable.Offsets[i];
+			visitor(FromAxial(FHexAxial{ origin.Q + offset.Q, origin.R + offset.R }));
+		}
+
+		for (int32 ring = HEX_MATH_TABLE_RADIUS + 1; ring <= radius; ring++) {
+			ForEachTileInRing(center, ring, visitor);
+		}
+	}
+
+	/**
+	 * Calls visitor with each tile on the straight line from start to end, both included, GetDistance + 1 tiles
+	 * in all. Points exactly between two hexes are nudged the same way every time so lines are stable.
+	 */
+	template<typename VisitorType>
+	void ForEachTileOnLine(const FCoordinate2D& start, const FCoordinate2D& end, VisitorType&& visitor)
+	{
+		const auto from = ToAxial(start);
+		const auto to = ToAxial(end);
+		const auto distance = GetDistance(from, to);
+		if (distance == 0) {
+			visitor(start);
+			return;
+		}
+
+		constexpr double NUDGE_Q = 1e-6;
+		constexpr double NUDGE_R = 2e-6;
+		const auto startQ = from.Q + NUDGE_Q;
+		const auto startR = from.R + NUDGE_R;
+		const auto stepQ = (to.Q - from.Q) / static_cast<double>(distance);
+		const auto stepR = (to.R - from.R) / static_cast<double>(distance);
+
+		for (int32 i = 0; i <= distance; i++) {
+			visitor(FromAxial(RoundAxial(startQ + stepQ * i, startR + stepR * i)));
+		}
+	}
+}
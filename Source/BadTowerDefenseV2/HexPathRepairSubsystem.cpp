@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HexPathRepairSubsystem.h"
+#include "HexFlowFieldSubsystem.h"
+#include "MapUtilitiesLibrary.h"
+#include "ChunkRandom.h"
+
+#include "Engine/World.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("PathRepair"), STATGROUP_PathRepair, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Repair Path"), STAT_PathRepair_Repair, STATGROUP_PathRepair);
+DECLARE_CYCLE_STAT(TEXT("Would Disconnect"), STAT_PathRepair_WouldDisconnect, STATGROUP_PathRepair);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Tiles Expanded"), STAT_PathRepair_NodesExpanded, STATGROUP_PathRepair);
+
+void UHexPathRepairSubsystem::Deinitialize()
+{
+	Chunks.Empty();
+	Super::Deinitialize();
+}
+
+bool UHexPathRepairSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UHexPathRepairSubsystem::AddChunk(const FChunkPath& chunk, int32 seed, int32 dimensions)
+{
+	Dimensions = dimensions;
+
+	auto& tracked = Chunks.FindOrAdd(chunk.ChunkCoordinate);
+	tracked.Chunk = chunk;
+	tracked.Pathfinder.Initialize(FChunkRandom(seed, chunk.ChunkCoordinate, EChunkRandomPurpose::Path), dimensions, chunk.Entry, chunk.Exit);
+
+	// Nothing is blocked yet, so this costs the same as the generated road and usually is it. Searching now means the
+	// first tower only repairs
+	auto& pathfinder = tracked.Pathfinder;
+	pathfinder.UpdatePath();
+	if (pathfinder.GetPathCost(pathfinder.GetPath()) != pathfinder.GetPathCost(chunk.Path)) {
+		UE_LOG(LogTemp, Warning, TEXT("Chunk (%d, %d) wasn't generated with seed %d, its road won't be repaired like it was generated"), chunk.ChunkCoordinate.X, chunk.ChunkCoordinate.Y, seed);
+	}
+}
+
+void UHexPathRepairSubsystem::RemoveChunk(const FCoordinate2D& chunkCoordinate)
+{
+	Chunks.Remove(chunkCoordinate);
+}
+
+bool UHexPathRepairSubsystem::SetTileBlocked(const FCoordinate2D& tile, bool bBlocked)
+{
+	auto tracked = Chunks.Find(UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(tile, Dimensions));
+	if (!tracked) {
+		return true;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_PathRepair_Repair);
+
+	auto& pathfinder = tracked->Pathfinder;
+	const auto localTile = UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkLocalCoordinate(tile, Dimensions);
+	if (!pathfinder.SetTileBlocked(localTile, bBlocked)) {
+		return pathfinder.HasPath();
+	}
+
+	const auto bChanged = pathfinder.UpdatePath();
+	LastNodesExpanded = pathfinder.GetNodesExpanded();
+	INC_DWORD_STAT_BY(STAT_PathRepair_NodesExpanded, LastNodesExpanded);
+
+	// After a cost tie the planner can be holding another road than the one in use, and blocking the one in use
+	// doesn't change the planner's
+	const auto bRoadBlocked = bBlocked && tracked->Chunk.Path.Contains(localTile);
+	if (bChanged || bRoadBlocked) {
+		const auto oldChunk = tracked->Chunk;
+		tracked->Chunk.Path = pathfinder.GetPath();
+
+		if (bUpdateFlowField) {
+			if (auto flowField = GetWorld()->GetSubsystem<UHexFlowFieldSubsystem>()) {
+				flowField->RemoveChunkPath(oldChunk, Dimensions);
+				flowField->AddChunkPath(tracked->Chunk, Dimensions);
+			}
+		}
+
+		// Copy, a listener could add or remove chunks
+		const auto newChunk = tracked->Chunk;
+		OnChunkPathRepaired.Broadcast(oldChunk, newChunk);
+	}
+
+	return pathfinder.HasPath();
+}
+
+bool UHexPathRepairSubsystem::WouldDisconnect(const FCoordinate2D& tile) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathRepair_WouldDisconnect);
+
+	auto tracked = Chunks.Find(UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(tile, Dimensions));
+	return tracked && tracked->Pathfinder.WouldDisconnect(UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkLocalCoordinate(tile, Dimensions));
+}
+
+bool UHexPathRepairSubsystem::GetChunkPath(const FCoordinate2D& chunkCoordinate, FChunkPath& outChunk) const
+{
+	auto tracked = Chunks.Find(chunkCoordinate);
+	if (!tracked) {
+		return false;
+	}
+
+	outChunk = tracked->Chunk;
+	return true;
+}
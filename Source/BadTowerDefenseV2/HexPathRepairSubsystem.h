@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "FChunkPath.h"
+#include "HexIncrementalPathfinder.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HexPathRepairSubsystem.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnChunkPathRepaired, const FChunkPath&, OldChunk, const FChunkPath&, NewChunk);
+
+/**
+ * Keeps the road through every loaded chunk routed around towers. Each chunk keeps its own incremental search
+ * (FHexIncrementalPathfinder), so placing or removing a tower only repairs the part of that chunk's road it
+ * affected instead of generating the chunk's path again.
+ *
+ * Towers can only ever cut the road inside their own chunk, since chunks meet at fixed entry and exit tiles, which
+ * makes WouldDisconnect a single-chunk check that's cheap enough for the placement preview to call every frame.
+ */
+UCLASS()
+class BADTOWERDEFENSEV2_API UHexPathRepairSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/** Starts tracking a chunk's road. seed and dimensions have to be the ones the chunk was generated with */
+	UFUNCTION(BlueprintCallable, Category = "Path Repair")
+	void AddChunk(const FChunkPath& chunk, int32 seed, int32 dimensions = 8);
+
+	/** Stops tracking a chunk, e.g. when it streams out. Its blocked tiles are forgotten */
+	UFUNCTION(BlueprintCallable, Category = "Path Repair")
+	void RemoveChunk(const FCoordinate2D& chunkCoordinate);
+
+	/**
+	 * Global tile. Repairs the road through the tile's chunk right away and broadcasts OnChunkPathRepaired if it moved.
+	 * Returns false if the chunk is left without a road.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Path Repair")
+	bool SetTileBlocked(const FCoordinate2D& tile, bool bBlocked);
+
+	/** Would a tower on this global tile cut the spawn off from the headquarters? */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Path Repair")
+	bool WouldDisconnect(const FCoordinate2D& tile) const;
+
+	/** The chunk's road as currently repaired */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Path Repair")
+	bool GetChunkPath(const FCoordinate2D& chunkCoordinate, FChunkPath& outChunk) const;
+
+	/** Number of tiles the last repair expanded, to compare against a full search of the chunk */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Path Repair")
+	int32 GetLastNodesExpanded() const { return LastNodesExpanded; }
+
+	UPROPERTY(BlueprintAssignable, Category = "Path Repair")
+	FOnChunkPathRepaired OnChunkPathRepaired;
+
+	// Swap repaired roads into UHexFlowFieldSubsystem's walkable tiles
+	UPROPERTY(BlueprintReadWrite, Category = "Path Repair")
+	bool bUpdateFlowField = true;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FTrackedChunk {
+		FChunkPath Chunk;
+		FHexIncrementalPathfinder Pathfinder;
+	};
+
+	TMap<FCoordinate2D, FTrackedChunk> Chunks;
+	// Every tracked chunk has the same size, set by AddChunk
+	int32 Dimensions = 8;
+	int32 LastNodesExpanded = 0;
+};
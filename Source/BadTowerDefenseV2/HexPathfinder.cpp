@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HexPathfinder.h"
+#include "HexChunkBitboard.h"
+#include "HexLayout.h"
+
+// We want to make this high, but not so high that our absolute limit becomes a viable path
+constexpr int32 BORDER_INFINITY = TNumericLimits<int32>::Max() / 2;
+constexpr int32 MAX_WEIGHT = BORDER_INFINITY / 10;
+
+void FHexPathfinder::Initialize(const FRandomStream& stream, int32 dimensions)
+{
+	Dimensions = FMath::Max(dimensions, 0);
+	const auto tileCount = Dimensions * Dimensions;
+
+	Weights.SetNumUninitialized(tileCount, false);
+	MinWeight = MAX_WEIGHT;
+	for (int32 i = 0; i < tileCount; i++) {
+		Weights[i] = stream.RandRange(0, MAX_WEIGHT);
+		MinWeight = FMath::Min<int64>(MinWeight, Weights[i]);
+	}
+}
+
+void FHexPathfinder::Initialize(const FChunkRandom& random, int32 dimensions)
+{
+	Dimensions = FMath::Max(dimensions, 0);
+	const auto tileCount = Dimensions * Dimensions;
+
+	Weights.SetNumUninitialized(tileCount, false);
+	MinWeight = MAX_WEIGHT;
+	for (int32 i = 0; i < tileCount; i++) {
+		Weights[i] = random.RandRange(i, 0, MAX_WEIGHT);
+		MinWeight = FMath::Min<int64>(MinWeight, Weights[i]);
+	}
+}
+
+int64 FHexPathfinder::GetEnterCost(int32 index, int32 endIndex) const
+{
+	if (index == endIndex) {
+		return 0;
+	}
+
+	if (Dimensions == FHexChunkBitboard::Dimensions) {
+		// Default chunk size, the tile index is the bit index
+		if (FHexChunkBitboard::Border & (1ull << index)) {
+			return BORDER_INFINITY;
+		}
+	}
+	else {
+		const auto x = index / Dimensions;
+		const auto y = index % Dimensions;
+		if (x == 0 || x == Dimensions - 1 || y == 0 || y == Dimensions - 1) {
+			return BORDER_INFINITY;
+		}
+	}
+
+	return Weights[index];
+}
+
+int64 FHexPathfinder::GetHeuristic(int32 index, const FCoordinate2D& end) const
+{
+	// Every step but the last one (into the end tile, which is free) costs at least MinWeight,
+	// so (hex distance - 1) * MinWeight never overestimates.
+	const auto distance = FCoordinate2D(index / Dimensions, index % Dimensions).GetHexDistance(end);
+
+	return distance > 0 ? (distance - 1) * MinWeight : 0;
+}
+
+bool FHexPathfinder::FindPath(const FCoordinate2D& start, const FCoordinate2D& end, TArray<FCoordinate2D>& outPath, bool bUseHeuristic)
+{
+	outPath.Reset();
+	NodesExpanded = 0;
+
+	auto inBounds = [this](const FCoordinate2D& tile) {
+		return tile.X >= 0 && tile.Y >= 0 && tile.X < Dimensions && tile.Y < Dimensions;
+	};
+
+	if (!inBounds(start) || !inBounds(end) || Weights.Num() != Dimensions * Dimensions) {
+		return false;
+	}
+
+	const auto tileCount = Dimensions * Dimensions;
+	// Never shrink, so reusing the pathfinder for chunks of the same size doesn't touch the heap
+	CostSoFar.SetNumUninitialized(tileCount, false);
+	Priority.SetNumUninitialized(tileCount, false);
+	CameFrom.SetNumUninitialized(tileCount, false);
+	HeapSlot.SetNumUninitialized(tileCount, false);
+	for (int32 i = 0; i < tileCount; i++) {
+		CostSoFar[i] = TNumericLimits<int64>::Max();
+		CameFrom[i] = INDEX_NONE;
+		HeapSlot[i] = INDEX_NONE;
+	}
+	Heap.Reset();
+
+	const auto startIndex = start.X * Dimensions + start.Y;
+	const auto endIndex = end.X * Dimensions + end.Y;
+
+	CostSoFar[startIndex] = 0;
+	Priority[startIndex] = bUseHeuristic ? GetHeuristic(startIndex, end) : 0;
+	CameFrom[startIndex] = startIndex;
+	HeapPushOrDecrease(startIndex);
+
+	while (!Heap.IsEmpty()) {
+		const auto current = HeapPop();
+		NodesExpanded++;
+
+		if (current == endIndex) {
+			break;
+		}
+
+		const auto tile = FCoordinate2D(current / Dimensions, current % Dimensions);
+		ForEachHexNeighborInBounds<FMapHexLayout>(tile, Dimensions, [&](const FCoordinate2D& neighbor) {
+			const auto neighborIndex = neighbor.X * Dimensions + neighbor.Y;
+			const auto newCost = CostSoFar[current] + GetEnterCost(neighborIndex, endIndex);
+			if (newCost < CostSoFar[neighborIndex]) {
+				CostSoFar[neighborIndex] = newCost;
+				Priority[neighborIndex] = newCost + (bUseHeuristic ? GetHeuristic(neighborIndex, end) : 0);
+				CameFrom[neighborIndex] = current;
+				HeapPushOrDecrease(neighborIndex);
+			}
+		});
+	}
+
+	if (CameFrom[endIndex] == INDEX_NONE) {
+		return false;
+	}
+
+	// Algorithm is complete... lets backtrack...
+	auto current = endIndex;
+	while (current != startIndex) {
+		outPath.Emplace(current / Dimensions, current % Dimensions);
+		current = CameFrom[current];
+	}
+	outPath.Emplace(start);
+
+	return true;
+}
+
+bool FHexPathfinder::HeapLess(int32 lhs, int32 rhs) const
+{
+	// Ties are broken on the tile index so the result never depends on heap layout
+	if (Priority[lhs] != Priority[rhs]) {
+		return Priority[lhs] < Priority[rhs];
+	}
+	return lhs < rhs;
+}
+
+void FHexPathfinder::HeapPushOrDecrease(int32 index)
+{
+	auto slot = HeapSlot[index];
+	if (slot == INDEX_NONE) {
+		slot = Heap.Add(index);
+		HeapSlot[index] = slot;
+	}
+
+	// Priorities only ever go down, so sifting up is enough
+	HeapSiftUp(slot);
+}
+
+int32 FHexPathfinder::HeapPop()
+{
+	const auto top = Heap[0];
+	const auto last = Heap.Pop(false);
+	HeapSlot[top] = INDEX_NONE;
+
+	if (!Heap.IsEmpty()) {
+		Heap[0] = last;
+		HeapSlot[last] = 0;
+		HeapSiftDown(0);
+	}
+
+	return top;
+}
+
+void FHexPathfinder::HeapSiftUp(int32 slot)
+{
+	const auto index = Heap[slot];
+	while (slot > 0) {
+		const auto parent = (slot - 1) / 2;
+		if (!HeapLess(index, Heap[parent])) {
+			break;
+		}
+		Heap[slot] = Heap[parent];
+		HeapSlot[Heap[slot]] = slot;
+		slot = parent;
+	}
+	Heap[slot] = index;
+	HeapSlot[index] = slot;
+}
+
+void FHexPathfinder::HeapSiftDown(int32 slot)
+{
+	const auto index = Heap[slot];
+	const auto count = Heap.Num();
+	while (true) {
+		auto child = slot * 2 + 1;
+		if (child >= count) {
+			break;
+		}
+		if (child + 1 < count && HeapLess(Heap[child + 1], Heap[child])) {
+			child++;
+		}
+		if (!HeapLess(Heap[child], index)) {
+			break;
+		}
+		Heap[slot] = Heap[child];
+		HeapSlot[Heap[slot]] = slot;
+		slot = child;
+	}
+	Heap[slot] = index;
+	HeapSlot[index] = slot;
+}
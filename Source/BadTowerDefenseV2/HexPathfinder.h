@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "ChunkRandom.h"
+
+#include "CoreMinimal.h"
+
+/**
+ * Dijkstra / A* search over a single square chunk of hex tiles.
+ *
+ * All per-tile state (random weight, cost so far, parent, heap slot) lives in flat arrays indexed by the
+ * chunk-local tile index, and the frontier is an indexed binary heap with decrease-key, so every tile is
+ * in the frontier at most once and no coordinate is ever hashed.
+ *
+ * An instance can be reused between chunks; the arrays keep their allocation.
+ */
+class BADTOWERDEFENSEV2_API FHexPathfinder
+{
+public:
+	/**
+	 * Rolls the random weight of every tile in the chunk. Always draws exactly dimensions * dimensions
+	 * values from the stream, in index order, so the same seed produces the same weights (and path).
+	 *
+	 * The old DijkstraRandomPath drew a fresh weight on every relaxation instead, so a seed doesn't produce
+	 * the same road it did before FHexPathfinder; maps generated from saved seeds change once.
+	 */
+	void Initialize(const FRandomStream& stream, int32 dimensions);
+
+	/** Same, but tile i always gets number i of random, no matter what was drawn from it before */
+	void Initialize(const FChunkRandom& random, int32 dimensions);
+
+	/**
+	 * Finds the cheapest path between two chunk-local tiles using the weights from Initialize.
+	 * The path is written from end back to start (both inclusive), matching DijkstraRandomPath.
+	 * Returns false if either tile is out of bounds or the end can't be reached.
+	 *
+	 * The heuristic is admissible, so both searches find a path of the same, minimal cost. They expand tiles
+	 * in a different order though, so when several paths tie on cost they can return different ones.
+	 */
+	bool FindPath(const FCoordinate2D& start, const FCoordinate2D& end, TArray<FCoordinate2D>& outPath, bool bUseHeuristic = true);
+
+	/** Number of tiles popped off the frontier by the last FindPath call */
+	int32 GetNodesExpanded() const { return NodesExpanded; }
+
+	/** Cost of stepping onto tile index on the way to endIndex: its weight, a huge one on the chunk border, free for the end itself */
+	int64 GetEnterCost(int32 index, int32 endIndex) const;
+
+	/** Lower bound on the cost from tile index to end, never overestimates */
+	int64 GetHeuristic(int32 index, const FCoordinate2D& end) const;
+
+	int32 GetDimensions() const { return Dimensions; }
+
+private:
+
+	bool HeapLess(int32 lhs, int32 rhs) const;
+	void HeapPushOrDecrease(int32 index);
+	int32 HeapPop();
+	void HeapSiftUp(int32 slot);
+	void HeapSiftDown(int32 slot);
+
+	int32 Dimensions = 0;
+	int64 MinWeight = 0;
+	int32 NodesExpanded = 0;
+
+	TArray<int32> Weights;
+	TArray<int64> CostSoFar;
+	TArray<int64> Priority;
+	TArray<int32> CameFrom;
+	TArray<int32> HeapSlot;
+	TArray<int32> Heap;
+};
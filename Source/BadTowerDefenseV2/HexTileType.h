@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HexTileType.generated.h"
+
+/** Same entries, in the same order, as the E_TileType Blueprint enum */
+UENUM(BlueprintType)
+enum class EHexTileType : uint8 {
+	Water,
+	Invalid,
+	Land,
+	Road,
+	Bridge,
+	MAX UMETA(Hidden)
+};
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MallocCountingProxy.h"
+
+// The counter open on this thread, if any
+static thread_local FScopedAllocationCounter* GActiveAllocationCounter = nullptr;
+
+static FMallocCountingProxy* GMallocCountingProxy = nullptr;
+
+FMallocCountingProxy::FMallocCountingProxy(FMalloc* inner)
+	: Inner(inner)
+{
+}
+
+void FMallocCountingProxy::Install()
+{
+	check(IsInGameThread());
+	if (GMallocCountingProxy) {
+		return;
+	}
+
+	// Leaked on purpose, other threads may hold on to it until the process exits
+	GMallocCountingProxy = new FMallocCountingProxy(GMalloc);
+	GMalloc = GMallocCountingProxy;
+}
+
+void FMallocCountingProxy::Count(SIZE_T size)
+{
+	if (auto counter = GActiveAllocationCounter) {
+		counter->Allocations++;
+		counter->BytesAllocated += size;
+	}
+}
+
+void* FMallocCountingProxy::Malloc(SIZE_T Count, uint32 Alignment)
+{
+	FMallocCountingProxy::Count(Count);
+	return Inner->Malloc(Count, Alignment);
+}
+
+void* FMallocCountingProxy::TryMalloc(SIZE_T Count, uint32 Alignment)
+{
+	FMallocCountingProxy::Count(Count);
+	return Inner->TryMalloc(Count, Alignment);
+}
+
+void* FMallocCountingProxy::Realloc(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	// Shrinking to zero is a free, not an allocation
+	if (Count > 0) {
+		FMallocCountingProxy::Count(Count);
+	}
+	return Inner->Realloc(Original, Count, Alignment);
+}
+
+void* FMallocCountingProxy::TryRealloc(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	if (Count > 0) {
+		FMallocCountingProxy::Count(Count);
+	}
+	return Inner->TryRealloc(Original, Count, Alignment);
+}
+
+void FMallocCountingProxy::Free(void* Original)
+{
+	Inner->Free(Original);
+}
+
+SIZE_T FMallocCountingProxy::QuantizeSize(SIZE_T Count, uint32 Alignment)
+{
+	return Inner->QuantizeSize(Count, Alignment);
+}
+
+bool FMallocCountingProxy::GetAllocationSize(void* Original, SIZE_T& SizeOut)
+{
+	return Inner->GetAllocationSize(Original, SizeOut);
+}
+
+void FMallocCountingProxy::Trim(bool bTrimThreadCaches)
+{
+	Inner->Trim(bTrimThreadCaches);
+}
+
+void FMallocCountingProxy::SetupTLSCachesOnCurrentThread()
+{
+	Inner->SetupTLSCachesOnCurrentThread();
+}
+
+void FMallocCountingProxy::ClearAndDisableTLSCachesOnCurrentThread()
+{
+	Inner->ClearAndDisableTLSCachesOnCurrentThread();
+}
+
+bool FMallocCountingProxy::IsInternallyThreadSafe() const
+{
+	return Inner->IsInternallyThreadSafe();
+}
+
+const TCHAR* FMallocCountingProxy::GetDescriptiveName()
+{
+	return TEXT("MallocCountingProxy");
+}
+
+FScopedAllocationCounter::FScopedAllocationCounter()
+{
+	FMallocCountingProxy::Install();
+
+	check(GActiveAllocationCounter == nullptr);
+	GActiveAllocationCounter = this;
+}
+
+FScopedAllocationCounter::~FScopedAllocationCounter()
+{
+	GActiveAllocationCounter = nullptr;
+}
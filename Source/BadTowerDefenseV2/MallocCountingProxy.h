@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/MemoryBase.h"
+
+/**
+ * Pass-through GMalloc proxy that counts the allocations of threads with an FScopedAllocationCounter open.
+ *
+ * Installed once, the first time a counter is opened, and never removed: a thread that read GMalloc just before
+ * or after the swap keeps calling an allocator that is still alive, and both sides forward to the same inner one,
+ * so memory can be freed across the swap in either direction. Threads that aren't counting only pay a TLS read.
+ *
+ * Only meant for tools, benchmarks and tests (e.g. the MapGenBenchmark commandlet), never for game code.
+ */
+class BADTOWERDEFENSEV2_API FMallocCountingProxy : public FMalloc
+{
+public:
+	/** Swaps GMalloc for the proxy if it isn't already. Call from the game thread */
+	static void Install();
+
+	// FMalloc interface
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+	virtual void* TryMalloc(SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+	virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+	virtual void Free(void* Original) override;
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override;
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override;
+	virtual void Trim(bool bTrimThreadCaches) override;
+	virtual void SetupTLSCachesOnCurrentThread() override;
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override;
+	virtual bool IsInternallyThreadSafe() const override;
+	virtual const TCHAR* GetDescriptiveName() override;
+
+private:
+	explicit FMallocCountingProxy(FMalloc* inner);
+
+	static void Count(SIZE_T size);
+
+	FMalloc* Inner;
+};
+
+/**
+ * Counts heap allocations made by the calling thread while it is alive. Other threads aren't counted, so run the
+ * code being measured on this thread (e.g. with EParallelForFlags::ForceSingleThread) for an exact count.
+ * Scopes must not nest on the same thread.
+ */
+class BADTOWERDEFENSEV2_API FScopedAllocationCounter
+{
+public:
+	FScopedAllocationCounter();
+	~FScopedAllocationCounter();
+
+	FScopedAllocationCounter(const FScopedAllocationCounter&) = delete;
+	FScopedAllocationCounter& operator=(const FScopedAllocationCounter&) = delete;
+
+	/** Number of Malloc/Realloc calls that returned new memory since the scope started */
+	uint64 GetAllocations() const { return Allocations; }
+	uint64 GetBytesAllocated() const { return BytesAllocated; }
+
+private:
+	friend class FMallocCountingProxy;
+
+	uint64 Allocations = 0;
+	uint64 BytesAllocated = 0;
+};
@@ -0,0 +1,324 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MapGenBenchmarkCommandlet.h"
+#include "RandomWalkLibrary.h"
+#include "MapUtilitiesLibrary.h"
+#include "MapGenStats.h"
+#include "MapGenContext.h"
+#include "CoordinateHashMap.h"
+#include "MallocCountingProxy.h"
+
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+// How many times the cheap per-tile utilities are called per sample, so a sample is long enough to time
+constexpr int32 UTILITY_CALLS_PER_SAMPLE = 100000;
+
+struct FBenchmarkSeries
+{
+	FString Name;
+	int32 MapSize = 0;
+	int32 Dimensions = 0;
+	int32 CallsPerSample = 1;
+
+	TArray<double> Microseconds;
+	uint64 Allocations = 0;
+	int64 Retries = 0;
+	// Checksum agreed with the reference implementation on every sample
+	bool bMatchesReference = true;
+	// Only allocations on the calling thread are counted, so series that fan out over worker threads don't report any
+	bool bCountAllocations = true;
+};
+
+static TArray<int32> ParseIntList(const FString& Params, const TCHAR* Key, const TArray<int32>& Default)
+{
+	FString value;
+	if (!FParse::Value(*Params, Key, value, false)) {
+		return Default;
+	}
+
+	TArray<FString> entries;
+	value.ParseIntoArray(entries, TEXT(","));
+
+	TArray<int32> result;
+	for (auto& entry : entries) {
+		result.Add(FCString::Atoi(*entry));
+	}
+	return result.IsEmpty() ? Default : result;
+}
+
+static double Percentile(TArray<double> samples, double percentile)
+{
+	if (samples.IsEmpty()) {
+		return 0.0;
+	}
+
+	samples.Sort();
+	auto index = FMath::CeilToInt32(percentile * samples.Num()) - 1;
+	return samples[FMath::Clamp(index, 0, samples.Num() - 1)];
+}
+
+/// <summary>
+/// Times one sample of a benchmark and records its allocations and walk retries into the series
+/// </summary>
+template<typename ResultType>
+static ResultType RunSample(FBenchmarkSeries& series, TFunctionRef<ResultType()> function)
+{
+	const auto retriesBefore = GMapGenCounters.WalkRetries.load();
+
+	ResultType result;
+	double seconds = 0.0;
+	if (series.bCountAllocations) {
+		FScopedAllocationCounter counter;
+		const auto start = FPlatformTime::Seconds();
+		result = function();
+		seconds = FPlatformTime::Seconds() - start;
+		series.Allocations += counter.GetAllocations();
+	}
+	else {
+		const auto start = FPlatformTime::Seconds();
+		result = function();
+		seconds = FPlatformTime::Seconds() - start;
+	}
+
+	series.Microseconds.Add(seconds * 1000000.0 / series.CallsPerSample);
+	series.Retries += GMapGenCounters.WalkRetries.load() - retriesBefore;
+	return result;
+}
+
+/// <summary>
+/// Fills a coordinate -> walk index map with the walk, then looks up every tile and its lattice neighbors the way the
+/// walk generators do. Same work for TMap and TCoordinateMap, so the two can be compared directly
+/// </summary>
+template<typename MapType>
+static int64 FillAndProbeCoordinateMap(const TArray<FCoordinate2D>& walk)
+{
+	MapType map;
+	map.Reserve(walk.Num());
+	for (int32 i = 0; i < walk.Num(); i++) {
+		map.Add(walk[i], i);
+	}
+
+	int64 checksum = 0;
+	for (auto& tile : walk) {
+		for (auto& neighbor : { FCoordinate2D(tile.X + 1, tile.Y), FCoordinate2D(tile.X - 1, tile.Y), FCoordinate2D(tile.X, tile.Y + 1), FCoordinate2D(tile.X, tile.Y - 1) }) {
+			if (auto index = map.Find(neighbor)) {
+				checksum += *index;
+			}
+		}
+	}
+	return checksum;
+}
+
+UMapGenBenchmarkCommandlet::UMapGenBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Benchmarks map generation and coordinate utilities");
+	HelpUsage = TEXT("-run=MapGenBenchmark [-MapSizes=16,64,256,1024] [-Dimensions=8,16] [-Seeds=20] [-MaxDimerizationSize=128] [-Output=<path.csv>]");
+}
+
+int32 UMapGenBenchmarkCommandlet::Main(const FString& Params)
+{
+	const auto mapSizes = ParseIntList(Params, TEXT("MapSizes="), { 16, 64, 256, 1024 });
+	const auto dimensionsList = ParseIntList(Params, TEXT("Dimensions="), { 8, 16 });
+
+	int32 seedCount = 20;
+	FParse::Value(*Params, TEXT("Seeds="), seedCount);
+	seedCount = FMath::Max(seedCount, 1);
+
+	// The dimerization walk's rejection loop blows up past a few hundred steps, so don't wait on it forever
+	int32 maxDimerizationSize = 128;
+	FParse::Value(*Params, TEXT("MaxDimerizationSize="), maxDimerizationSize);
+
+	FString outputPath;
+	if (!FParse::Value(*Params, TEXT("Output="), outputPath)) {
+		outputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("MapGen-%s.csv"), *FDateTime::Now().ToString());
+	}
+
+	// Reserved up front because series are handed out by reference while more are being added
+	TArray<FBenchmarkSeries> allSeries;
+	allSeries.Reserve(mapSizes.Num() * (4 + dimensionsList.Num() * 3) + dimensionsList.Num() * 6);
+	auto makeSeries = [&](const TCHAR* name, int32 mapSize, int32 dimensions, int32 callsPerSample = 1) -> FBenchmarkSeries& {
+		auto& series = allSeries.AddDefaulted_GetRef();
+		series.Name = name;
+		series.MapSize = mapSize;
+		series.Dimensions = dimensions;
+		series.CallsPerSample = callsPerSample;
+		return series;
+	};
+
+	URandomWalkLibrary::ResetMapGenCounters();
+
+	for (auto mapSize : mapSizes) {
+		UE_LOG(LogTemp, Display, TEXT("Benchmarking walks with mapSize %d"), mapSize);
+
+		if (mapSize <= maxDimerizationSize) {
+			auto& dimerization = makeSeries(TEXT("DimerizationWalk"), mapSize, 0);
+			for (int32 seed = 0; seed < seedCount; seed++) {
+				RunSample<TArray<FCoordinate2D>>(dimerization, [&] { return URandomWalkLibrary::DimerizationWalk(mapSize, FRandomStream(seed)); });
+			}
+		}
+
+		auto& pivot = makeSeries(TEXT("PivotWalk"), mapSize, 0);
+		for (int32 seed = 0; seed < seedCount; seed++) {
+			RunSample<TArray<FCoordinate2D>>(pivot, [&] { return URandomWalkLibrary::PivotWalk(mapSize, FRandomStream(seed)); });
+		}
+
+		auto& tMap = makeSeries(TEXT("TMap"), mapSize, 0);
+		auto& coordinateMap = makeSeries(TEXT("TCoordinateMap"), mapSize, 0);
+		for (int32 seed = 0; seed < seedCount; seed++) {
+			const auto walk = URandomWalkLibrary::SelfAvoidingWalk(mapSize, FRandomStream(seed));
+			const auto expected = FillAndProbeCoordinateMap<TMap<FCoordinate2D, int32>>(walk);
+			tMap.bMatchesReference &= RunSample<int64>(tMap, [&] { return FillAndProbeCoordinateMap<TMap<FCoordinate2D, int32>>(walk); }) == expected;
+			// Both maps have to agree on what's in them too
+			coordinateMap.bMatchesReference &= RunSample<int64>(coordinateMap, [&] { return FillAndProbeCoordinateMap<TCoordinateMap<int32>>(walk); }) == expected;
+		}
+
+		for (auto dimensions : dimensionsList) {
+			// Single threaded so every allocation is counted, the parallel series below is for the wall time
+			auto& chunkPaths = makeSeries(TEXT("GenerateChunkPaths"), mapSize, dimensions);
+			auto& chunkPathsParallel = makeSeries(TEXT("GenerateChunkPathsParallel"), mapSize, dimensions);
+			chunkPathsParallel.bCountAllocations = false;
+			for (int32 seed = 0; seed < seedCount; seed++) {
+				const auto walk = URandomWalkLibrary::SelfAvoidingWalk(mapSize, FRandomStream(seed));
+				RunSample<TArray<FChunkPath>>(chunkPaths, [&] { return URandomWalkLibrary::GenerateChunkPaths(walk, seed, dimensions, true); });
+				RunSample<TArray<FChunkPath>>(chunkPathsParallel, [&] { return URandomWalkLibrary::GenerateChunkPaths(walk, seed, dimensions); });
+			}
+
+			// Endless mode regenerates maps over and over with the same context. That it doesn't allocate once it's warmed
+			// up is checked by the ContextDoesNotAllocateAfterWarmUp automation test, this is just the time it takes
+			auto& regenerate = makeSeries(TEXT("RegenerateMapWithContext"), mapSize, dimensions);
+
+			FMapGenContext context;
+			TArray<FCoordinate2D> contextWalk;
+			TArray<FChunkPath> contextPaths;
+			auto regenerateMap = [&](int32 seed) {
+				URandomWalkLibrary::SelfAvoidingWalk(mapSize, FRandomStream(seed), context, contextWalk);
+				URandomWalkLibrary::GenerateChunkPaths(contextWalk, seed, context, contextPaths, dimensions);
+				return contextPaths.Num();
+			};
+			regenerateMap(0);
+
+			for (int32 seed = 0; seed < seedCount; seed++) {
+				RunSample<int32>(regenerate, [&] { return regenerateMap(seed); });
+			}
+		}
+	}
+
+	for (auto dimensions : dimensionsList) {
+		UE_LOG(LogTemp, Display, TEXT("Benchmarking chunk utilities with dimensions %d"), dimensions);
+
+		auto& dijkstra = makeSeries(TEXT("DijkstraRandomPath"), 0, dimensions);
+		for (int32 seed = 0; seed < seedCount; seed++) {
+			FRandomStream endpoints(seed);
+			const auto start = FCoordinate2D(0, endpoints.RandRange(1, dimensions - 2));
+			const auto end = FCoordinate2D(dimensions - 1, endpoints.RandRange(1, dimensions - 2));
+
+			RunSample<TArray<FCoordinate2D>>(dijkstra, [&] { return URandomWalkLibrary::DijkstraRandomPath(start, end, FRandomStream(seed), dimensions); });
+		}
+
+		// Each sample sums the results so the calls can't be optimized away
+		auto& neighbors = makeSeries(TEXT("GetAllNeighbors"), 0, dimensions, UTILITY_CALLS_PER_SAMPLE);
+		auto& toChunk = makeSeries(TEXT("ConvertGlobalCoordinateToChunkCoordinate"), 0, dimensions, UTILITY_CALLS_PER_SAMPLE);
+		auto& toLocal = makeSeries(TEXT("ConvertGlobalCoordinateToChunkLocalCoordinate"), 0, dimensions, UTILITY_CALLS_PER_SAMPLE);
+		auto& toIndex = makeSeries(TEXT("ConvertCoordinatesToIndex"), 0, dimensions, UTILITY_CALLS_PER_SAMPLE);
+		auto& toCoordinates = makeSeries(TEXT("ConvertIndexToCoordinates"), 0, dimensions, UTILITY_CALLS_PER_SAMPLE);
+
+		// Cover negative coordinates too, they take a different path through the chunk conversions
+		auto globalTile = [](int32 i) { return FCoordinate2D(i % 512 - 256, i / 512 - 97); };
+
+		for (int32 seed = 0; seed < seedCount; seed++) {
+			auto sumNeighbors = [&] {
+				int64 checksum = 0;
+				for (int32 i = 0; i < UTILITY_CALLS_PER_SAMPLE; i++) {
+					for (auto& neighbor : URandomWalkLibrary::GetAllNeighbors(globalTile(i), dimensions)) {
+						checksum += neighbor.X * 31 + neighbor.Y;
+					}
+				}
+				return checksum;
+			};
+			RunSample<int64>(neighbors, sumNeighbors);
+
+			auto sumChunks = [&] {
+				int64 checksum = 0;
+				for (int32 i = 0; i < UTILITY_CALLS_PER_SAMPLE; i++) {
+					auto chunk = UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(globalTile(i), dimensions);
+					checksum += chunk.X * 31 + chunk.Y;
+				}
+				return checksum;
+			};
+			RunSample<int64>(toChunk, sumChunks);
+
+			auto sumLocals = [&] {
+				int64 checksum = 0;
+				for (int32 i = 0; i < UTILITY_CALLS_PER_SAMPLE; i++) {
+					auto local = UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkLocalCoordinate(globalTile(i), dimensions);
+					checksum += local.X * 31 + local.Y;
+				}
+				return checksum;
+			};
+			RunSample<int64>(toLocal, sumLocals);
+
+			auto sumIndices = [&] {
+				int64 checksum = 0;
+				for (int32 i = 0; i < UTILITY_CALLS_PER_SAMPLE; i++) {
+					checksum += UMapUtilitiesLibrary::ConvertCoordinatesToIndex(i % dimensions, (i / dimensions) % dimensions, dimensions);
+				}
+				return checksum;
+			};
+			RunSample<int64>(toIndex, sumIndices);
+
+			auto sumCoordinates = [&] {
+				int64 checksum = 0;
+				for (int32 i = 0; i < UTILITY_CALLS_PER_SAMPLE; i++) {
+					auto coordinate = UMapUtilitiesLibrary::ConvertIndexToCoordinates(i % (dimensions * dimensions), dimensions);
+					checksum += coordinate.X * 31 + coordinate.Y;
+				}
+				return checksum;
+			};
+			RunSample<int64>(toCoordinates, sumCoordinates);
+		}
+	}
+
+	// Write everything out
+	bool bAllMatchReference = true;
+	FString csv = TEXT("benchmark,mapSize,dimensions,samples,p50_us,p99_us,mean_us,allocations_per_call,retries_per_call,matches_reference\n");
+	for (auto& series : allSeries) {
+		const auto calls = static_cast<double>(series.Microseconds.Num()) * series.CallsPerSample;
+
+		double total = 0.0;
+		for (auto sample : series.Microseconds) {
+			total += sample;
+		}
+
+		// Left empty for series that don't count allocations
+		const auto allocationsPerCall = series.bCountAllocations ? FString::Printf(TEXT("%.3f"), series.Allocations / FMath::Max(calls, 1.0)) : FString();
+
+		csv += FString::Printf(TEXT("%s,%d,%d,%d,%.3f,%.3f,%.3f,%s,%.3f,%s\n"),
+			*series.Name, series.MapSize, series.Dimensions, series.Microseconds.Num(),
+			Percentile(series.Microseconds, 0.5), Percentile(series.Microseconds, 0.99), total / FMath::Max(series.Microseconds.Num(), 1),
+			*allocationsPerCall, series.Retries / FMath::Max(calls, 1.0),
+			series.bMatchesReference ? TEXT("true") : TEXT("false"));
+
+		if (!series.bMatchesReference) {
+			UE_LOG(LogTemp, Error, TEXT("%s (mapSize %d, dimensions %d) disagreed with the reference TMap"), *series.Name, series.MapSize, series.Dimensions);
+			bAllMatchReference = false;
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(csv, *outputPath)) {
+		UE_LOG(LogTemp, Error, TEXT("Failed to write benchmark results to %s"), *outputPath);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Wrote map generation benchmark results to %s"), *outputPath);
+	return bAllMatchReference ? 0 : 2;
+}
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MapGenBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless benchmark for the map generation and coordinate utilities.
+ *
+ * Sweeps map sizes, chunk dimensions and seeds, and writes p50/p99 timings, allocations and walk retries per call to
+ * a CSV file. Correctness and per-seed determinism are the BadTowerDefense.MapGen automation tests' job. Returns 2
+ * if TMap and TCoordinateMap disagreed on what they contain.
+ *
+ * UnrealEditor-Cmd BadTowerDefenseV2.uproject -run=MapGenBenchmark -nullrhi -unattended
+ *     [-MapSizes=16,64,256,1024] [-Dimensions=8,16] [-Seeds=20] [-MaxDimerizationSize=128] [-Output=<path.csv>]
+ */
+UCLASS()
+class UMapGenBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMapGenBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MapGenContext.h"
+
+void FMapGenContext::Empty()
+{
+	Pathfinder = FHexPathfinder();
+	Visited.Empty();
+	Occupied.Empty();
+	Moved.Empty();
+
+	for (auto& level : WalkBuffers) {
+		level[0].Empty();
+		level[1].Empty();
+	}
+}
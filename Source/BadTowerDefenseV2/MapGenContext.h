@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "CoordinateHashMap.h"
+#include "HexPathfinder.h"
+
+#include "CoreMinimal.h"
+
+/**
+ * Scratch space for the URandomWalkLibrary overloads that take a context. Every buffer is reset (not freed)
+ * before it's used, so once a context has generated a map of a given size, generating another one of the
+ * same size doesn't touch the heap at all.
+ *
+ * Not thread safe: use one context per thread (e.g. one per ParallelFor worker).
+ */
+class BADTOWERDEFENSEV2_API FMapGenContext
+{
+public:
+	// DimerizationWalk halves the map size on every level, so an int32 size can't recurse deeper than this
+	static constexpr int32 MAX_WALK_DEPTH = 32;
+
+	/** The two halves DimerizationWalk joins together at the given recursion depth */
+	TArray<FCoordinate2D>& GetWalkBuffer(int32 depth, int32 half) {
+		check(depth >= 0 && depth < MAX_WALK_DEPTH && (half == 0 || half == 1));
+		return WalkBuffers[depth][half];
+	}
+
+	/** Frees every buffer, e.g. after generating a one-off map much bigger than usual */
+	void Empty();
+
+	FHexPathfinder Pathfinder;
+
+	// Tiles visited by ShortWalk / seen by IsSelfAvoiding
+	FCoordinateSet Visited;
+
+	// Tile -> index in the walk for PivotWalk
+	TCoordinateMap<int32> Occupied;
+
+	// Where PivotWalk's moving side would end up
+	TArray<FCoordinate2D> Moved;
+
+private:
+	// Fixed size so references into it stay valid while deeper levels are being generated
+	TArray<FCoordinate2D> WalkBuffers[MAX_WALK_DEPTH][2];
+};
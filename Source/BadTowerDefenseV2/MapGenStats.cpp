@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MapGenStats.h"
+
+DEFINE_STAT(STAT_MapGen_ShortWalk);
+DEFINE_STAT(STAT_MapGen_DimerizationWalk);
+DEFINE_STAT(STAT_MapGen_PivotWalk);
+DEFINE_STAT(STAT_MapGen_DijkstraRandomPath);
+DEFINE_STAT(STAT_MapGen_FindNeighborInNextChunk);
+DEFINE_STAT(STAT_MapGen_GenerateChunkPaths);
+DEFINE_STAT(STAT_MapGen_ConvertCoordinatesToIndex);
+DEFINE_STAT(STAT_MapGen_ConvertIndexToCoordinates);
+DEFINE_STAT(STAT_MapGen_ConvertGlobalCoordinateToChunkCoordinate);
+DEFINE_STAT(STAT_MapGen_ConvertGlobalCoordinateToChunkLocalCoordinate);
+DEFINE_STAT(STAT_MapGen_BatchConvertGlobalToChunkCoordinates);
+DEFINE_STAT(STAT_MapGen_BatchConvertGlobalToChunkLocalCoordinates);
+DEFINE_STAT(STAT_MapGen_ChunkStreaming);
+DEFINE_STAT(STAT_MapGen_FlowFieldRebuild);
+
+DEFINE_STAT(STAT_MapGen_ResidentChunks);
+DEFINE_STAT(STAT_MapGen_PendingChunks);
+
+DEFINE_STAT(STAT_MapGen_NodesExpanded);
+DEFINE_STAT(STAT_MapGen_WalkRetries);
+DEFINE_STAT(STAT_MapGen_ChunksBuilt);
+
+FMapGenCounters GMapGenCounters;
+
+TRACE_DECLARE_INT_COUNTER(MapGen_NodesExpanded, TEXT("MapGen/NodesExpanded"));
+TRACE_DECLARE_INT_COUNTER(MapGen_WalkRetries, TEXT("MapGen/WalkRetries"));
+TRACE_DECLARE_INT_COUNTER(MapGen_ChunksBuilt, TEXT("MapGen/ChunksBuilt"));
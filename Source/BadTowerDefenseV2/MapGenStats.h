@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+// Set to 1 to log every tile the map generation touches. Only meant for debugging a single chunk,
+// with it off none of the per-tile logging is compiled in.
+#ifndef MAPGEN_VERBOSE_LOGGING
+#define MAPGEN_VERBOSE_LOGGING 0
+#endif
+
+#if MAPGEN_VERBOSE_LOGGING
+#define MAPGEN_VERBOSE_LOG(Verbosity, Format, ...) UE_LOG(LogTemp, Verbosity, Format, ##__VA_ARGS__)
+#else
+#define MAPGEN_VERBOSE_LOG(Verbosity, Format, ...) do {} while (0)
+#endif
+
+DECLARE_STATS_GROUP(TEXT("MapGen"), STATGROUP_MapGen, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ShortWalk"), STAT_MapGen_ShortWalk, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("DimerizationWalk"), STAT_MapGen_DimerizationWalk, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PivotWalk"), STAT_MapGen_PivotWalk, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("DijkstraRandomPath"), STAT_MapGen_DijkstraRandomPath, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FindNeighborInNextChunk"), STAT_MapGen_FindNeighborInNextChunk, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateChunkPaths"), STAT_MapGen_GenerateChunkPaths, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ConvertCoordinatesToIndex"), STAT_MapGen_ConvertCoordinatesToIndex, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ConvertIndexToCoordinates"), STAT_MapGen_ConvertIndexToCoordinates, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ConvertGlobalCoordinateToChunkCoordinate"), STAT_MapGen_ConvertGlobalCoordinateToChunkCoordinate, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ConvertGlobalCoordinateToChunkLocalCoordinate"), STAT_MapGen_ConvertGlobalCoordinateToChunkLocalCoordinate, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("BatchConvertGlobalToChunkCoordinates"), STAT_MapGen_BatchConvertGlobalToChunkCoordinates, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("BatchConvertGlobalToChunkLocalCoordinates"), STAT_MapGen_BatchConvertGlobalToChunkLocalCoordinates, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ChunkStreaming"), STAT_MapGen_ChunkStreaming, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FlowFieldRebuild"), STAT_MapGen_FlowFieldRebuild, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+
+// Current state of UChunkStreamingSubsystem
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Resident Chunks"), STAT_MapGen_ResidentChunks, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pending Chunks"), STAT_MapGen_PendingChunks, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+
+// Per-generation counters, cleared by URandomWalkLibrary::ResetMapGenCounters
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Nodes Expanded"), STAT_MapGen_NodesExpanded, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Walk Retries"), STAT_MapGen_WalkRetries, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Chunks Built"), STAT_MapGen_ChunksBuilt, STATGROUP_MapGen, BADTOWERDEFENSEV2_API);
+
+// Same counters as plain values, for tools (like the MapGenBenchmark commandlet) that need to read them back in code
+struct FMapGenCounters
+{
+	std::atomic<int64> NodesExpanded = 0;
+	std::atomic<int64> WalkRetries = 0;
+	std::atomic<int64> ChunksBuilt = 0;
+};
+
+extern BADTOWERDEFENSEV2_API FMapGenCounters GMapGenCounters;
+
+TRACE_DECLARE_INT_COUNTER_EXTERN(MapGen_NodesExpanded);
+TRACE_DECLARE_INT_COUNTER_EXTERN(MapGen_WalkRetries);
+TRACE_DECLARE_INT_COUNTER_EXTERN(MapGen_ChunksBuilt);
+
+// Cycle counter for `stat MapGen` plus a matching CPU event for Insights. Both compile out when stats/trace are disabled.
+#define MAPGEN_SCOPE(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_MapGen_##Name); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(MapGen_##Name)
+
+// Wrapped in do/while so each expands to a single statement, safe under an unbraced if or else
+#define MAPGEN_COUNTER_ADD(Name, Amount) \
+	do { \
+		INC_DWORD_STAT_BY(STAT_MapGen_##Name, Amount); \
+		TRACE_COUNTER_ADD(MapGen_##Name, Amount); \
+		GMapGenCounters.Name += (Amount); \
+	} while (0)
+
+#define MAPGEN_COUNTER_RESET(Name) \
+	do { \
+		SET_DWORD_STAT(STAT_MapGen_##Name, 0); \
+		TRACE_COUNTER_SET(MapGen_##Name, 0); \
+		GMapGenCounters.Name = 0; \
+	} while (0)
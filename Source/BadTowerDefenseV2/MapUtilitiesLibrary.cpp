@@ -3,9 +3,18 @@
 /// EVAN, YOU ARE USING EVEN-R HEXAGON LABELING WITH EVEN ROWS ALL COLS!!!!
 
 #include "MapUtilitiesLibrary.h"
+#include "HexChunkBitboard.h"
+#include "HexMath.h"
+#include "MapGenStats.h"
 
 bool UMapUtilitiesLibrary::IsNonCornerEdgeTile(int32 X, int32 Y, int32 dimensions)
 {
+	// The bitboard only knows tiles inside the chunk. Anything else goes through the formula so it answers the same
+	// for every input, out of range ones included
+	if (dimensions == FHexChunkBitboard::Dimensions && X >= 0 && Y >= 0 && X < dimensions && Y < dimensions) {
+		return FHexChunkBitboard::IsNonCornerEdgeTile(FCoordinate2D(X, Y));
+	}
+
 	return (Y == 0 || Y == dimensions - 1)
 		&& (X != 0 && X != dimensions - 1)
 		|| (X == 0 || X == dimensions - 1)
@@ -14,50 +23,180 @@ bool UMapUtilitiesLibrary::IsNonCornerEdgeTile(int32 X, int32 Y, int32 dimension
 
 int32 UMapUtilitiesLibrary::ConvertCoordinatesToIndex(int32 X, int32 Y, int32 dimensions)
 {
+	MAPGEN_SCOPE(ConvertCoordinatesToIndex);
+
 	auto index = dimensions * X + Y;
-	UE_LOG(LogTemp, Log, TEXT("Converted Coordinate (%d, %d) to index %d"), X, Y, index);
+	MAPGEN_VERBOSE_LOG(Log, TEXT("Converted Coordinate (%d, %d) to index %d"), X, Y, index);
 	return index;
 }
 
 FCoordinate2D UMapUtilitiesLibrary::ConvertIndexToCoordinates(int32 index, int32 dimensions)
 {
-	UE_LOG(LogTemp, Display, TEXT("Converting Index %d to Coordinates (%d, %d)"), index, index % dimensions, index / dimensions);
+	MAPGEN_SCOPE(ConvertIndexToCoordinates);
+
+	MAPGEN_VERBOSE_LOG(Display, TEXT("Converting Index %d to Coordinates (%d, %d)"), index, index % dimensions, index / dimensions);
 	return FCoordinate2D(index % dimensions, index / dimensions);
 }
 
-FCoordinate2D UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(const FCoordinate2D& location, int32 dimensions)
+static_assert(sizeof(FCoordinate2D) == 2 * sizeof(int32), "FCoordinate2D must be exactly two packed int32s");
+
+/// <summary>
+/// Floor division (bChunk) or always-positive modulo (!bChunk) of one coordinate by dimensions.
+/// Free of branches and integer division so ConvertLanes can be vectorized by the compiler
+/// </summary>
+template<bool bChunk, bool bPowerOfTwo>
+static FORCEINLINE int32 ConvertLane(int32 value, int32 dimensions, int32 shift, double inverse)
 {
-	
-	auto x = (location.X / dimensions);
-	auto y = (location.Y / dimensions);
+	if (bPowerOfTwo) {
+		// Arithmetic shift floors towards negative infinity and the mask is already positive, so no fix-ups
+		return bChunk ? value >> shift : value & (dimensions - 1);
+	}
+
+	// Truncating multiply by the reciprocal is at most one off either way, so one fix-up in each direction is enough
+	auto quotient = static_cast<int32>(value * inverse);
+	auto remainder = value - quotient * dimensions;
 
-	if (location.X < 0 && location.X % dimensions) {
-		x -= 1;
+	const auto under = remainder < 0 ? 1 : 0;
+	quotient -= under;
+	remainder += dimensions * under;
+
+	const auto over = remainder >= dimensions ? 1 : 0;
+	quotient += over;
+	remainder -= dimensions * over;
+
+	return bChunk ? quotient : remainder;
+}
+
+template<bool bChunk>
+static FORCEINLINE FCoordinate2D ConvertCoordinate(const FCoordinate2D& location, int32 dimensions)
+{
+	if (FMath::IsPowerOfTwo(dimensions)) {
+		const auto shift = static_cast<int32>(FMath::FloorLog2(dimensions));
+		return FCoordinate2D(ConvertLane<bChunk, true>(location.X, dimensions, shift, 0.0), ConvertLane<bChunk, true>(location.Y, dimensions, shift, 0.0));
 	}
 
-	if (location.Y < 0 && location.Y % dimensions) {
-		y -= 1;
+	const auto inverse = 1.0 / dimensions;
+	return FCoordinate2D(ConvertLane<bChunk, false>(location.X, dimensions, 0, inverse), ConvertLane<bChunk, false>(location.Y, dimensions, 0, inverse));
+}
+
+// The batch conversions treat the coordinates as a flat run of int32 lanes (X, Y, X, Y, ...)
+template<bool bChunk>
+static void ConvertLanes(const int32* lanes, int32* outLanes, int32 laneCount, int32 dimensions)
+{
+	if (FMath::IsPowerOfTwo(dimensions)) {
+		const auto shift = static_cast<int32>(FMath::FloorLog2(dimensions));
+		for (int32 i = 0; i < laneCount; i++) {
+			outLanes[i] = ConvertLane<bChunk, true>(lanes[i], dimensions, shift, 0.0);
+		}
+		return;
+	}
+
+	const auto inverse = 1.0 / dimensions;
+	for (int32 i = 0; i < laneCount; i++) {
+		outLanes[i] = ConvertLane<bChunk, false>(lanes[i], dimensions, 0, inverse);
 	}
+}
+
+FCoordinate2D UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(const FCoordinate2D& location, int32 dimensions)
+{
+	MAPGEN_SCOPE(ConvertGlobalCoordinateToChunkCoordinate);
 
-	auto result = FCoordinate2D(x, y);
-	UE_LOG(LogTemp, Display, TEXT("Converting Global Coordinate (%d, %d) to Chunk Coordinate: (%d, %d)"), location.X, location.Y, result.X, result.Y);
+	auto result = ConvertCoordinate<true>(location, dimensions);
+	MAPGEN_VERBOSE_LOG(Display, TEXT("Converting Global Coordinate (%d, %d) to Chunk Coordinate: (%d, %d)"), location.X, location.Y, result.X, result.Y);
 	return result;
 }
 
 FCoordinate2D UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkLocalCoordinate(const FCoordinate2D& location, int32 dimensions)
 {
-	// Using this chunkCoordinate, I need to add special handling IF the coordinates are negative...
-	// Need special handling because negatives are stupid!
-	auto result = FCoordinate2D(location.X % dimensions, location.Y % dimensions);
+	MAPGEN_SCOPE(ConvertGlobalCoordinateToChunkLocalCoordinate);
+
+	// Negative coordinates wrap around to the far side of their chunk, ConvertLane takes care of that
+	auto result = ConvertCoordinate<false>(location, dimensions);
+	MAPGEN_VERBOSE_LOG(Display, TEXT("Convert Global Coordinate (%d, %d) to Chunk Local Coordinate (%d, %d)"), location.X, location.Y, result.X, result.Y);
+
+	return result;
+}
+
+void UMapUtilitiesLibrary::ConvertGlobalCoordinatesToChunkCoordinates(const TArray<FCoordinate2D>& locations, TArray<FCoordinate2D>& outChunkCoordinates, int32 dimensions)
+{
+	outChunkCoordinates.SetNumUninitialized(locations.Num());
+	BatchConvertGlobalToChunkCoordinates(locations, outChunkCoordinates, dimensions);
+}
+
+void UMapUtilitiesLibrary::ConvertGlobalCoordinatesToChunkLocalCoordinates(const TArray<FCoordinate2D>& locations, TArray<FCoordinate2D>& outLocalCoordinates, int32 dimensions)
+{
+	outLocalCoordinates.SetNumUninitialized(locations.Num());
+	BatchConvertGlobalToChunkLocalCoordinates(locations, outLocalCoordinates, dimensions);
+}
+
+void UMapUtilitiesLibrary::BatchConvertGlobalToChunkCoordinates(TConstArrayView<FCoordinate2D> locations, TArrayView<FCoordinate2D> outChunkCoordinates, int32 dimensions)
+{
+	MAPGEN_SCOPE(BatchConvertGlobalToChunkCoordinates);
 
-	if (result.X < 0) {
-		result.X += dimensions;
+	check(locations.Num() == outChunkCoordinates.Num());
+	if (locations.IsEmpty()) {
+		return;
 	}
+	ConvertLanes<true>(reinterpret_cast<const int32*>(locations.GetData()), reinterpret_cast<int32*>(outChunkCoordinates.GetData()), locations.Num() * 2, dimensions);
+}
+
+void UMapUtilitiesLibrary::BatchConvertGlobalToChunkLocalCoordinates(TConstArrayView<FCoordinate2D> locations, TArrayView<FCoordinate2D> outLocalCoordinates, int32 dimensions)
+{
+	MAPGEN_SCOPE(BatchConvertGlobalToChunkLocalCoordinates);
 
-	if (result.Y < 0) {
-		result.Y += dimensions;
+	check(locations.Num() == outLocalCoordinates.Num());
+	if (locations.IsEmpty()) {
+		return;
 	}
-	UE_LOG(LogTemp, Display, TEXT("Convert Global Coordinate (%d, %d) to Chunk Local Coordinate (%d, %d)"), location.X, location.Y, result.X, result.Y);
+	ConvertLanes<false>(reinterpret_cast<const int32*>(locations.GetData()), reinterpret_cast<int32*>(outLocalCoordinates.GetData()), locations.Num() * 2, dimensions);
+}
 
-	return result;
+// Distance between rows, as a fraction of the distance between neighboring tiles in a row (sqrt(3) / 2)
+constexpr double HEX_ROW_SPACING = 0.86602540378443864676;
+
+FVector UMapUtilitiesLibrary::ConvertGlobalCoordinateToWorldLocation(const FCoordinate2D& location, float tileSize)
+{
+	const auto rowOffset = (location.Y & 1) ? 0.5 : 0.0;
+	return FVector((location.X + rowOffset) * tileSize, location.Y * HEX_ROW_SPACING * tileSize, 0.0);
+}
+
+FCoordinate2D UMapUtilitiesLibrary::ConvertWorldLocationToGlobalCoordinate(const FVector& worldLocation, float tileSize)
+{
+	if (tileSize <= 0.f) {
+		return FCoordinate2D(0, 0);
+	}
+
+	// Fractional axial coordinates (q = X - floor(Y / 2), r = Y), rounded to the nearest hex in cube space
+	const auto r = worldLocation.Y / (HEX_ROW_SPACING * tileSize);
+	const auto q = worldLocation.X / tileSize - r * 0.5;
+	return HexMath::FromAxial(HexMath::RoundAxial(q, r));
+}
+
+int32 UMapUtilitiesLibrary::GetHexDistance(const FCoordinate2D& from, const FCoordinate2D& to)
+{
+	return from.GetHexDistance(to);
+}
+
+void UMapUtilitiesLibrary::GetTilesInHexRange(const FCoordinate2D& center, int32 range, TArray<FCoordinate2D>& outTiles)
+{
+	outTiles.Reset(HexMath::GetNumTilesInRange(range));
+	HexMath::ForEachTileInRange(center, range, [&](const FCoordinate2D& tile) {
+		outTiles.Add(tile);
+	});
+}
+
+void UMapUtilitiesLibrary::GetTilesInHexRing(const FCoordinate2D& center, int32 radius, TArray<FCoordinate2D>& outTiles)
+{
+	outTiles.Reset(HexMath::GetNumTilesInRing(radius));
+	HexMath::ForEachTileInRing(center, radius, [&](const FCoordinate2D& tile) {
+		outTiles.Add(tile);
+	});
+}
+
+void UMapUtilitiesLibrary::GetHexLine(const FCoordinate2D& start, const FCoordinate2D& end, TArray<FCoordinate2D>& outTiles)
+{
+	outTiles.Reset(start.GetHexDistance(end) + 1);
+	HexMath::ForEachTileOnLine(start, end, [&](const FCoordinate2D& tile) {
+		outTiles.Add(tile);
+	});
 }
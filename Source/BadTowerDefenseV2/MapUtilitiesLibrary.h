@@ -32,4 +32,46 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure)
 	static FCoordinate2D ConvertGlobalCoordinateToChunkLocalCoordinate(const FCoordinate2D& location, int32 dimensions = 8);
 
+	/** Converts a whole batch of global coordinates to chunk coordinates at once */
+	UFUNCTION(BlueprintCallable)
+	static void ConvertGlobalCoordinatesToChunkCoordinates(const TArray<FCoordinate2D>& locations, TArray<FCoordinate2D>& outChunkCoordinates, int32 dimensions = 8);
+
+	/** Converts a whole batch of global coordinates to chunk local coordinates at once */
+	UFUNCTION(BlueprintCallable)
+	static void ConvertGlobalCoordinatesToChunkLocalCoordinates(const TArray<FCoordinate2D>& locations, TArray<FCoordinate2D>& outLocalCoordinates, int32 dimensions = 8);
+
+	/**
+	 * Allocation-free batch conversions for C++. The output view must be the same size as the input and may alias it.
+	 * Runs as a branch-free loop over the raw X/Y lanes, with a shift-and-mask fast path when dimensions is a power of two.
+	 */
+	static void BatchConvertGlobalToChunkCoordinates(TConstArrayView<FCoordinate2D> locations, TArrayView<FCoordinate2D> outChunkCoordinates, int32 dimensions = 8);
+	static void BatchConvertGlobalToChunkLocalCoordinates(TConstArrayView<FCoordinate2D> locations, TArrayView<FCoordinate2D> outLocalCoordinates, int32 dimensions = 8);
+
+	/**
+	 * Center of a global tile in world space (Z = 0), with tile (0, 0) at the origin. tileSize is the distance
+	 * between the centers of neighboring tiles; rows run along Y and odd rows are shifted half a tile along X.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	static FVector ConvertGlobalCoordinateToWorldLocation(const FCoordinate2D& location, float tileSize = 100.f);
+
+	/** The global tile a world location falls into. Inverse of ConvertGlobalCoordinateToWorldLocation (Z is ignored) */
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	static FCoordinate2D ConvertWorldLocationToGlobalCoordinate(const FVector& worldLocation, float tileSize = 100.f);
+
+	/** Number of steps between two global tiles through neighboring tiles */
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	static int32 GetHexDistance(const FCoordinate2D& from, const FCoordinate2D& to);
+
+	/** Every global tile within range steps of center (center included), nearest first */
+	UFUNCTION(BlueprintCallable)
+	static void GetTilesInHexRange(const FCoordinate2D& center, int32 range, TArray<FCoordinate2D>& outTiles);
+
+	/** Every global tile exactly radius steps from center */
+	UFUNCTION(BlueprintCallable)
+	static void GetTilesInHexRing(const FCoordinate2D& center, int32 radius, TArray<FCoordinate2D>& outTiles);
+
+	/** The tiles a straight line from start to end passes through, both ends included */
+	UFUNCTION(BlueprintCallable)
+	static void GetHexLine(const FCoordinate2D& start, const FCoordinate2D& end, TArray<FCoordinate2D>& outTiles);
+
 };
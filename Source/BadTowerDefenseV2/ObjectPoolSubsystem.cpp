@@ -0,0 +1,307 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ObjectPoolSubsystem.h"
+#include "PoolableActor.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "NiagaraComponent.h"
+#include "NiagaraSystem.h"
+
+DECLARE_STATS_GROUP(TEXT("ObjectPool"), STATGROUP_ObjectPool, STATCAT_Advanced);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pool Hits"), STAT_ObjectPool_Hits, STATGROUP_ObjectPool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pool Misses"), STAT_ObjectPool_Misses, STATGROUP_ObjectPool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Objects In Use"), STAT_ObjectPool_InUse, STATGROUP_ObjectPool);
+
+static void NoteAcquired(FObjectPoolStats& stats, bool bHit)
+{
+	if (bHit) {
+		stats.Hits++;
+		stats.NumFree--;
+		INC_DWORD_STAT(STAT_ObjectPool_Hits);
+	}
+	else {
+		stats.Misses++;
+		INC_DWORD_STAT(STAT_ObjectPool_Misses);
+	}
+
+	stats.NumInUse++;
+	stats.HighWaterMark = FMath::Max(stats.HighWaterMark, stats.NumInUse);
+	INC_DWORD_STAT(STAT_ObjectPool_InUse);
+}
+
+static void NoteReleased(FObjectPoolStats& stats)
+{
+	stats.NumInUse--;
+	stats.NumFree++;
+	DEC_DWORD_STAT(STAT_ObjectPool_InUse);
+}
+
+void UObjectPoolSubsystem::Deinitialize()
+{
+	// The world tears down the actors and components themselves
+	for (auto& pool : ActorPools) {
+		DEC_DWORD_STAT_BY(STAT_ObjectPool_InUse, pool.Value.Stats.NumInUse);
+	}
+	for (auto& pool : EffectPools) {
+		DEC_DWORD_STAT_BY(STAT_ObjectPool_InUse, pool.Value.Stats.NumInUse);
+	}
+
+	ActorPools.Empty();
+	EffectPools.Empty();
+	ActorsInUse.Empty();
+	EffectsInUse.Empty();
+	Super::Deinitialize();
+}
+
+bool UObjectPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+AActor* UObjectPoolSubsystem::SpawnPooledActor(UClass* actorClass)
+{
+	FActorSpawnParameters spawnParameters;
+	spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	auto actor = GetWorld()->SpawnActor<AActor>(actorClass, FTransform::Identity, spawnParameters);
+	if (actor) {
+		actor->OnDestroyed.AddDynamic(this, &UObjectPoolSubsystem::OnPooledActorDestroyed);
+	}
+	return actor;
+}
+
+/// <summary>
+/// Parks actor and puts it into pool's free list
+/// </summary>
+void UObjectPoolSubsystem::DeactivateActor(FActorPool& pool, AActor* actor)
+{
+	pool.Parked.AddDefaulted_GetRef().Park(actor);
+	pool.Free.Add(actor);
+}
+
+/// <summary>
+/// Moves actor to transform and, if it came out of a free list, unparks it. Freshly spawned actors are left as they were authored
+/// </summary>
+void UObjectPoolSubsystem::ActivateActor(AActor* actor, const FTransform& transform, FParkedActor* parked)
+{
+	actor->SetActorTransform(transform, false, nullptr, ETeleportType::ResetPhysics);
+
+	if (parked) {
+		parked->Unpark(actor);
+	}
+
+	// Projectile movement only picks up its initial speed when the component is initialized, so redo that by hand
+	if (auto movement = actor->FindComponentByClass<UProjectileMovementComponent>()) {
+		movement->SetUpdatedComponent(actor->GetRootComponent());
+		movement->Velocity = actor->GetActorForwardVector() * movement->InitialSpeed;
+		movement->UpdateComponentVelocity();
+	}
+}
+
+void UObjectPoolSubsystem::PrewarmActors(TSubclassOf<AActor> actorClass, int32 count)
+{
+	if (!actorClass) {
+		return;
+	}
+
+	auto& pool = ActorPools.FindOrAdd(actorClass.Get());
+	pool.Free.Reserve(count);
+	while (pool.Free.Num() < count) {
+		auto actor = SpawnPooledActor(actorClass);
+		if (!actor) {
+			UE_LOG(LogTemp, Warning, TEXT("Couldn't prewarm %s"), *actorClass->GetName());
+			return;
+		}
+
+		DeactivateActor(pool, actor);
+		pool.Stats.NumFree++;
+	}
+}
+
+AActor* UObjectPoolSubsystem::AcquireActor(TSubclassOf<AActor> actorClass, const FTransform& transform, AActor* owner, APawn* instigator)
+{
+	if (!actorClass) {
+		return nullptr;
+	}
+
+	auto& pool = ActorPools.FindOrAdd(actorClass.Get());
+
+	AActor* actor = nullptr;
+	FParkedActor parked;
+	while (!actor && !pool.Free.IsEmpty()) {
+		actor = pool.Free.Pop(false);
+		parked = pool.Parked.Pop(false);
+		if (!IsValid(actor)) {
+			// Destroyed by something else while it was waiting in the pool
+			pool.Stats.NumFree--;
+			actor = nullptr;
+		}
+	}
+
+	const auto bHit = actor != nullptr;
+	if (!actor) {
+		actor = SpawnPooledActor(actorClass);
+		if (!actor) {
+			return nullptr;
+		}
+	}
+	NoteAcquired(pool.Stats, bHit);
+	ActorsInUse.Add(actor);
+
+	actor->SetOwner(owner);
+	actor->SetInstigator(instigator);
+	ActivateActor(actor, transform, bHit ? &parked : nullptr);
+
+	if (actor->Implements<UPoolableActor>()) {
+		IPoolableActor::Execute_OnAcquiredFromPool(actor);
+	}
+	return actor;
+}
+
+void UObjectPoolSubsystem::ReleaseActor(AActor* actor)
+{
+	if (!IsValid(actor)) {
+		return;
+	}
+
+	if (ActorsInUse.Remove(actor) == 0) {
+		UE_LOG(LogTemp, Warning, TEXT("%s was released but isn't a pooled actor in use"), *actor->GetName());
+		return;
+	}
+
+	if (actor->Implements<UPoolableActor>()) {
+		IPoolableActor::Execute_OnReturnedToPool(actor);
+	}
+
+	actor->SetOwner(nullptr);
+	actor->SetInstigator(nullptr);
+
+	auto& pool = ActorPools.FindOrAdd(actor->GetClass());
+	DeactivateActor(pool, actor);
+	NoteReleased(pool.Stats);
+}
+
+bool UObjectPoolSubsystem::IsPooledActorInUse(const AActor* actor) const
+{
+	return ActorsInUse.Contains(const_cast<AActor*>(actor));
+}
+
+void UObjectPoolSubsystem::OnPooledActorDestroyed(AActor* actor)
+{
+	// Somebody called Destroy on a pooled actor instead of releasing it. Keep the counts honest;
+	// a destroyed actor left in a free list gets skipped when it's popped
+	auto pool = ActorPools.Find(actor->GetClass());
+	if (ActorsInUse.Remove(actor) > 0 && pool) {
+		pool->Stats.NumInUse--;
+		DEC_DWORD_STAT(STAT_ObjectPool_InUse);
+	}
+}
+
+UNiagaraComponent* UObjectPoolSubsystem::CreatePooledEffect(UNiagaraSystem* system)
+{
+	auto world = GetWorld();
+	auto outer = world->GetWorldSettings() ? static_cast<UObject*>(world->GetWorldSettings()) : static_cast<UObject*>(world);
+
+	auto component = NewObject<UNiagaraComponent>(outer);
+	component->SetAutoDestroy(false);
+	component->bAutoActivate = false;
+	component->SetAsset(system);
+	component->SetUsingAbsoluteLocation(true);
+	component->SetUsingAbsoluteRotation(true);
+	component->SetUsingAbsoluteScale(true);
+	component->OnSystemFinished.AddDynamic(this, &UObjectPoolSubsystem::OnPooledEffectFinished);
+	component->RegisterComponentWithWorld(world);
+	return component;
+}
+
+void UObjectPoolSubsystem::PrewarmEffects(UNiagaraSystem* system, int32 count)
+{
+	if (!system) {
+		return;
+	}
+
+	auto& pool = EffectPools.FindOrAdd(system);
+	pool.Free.Reserve(count);
+	while (pool.Free.Num() < count) {
+		pool.Free.Add(CreatePooledEffect(system));
+		pool.Stats.NumFree++;
+	}
+}
+
+UNiagaraComponent* UObjectPoolSubsystem::SpawnPooledEffect(UNiagaraSystem* system, const FVector& location, FRotator rotation, FVector scale)
+{
+	if (!system) {
+		return nullptr;
+	}
+
+	auto& pool = EffectPools.FindOrAdd(system);
+
+	UNiagaraComponent* component = nullptr;
+	while (!component && !pool.Free.IsEmpty()) {
+		component = pool.Free.Pop(false);
+		if (!IsValid(component)) {
+			pool.Stats.NumFree--;
+			component = nullptr;
+		}
+	}
+
+	NoteAcquired(pool.Stats, component != nullptr);
+	if (!component) {
+		component = CreatePooledEffect(system);
+	}
+	EffectsInUse.Add(component);
+
+	component->SetWorldLocationAndRotation(location, rotation);
+	component->SetWorldScale3D(scale);
+	component->SetVisibility(true);
+	component->Activate(true);
+	return component;
+}
+
+void UObjectPoolSubsystem::OnPooledEffectFinished(UNiagaraComponent* component)
+{
+	// Already back in the pool, or finished again after someone else reactivated it
+	if (EffectsInUse.Remove(component) == 0) {
+		return;
+	}
+
+	auto pool = EffectPools.Find(component->GetAsset());
+	if (!pool) {
+		return;
+	}
+
+	component->SetVisibility(false);
+	pool->Free.Add(component);
+	NoteReleased(pool->Stats);
+}
+
+FObjectPoolStats UObjectPoolSubsystem::GetActorPoolStats(TSubclassOf<AActor> actorClass) const
+{
+	auto pool = ActorPools.Find(actorClass.Get());
+	return pool ? pool->Stats : FObjectPoolStats();
+}
+
+FObjectPoolStats UObjectPoolSubsystem::GetEffectPoolStats(UNiagaraSystem* system) const
+{
+	auto pool = EffectPools.Find(system);
+	return pool ? pool->Stats : FObjectPoolStats();
+}
+
+void UObjectPoolSubsystem::LogPoolStats() const
+{
+	auto logStats = [](const FString& name, const FObjectPoolStats& stats) {
+		UE_LOG(LogTemp, Log, TEXT("%s: %d hits, %d misses, %d in use, %d free, high water mark %d"),
+			*name, stats.Hits, stats.Misses, stats.NumInUse, stats.NumFree, stats.HighWaterMark);
+	};
+
+	for (auto& pool : ActorPools) {
+		logStats(GetNameSafe(pool.Key), pool.Value.Stats);
+	}
+	for (auto& pool : EffectPools) {
+		logStats(GetNameSafe(pool.Key), pool.Value.Stats);
+	}
+}
@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ParkedActor.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/SubclassOf.h"
+#include "ObjectPoolSubsystem.generated.h"
+
+class UNiagaraComponent;
+class UNiagaraSystem;
+
+USTRUCT(BlueprintType)
+struct FObjectPoolStats {
+	GENERATED_USTRUCT_BODY()
+
+	// Acquires served from the pool
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pool")
+	int32 Hits = 0;
+
+	// Acquires that had to spawn something new
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pool")
+	int32 Misses = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pool")
+	int32 NumInUse = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pool")
+	int32 NumFree = 0;
+
+	// Most objects that were ever in use at once. Prewarm this many to never miss
+	UPROPERTY(BlueprintReadOnly, Category = "Object Pool")
+	int32 HighWaterMark = 0;
+};
+
+USTRUCT()
+struct FActorPool {
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> Free;
+
+	// What each actor in Free had switched on before it was released, same order as Free
+	TArray<FParkedActor> Parked;
+
+	FObjectPoolStats Stats;
+};
+
+USTRUCT()
+struct FNiagaraPool {
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<UNiagaraComponent>> Free;
+
+	FObjectPoolStats Stats;
+};
+
+/**
+ * Recycles short lived actors (projectiles) and Niagara effects (hit FX, the click cursor) instead of spawning and
+ * destroying them every time, which keeps spawn cost and GC churn out of busy frames.
+ *
+ * Released actors are hidden, lose collision and tick, and have their active components deactivated; acquiring one
+ * puts it back at the requested transform, reactivates only the components that were active when it was released and
+ * calls IPoolableActor::OnAcquiredFromPool so it can reset itself. Effects go back to their pool on their own once the
+ * system finishes.
+ *
+ * Call the Prewarm functions while loading so the first waves don't have to spawn anything.
+ */
+UCLASS()
+class BADTOWERDEFENSEV2_API UObjectPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/** Spawns actors of actorClass until at least count of them are free */
+	UFUNCTION(BlueprintCallable, Category = "Object Pool")
+	void PrewarmActors(TSubclassOf<AActor> actorClass, int32 count);
+
+	/** Takes an actor of actorClass out of the pool, spawning one if the pool is empty */
+	UFUNCTION(BlueprintCallable, Category = "Object Pool", meta = (DeterminesOutputType = "actorClass"))
+	AActor* AcquireActor(TSubclassOf<AActor> actorClass, const FTransform& transform, AActor* owner = nullptr, APawn* instigator = nullptr);
+
+	/** Puts an actor back into its pool. Call this where the actor would have destroyed itself, e.g. on impact */
+	UFUNCTION(BlueprintCallable, Category = "Object Pool")
+	void ReleaseActor(AActor* actor);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Object Pool")
+	bool IsPooledActorInUse(const AActor* actor) const;
+
+	/** Creates components for system until at least count of them are free */
+	UFUNCTION(BlueprintCallable, Category = "Object Pool")
+	void PrewarmEffects(UNiagaraSystem* system, int32 count);
+
+	/** Plays system once at a location with a pooled component. It goes back to the pool by itself when it finishes */
+	UFUNCTION(BlueprintCallable, Category = "Object Pool")
+	UNiagaraComponent* SpawnPooledEffect(UNiagaraSystem* system, const FVector& location, FRotator rotation = FRotator::ZeroRotator, FVector scale = FVector(1.f));
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Object Pool")
+	FObjectPoolStats GetActorPoolStats(TSubclassOf<AActor> actorClass) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Object Pool")
+	FObjectPoolStats GetEffectPoolStats(UNiagaraSystem* system) const;
+
+	/** Logs the stats of every pool */
+	UFUNCTION(BlueprintCallable, Category = "Object Pool")
+	void LogPoolStats() const;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	AActor* SpawnPooledActor(UClass* actorClass);
+	void DeactivateActor(FActorPool& pool, AActor* actor);
+	void ActivateActor(AActor* actor, const FTransform& transform, FParkedActor* parked);
+
+	UNiagaraComponent* CreatePooledEffect(UNiagaraSystem* system);
+
+	UFUNCTION()
+	void OnPooledActorDestroyed(AActor* actor);
+
+	UFUNCTION()
+	void OnPooledEffectFinished(UNiagaraComponent* component);
+
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FActorPool> ActorPools;
+
+	UPROPERTY()
+	TMap<TObjectPtr<UNiagaraSystem>, FNiagaraPool> EffectPools;
+
+	// Actors handed out and not released yet, to catch double releases and actors that never came from a pool
+	UPROPERTY()
+	TSet<TObjectPtr<AActor>> ActorsInUse;
+
+	// Effects playing right now, so a second finish event for one doesn't put it in its free list twice
+	UPROPERTY()
+	TSet<TObjectPtr<UNiagaraComponent>> EffectsInUse;
+};
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ParkedActor.h"
+
+#include "GameFramework/Actor.h"
+#include "Components/ActorComponent.h"
+
+void FParkedActor::Park(AActor* actor)
+{
+	bWasHidden = actor->IsHidden();
+	bHadCollision = actor->GetActorEnableCollision();
+	bWasTickEnabled = actor->IsActorTickEnabled();
+
+	actor->SetActorHiddenInGame(true);
+	actor->SetActorEnableCollision(false);
+	actor->SetActorTickEnabled(false);
+
+	// Hiding the actor already covers the root, deactivating it would only stop whatever it ticks for
+	const auto root = actor->GetRootComponent();
+	ActiveComponents.Reset();
+	for (auto component : actor->GetComponents()) {
+		if (component != root && component->IsActive()) {
+			ActiveComponents.Add(component);
+			component->Deactivate();
+		}
+	}
+}
+
+void FParkedActor::Unpark(AActor* actor)
+{
+	for (auto& component : ActiveComponents) {
+		if (component.IsValid()) {
+			component->Activate(true);
+		}
+	}
+	ActiveComponents.Reset();
+
+	actor->SetActorHiddenInGame(bWasHidden);
+	actor->SetActorEnableCollision(bHadCollision);
+	actor->SetActorTickEnabled(bWasTickEnabled);
+}
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * An actor taken out of play without destroying it, so it can be put back later: hidden, without collision or tick,
+ * and with its components deactivated. Shared by UObjectPoolSubsystem and UWaveSpawnSchedulerSubsystem.
+ *
+ * Park remembers what was on, and Unpark only turns that back on. Components authored with bAutoActivate off (impact
+ * FX, death audio) stay off until whatever owns them activates them, and the root component is never touched.
+ */
+struct BADTOWERDEFENSEV2_API FParkedActor {
+	/** Takes actor out of play and records which of its components were active */
+	void Park(AActor* actor);
+
+	/** Puts actor back into play the way it was parked. Move it to where it should be first */
+	void Unpark(AActor* actor);
+
+private:
+	// Restarted with Activate(true) on Unpark, so particles and movement start over
+	TArray<TWeakObjectPtr<UActorComponent>> ActiveComponents;
+	bool bWasHidden = false;
+	bool bHadCollision = true;
+	bool bWasTickEnabled = true;
+};
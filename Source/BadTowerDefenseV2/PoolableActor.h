@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "PoolableActor.generated.h"
+
+UINTERFACE(MinimalAPI, Blueprintable)
+class UPoolableActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Optional hooks for actors that live in a UObjectPoolSubsystem pool. BeginPlay only runs the first time an actor is
+ * spawned, so anything that has to be reset per use (damage, target, hit flags...) belongs in OnAcquiredFromPool.
+ */
+class BADTOWERDEFENSEV2_API IPoolableActor
+{
+	GENERATED_BODY()
+
+public:
+	/** The actor was just taken out of the pool, already moved to its spawn transform and reactivated */
+	UFUNCTION(BlueprintNativeEvent, Category = "Object Pool")
+	void OnAcquiredFromPool();
+
+	/** The actor is about to go back into the pool, before it gets hidden and deactivated */
+	UFUNCTION(BlueprintNativeEvent, Category = "Object Pool")
+	void OnReturnedToPool();
+};
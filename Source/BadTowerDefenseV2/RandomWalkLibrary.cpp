@@ -3,33 +3,70 @@
 
 #include "RandomWalkLibrary.h"
 #include "MapUtilitiesLibrary.h"
+#include "HexPathfinder.h"
+#include "HexLayout.h"
+#include "CoordinateHashMap.h"
+#include "MapGenContext.h"
+#include "ChunkRandom.h"
+#include "MapGenStats.h"
 
-// We want to make this high, but not so high that our absolute limit becomes a viable path
-constexpr int32 BORDER_INFINITY = TNumericLimits<int32>::Max() / 2;
-constexpr int32 MAX_WEIGHT = BORDER_INFINITY / 10;
+#include "Async/ParallelFor.h"
 
-bool URandomWalkLibrary::IsSelfAvoiding(TArray<FCoordinate2D> walk, int32 mapSize)
+// Past this many steps the rejection loop in DimerizationWalk gets too slow, so we pivot instead
+constexpr int32 PIVOT_WALK_THRESHOLD = 64;
+
+bool URandomWalkLibrary::IsSelfAvoiding(const TArray<FCoordinate2D>& walk, int32 mapSize)
 {
-	auto data = TSet<FCoordinate2D>(walk);
-	return mapSize + 1 == data.Num();
+	auto visited = FCoordinateSet();
+	return IsSelfAvoiding(walk, mapSize, visited);
+}
+
+bool URandomWalkLibrary::IsSelfAvoiding(const TArray<FCoordinate2D>& walk, int32 mapSize, FCoordinateSet& visited)
+{
+	if (walk.Num() != mapSize + 1) {
+		return false;
+	}
+
+	visited.Reset();
+	visited.Reserve(walk.Num());
+	for (auto& node : walk) {
+		bool bAlreadyInSet = false;
+		visited.Add(node, &bAlreadyInSet);
+		if (bAlreadyInSet) {
+			return false;
+		}
+	}
+	return true;
 }
 
 TArray<FCoordinate2D> URandomWalkLibrary::ShortWalk(int32 mapSize, const FRandomStream& stream)
 {
-	static auto deltas = TArray<FCoordinate2D>({ {1,0}, {0,1}, {-1,0}, {0,-1} });
+	FMapGenContext context;
+	TArray<FCoordinate2D> result;
+	ShortWalk(mapSize, stream, context, result);
+	return result;
+}
+
+void URandomWalkLibrary::ShortWalk(int32 mapSize, const FRandomStream& stream, FMapGenContext& context, TArray<FCoordinate2D>& outWalk)
+{
+	MAPGEN_SCOPE(ShortWalk);
+
+	static const FCoordinate2D deltas[] = { {1,0}, {0,1}, {-1,0}, {0,-1} };
+
+	auto& visitedPositions = context.Visited;
+	auto feasibleDeltas = TArray<FCoordinate2D, TInlineAllocator<UE_ARRAY_COUNT(deltas)>>();
 
-	auto visitedPositions = TArray<FCoordinate2D>();
-	auto result = TArray<FCoordinate2D>();
-	auto feasibleDeltas = TArray<FCoordinate2D>();
+	visitedPositions.Reset();
+	outWalk.Reset();
 
 	auto zero = FCoordinate2D(0, 0);
-	result.Emplace(zero);
-	visitedPositions.Emplace(zero);
+	outWalk.Emplace(zero);
+	visitedPositions.Add(zero);
 
 	for (int i = 0; i < mapSize; i++) {
-		feasibleDeltas.Empty();
+		feasibleDeltas.Reset();
 		for (auto& delta : deltas) {
-			auto potential = FCoordinate2D(delta.X + result.Last().X, delta.Y + result.Last().Y);
+			auto potential = FCoordinate2D(delta.X + outWalk.Last().X, delta.Y + outWalk.Last().Y);
 			if (!visitedPositions.Contains(potential)) {
 				feasibleDeltas.Emplace(potential);
 			}
@@ -40,116 +77,218 @@ TArray<FCoordinate2D> URandomWalkLibrary::ShortWalk(int32 mapSize, const FRandom
 		}
 
 		auto next = feasibleDeltas[stream.RandRange(0, feasibleDeltas.Num() - 1)];
-		visitedPositions.Emplace(next);
-		result.Emplace(next);
+		visitedPositions.Add(next);
+		outWalk.Emplace(next);
 	}
+}
 
+TArray<FCoordinate2D> URandomWalkLibrary::DimerizationWalk(int32 mapSize, const FRandomStream& stream)
+{
+	FMapGenContext context;
+	TArray<FCoordinate2D> result;
+	DimerizationWalk(mapSize, stream, context, result);
 	return result;
 }
 
-TArray<FCoordinate2D> URandomWalkLibrary::DimerizationWalk(int32 mapSize, const FRandomStream& stream)
+void URandomWalkLibrary::DimerizationWalk(int32 mapSize, const FRandomStream& stream, FMapGenContext& context, TArray<FCoordinate2D>& outWalk)
 {
+	DimerizationWalkAtDepth(mapSize, stream, context, 0, outWalk);
+}
+
+void URandomWalkLibrary::DimerizationWalkAtDepth(int32 mapSize, const FRandomStream& stream, FMapGenContext& context, int32 depth, TArray<FCoordinate2D>& outWalk)
+{
+	MAPGEN_SCOPE(DimerizationWalk);
+
 	if (mapSize <= 3) {
-		return ShortWalk(mapSize, stream);
+		ShortWalk(mapSize, stream, context, outWalk);
+		return;
+	}
+
+	// Each recursion level gets its own pair of buffers, the levels below are still using theirs
+	auto& pathOne = context.GetWalkBuffer(depth, 0);
+	auto& pathTwo = context.GetWalkBuffer(depth, 1);
+
+	outWalk.Reset();
+
+	auto attempts = 0;
+	while (!IsSelfAvoiding(outWalk, mapSize, context.Visited)) {
+		if (attempts++ > 0) {
+			MAPGEN_COUNTER_ADD(WalkRetries, 1);
+		}
+
+		DimerizationWalkAtDepth(mapSize / 2, stream, context, depth + 1, pathOne);
+		DimerizationWalkAtDepth(mapSize - mapSize / 2, stream, context, depth + 1, pathTwo);
+
+		// Append rather than assign, so outWalk keeps its allocation
+		outWalk.Reset();
+		outWalk.Append(pathOne);
+		for (int32 i = 1; i < pathTwo.Num(); i++) {
+			outWalk.Emplace(pathTwo[i].X + pathOne.Last().X, pathTwo[i].Y + pathOne.Last().Y);
+		}
+	}
+}
+
+// Applies one of the 7 non-identity symmetries of the square lattice to an offset
+static FCoordinate2D ApplyLatticeSymmetry(const FCoordinate2D& offset, int32 symmetry)
+{
+	switch (symmetry) {
+	case 0: return FCoordinate2D(-offset.Y, offset.X);  // rotate 90
+	case 1: return FCoordinate2D(-offset.X, -offset.Y); // rotate 180
+	case 2: return FCoordinate2D(offset.Y, -offset.X);  // rotate 270
+	case 3: return FCoordinate2D(offset.X, -offset.Y);  // mirror across X
+	case 4: return FCoordinate2D(-offset.X, offset.Y);  // mirror across Y
+	case 5: return FCoordinate2D(offset.Y, offset.X);   // mirror across diagonal
+	default: return FCoordinate2D(-offset.Y, -offset.X); // mirror across anti-diagonal
+	}
+}
+
+TArray<FCoordinate2D> URandomWalkLibrary::PivotWalk(int32 mapSize, const FRandomStream& stream, int32 pivotAttemptsPerStep)
+{
+	FMapGenContext context;
+	TArray<FCoordinate2D> result;
+	PivotWalk(mapSize, stream, context, result, pivotAttemptsPerStep);
+	return result;
+}
+
+void URandomWalkLibrary::PivotWalk(int32 mapSize, const FRandomStream& stream, FMapGenContext& context, TArray<FCoordinate2D>& outWalk, int32 pivotAttemptsPerStep)
+{
+	MAPGEN_SCOPE(PivotWalk);
+
+	auto& result = outWalk;
+	mapSize = FMath::Max(mapSize, 0);
+	result.Reset();
+	result.Reserve(mapSize + 1);
+
+	// Occupancy of the whole walk, mapping tile -> index in the walk, kept up to date after every accepted pivot
+	auto& occupied = context.Occupied;
+	occupied.Reset();
+	occupied.Reserve(mapSize + 1);
+	for (int32 i = 0; i <= mapSize; i++) {
+		result.Emplace(i, 0);
+		occupied.Add(result[i], i);
+	}
+
+	if (mapSize < 2) {
+		return;
 	}
 
-	auto result = TArray<FCoordinate2D>();
+	auto& moved = context.Moved;
+	moved.Reset();
+	moved.Reserve(mapSize + 1);
+
+	const auto attempts = mapSize * FMath::Max(pivotAttemptsPerStep, 1);
+	auto rejected = 0;
+	for (int32 attempt = 0; attempt < attempts; attempt++) {
+		const auto pivot = stream.RandRange(1, mapSize - 1);
+		const auto symmetry = stream.RandRange(0, 6);
+		auto& pivotTile = result[pivot];
+
+		// Rotating either side gives the same shape (up to a symmetry), so always move the shorter one
+		const bool bMoveTail = pivot >= mapSize / 2;
+		const auto first = bMoveTail ? pivot + 1 : 0;
+		const auto last = bMoveTail ? mapSize : pivot - 1;
+
+		moved.Reset();
+		bool bSelfAvoiding = true;
+		for (int32 i = first; i <= last; i++) {
+			auto offset = ApplyLatticeSymmetry(FCoordinate2D(result[i].X - pivotTile.X, result[i].Y - pivotTile.Y), symmetry);
+			auto next = FCoordinate2D(pivotTile.X + offset.X, pivotTile.Y + offset.Y);
+
+			// Only tiles that stay put can block us; anything on the moving side is being vacated
+			auto owner = occupied.Find(next);
+			if (owner && (*owner < first || *owner > last)) {
+				bSelfAvoiding = false;
+				break;
+			}
+			moved.Emplace(next);
+		}
 
-	while (!IsSelfAvoiding(result, mapSize)) {
-		auto pathOne = DimerizationWalk(mapSize / 2, stream);
-		auto pathTwo = DimerizationWalk(mapSize - mapSize / 2, stream);
+		if (!bSelfAvoiding) {
+			rejected++;
+			continue;
+		}
 
-		for (auto& node : pathTwo) {
-			node += pathOne.Last();
+		for (int32 i = first; i <= last; i++) {
+			occupied.Remove(result[i]);
+		}
+		for (int32 i = first; i <= last; i++) {
+			result[i] = moved[i - first];
+			occupied.Add(result[i], i);
 		}
-		pathTwo.RemoveAt(0);
-		pathOne.Append(pathTwo);
+	}
 
-		result = pathOne;
+	MAPGEN_COUNTER_ADD(WalkRetries, rejected);
+
+	// Walks always start at the origin
+	auto origin = result[0];
+	for (auto& node : result) {
+		node = FCoordinate2D(node.X - origin.X, node.Y - origin.Y);
 	}
+}
 
+TArray<FCoordinate2D> URandomWalkLibrary::SelfAvoidingWalk(int32 mapSize, const FRandomStream& stream)
+{
+	FMapGenContext context;
+	TArray<FCoordinate2D> result;
+	SelfAvoidingWalk(mapSize, stream, context, result);
 	return result;
 }
 
+void URandomWalkLibrary::SelfAvoidingWalk(int32 mapSize, const FRandomStream& stream, FMapGenContext& context, TArray<FCoordinate2D>& outWalk)
+{
+	if (mapSize <= PIVOT_WALK_THRESHOLD) {
+		DimerizationWalk(mapSize, stream, context, outWalk);
+	}
+	else {
+		PivotWalk(mapSize, stream, context, outWalk);
+	}
+}
+
 /// <summary>
-/// Find a random path through a Hex-based grid using Dijkstra's Pathfinding Algorithm. This is achieved by assigning random weights to all navigable paths and aiming for a minimal length path
+/// Find a random path through a Hex-based grid using Dijkstra's Pathfinding Algorithm. This is achieved by assigning random weights to all navigable paths and aiming for a minimal length path.
+/// Every tile's weight is rolled once up front (see FHexPathfinder::Initialize), so seeds give different paths than they did when a weight was drawn per relaxation
 /// </summary>
 /// <param name="start"></param>
 /// <param name="end"></param>
 /// <param name="stream"></param>
 /// <param name="dimensions"></param>
-/// <returns></returns>
-TArray<FCoordinate2D> URandomWalkLibrary::DijkstraRandomPath(const FCoordinate2D& start, const FCoordinate2D& end, const FRandomStream& stream, int32 dimensions) {
-	/*TArray<FCoordinate2D> temp;
-	temp.Add(start);
-	temp.Add(end);
-	return temp;*/
-
-	UE_LOG(LogTemp, Log, TEXT("Finding Path from (%d, %d) to (%d, %d)"), start.X, start.Y, end.X, end.Y);
-
-	TArray<FCoordinate2D> frontier;
-	frontier.Add(start);
-	TMap<FCoordinate2D, FCoordinate2D> cameFrom;
-	cameFrom.Add(start, start);
-	TMap<FCoordinate2D, int32> costSoFar;
-	costSoFar.Add(start, 0);
-
-	if (frontier.IsEmpty()) {
-		UE_LOG(LogTemp, Warning, TEXT("Frontier is Empty for some reason!"));
-		return {};
-	}
+/// <param name="bUseHeuristic">Guide the search with an A* heuristic. The path costs the same either way, but where several paths tie on cost the two searches may return different ones</param>
+/// <returns>The path from end back to start</returns>
+TArray<FCoordinate2D> URandomWalkLibrary::DijkstraRandomPath(const FCoordinate2D& start, const FCoordinate2D& end, const FRandomStream& stream, int32 dimensions, bool bUseHeuristic) {
+	FMapGenContext context;
+	TArray<FCoordinate2D> results;
+	DijkstraRandomPath(start, end, stream, context, results, dimensions, bUseHeuristic);
+	return results;
+}
 
-	FCoordinate2D current;
-	while (!frontier.IsEmpty() && frontier[0] != end) {
-		current = frontier[0];
-		frontier.RemoveAt(0);
-		auto neighbors = GetAllNeighbors(current);
-		for (auto& neighbor : neighbors) {
-			// check that neighbor is valid...
-			if (neighbor.X < 0 || neighbor.Y < 0 || neighbor.X >= dimensions || neighbor.Y >= dimensions) {
-				// UE_LOG(LogTemp, Log, TEXT("Invalid Neighbor Checked ({%d},{%d})..."), neighbor.X, neighbor.Y); // Should only really encounter this a few times per chunk
-				continue;
-			}
+bool URandomWalkLibrary::DijkstraRandomPath(const FCoordinate2D& start, const FCoordinate2D& end, const FRandomStream& stream, FMapGenContext& context, TArray<FCoordinate2D>& outPath, int32 dimensions, bool bUseHeuristic)
+{
+	MAPGEN_SCOPE(DijkstraRandomPath);
 
-			auto newCost = costSoFar[current] + stream.RandRange(0, MAX_WEIGHT);
-			if (neighbor.X == 0 || neighbor.X == dimensions - 1 || neighbor.Y == 0 || neighbor.Y == dimensions - 1) {
-				newCost = BORDER_INFINITY;
-			}
+	MAPGEN_VERBOSE_LOG(Log, TEXT("Finding Path from (%d, %d) to (%d, %d)"), start.X, start.Y, end.X, end.Y);
 
-			if (neighbor == end) {
-				newCost = 0;
-			}
+	auto& pathfinder = context.Pathfinder;
+	pathfinder.Initialize(stream, dimensions);
 
-			if (!costSoFar.Contains(neighbor) || newCost < costSoFar[neighbor]) {
-				costSoFar.FindOrAdd(neighbor);
-				costSoFar[neighbor] = newCost;
-				cameFrom.FindOrAdd(neighbor);
-				cameFrom[neighbor] = current;
-				frontier.Add(neighbor);
-			}
-		}
-	}
+	// A path can't be longer than the chunk has tiles, so it never has to grow again after this
+	outPath.Reserve(dimensions * dimensions);
 
-	// Algorithm is complete... lets backtrack...
-	TArray<FCoordinate2D> results;
-	current = end;
-	while (current != start) {
-		if (results.Num() > 64) {
-			UE_LOG(LogTemp, Log, TEXT("Failed to find a path for some reason. Would enchroach infinity"));
-			break;
-		}
-		results.Add(current);
-		current = cameFrom[current];
+	if (!pathfinder.FindPath(start, end, outPath, bUseHeuristic)) {
+		UE_LOG(LogTemp, Warning, TEXT("Failed to find a path from (%d, %d) to (%d, %d)"), start.X, start.Y, end.X, end.Y);
+		return false;
 	}
 
-	results.Add(current);
+	MAPGEN_COUNTER_ADD(NodesExpanded, pathfinder.GetNodesExpanded());
+	MAPGEN_COUNTER_ADD(ChunksBuilt, 1);
 
-	UE_LOG(LogTemp, Log, TEXT("Path for Chunk"));
-	for (auto& tile : results) {
-		UE_LOG(LogTemp, Log, TEXT("\t(%d, %d)"), tile.X, tile.Y);
+#if MAPGEN_VERBOSE_LOGGING
+	MAPGEN_VERBOSE_LOG(Log, TEXT("Path for Chunk"));
+	for (auto& tile : outPath) {
+		MAPGEN_VERBOSE_LOG(Log, TEXT("\t(%d, %d)"), tile.X, tile.Y);
 	}
+#endif
 
-	return results;
+	return true;
 }
 
 TArray<FCoordinate2D> URandomWalkLibrary::GetOutOfBoundsNeighbors(FCoordinate2D tile, int32 dimensions)
@@ -180,192 +319,231 @@ TArray<FCoordinate2D> URandomWalkLibrary::GetOutOfBoundsNeighbors(FCoordinate2D
 }
 
 TArray<FCoordinate2D> GetOddRNeighbors(const FCoordinate2D& tile) {
-	auto isEven = tile.X % 2 == 0;
-
-	if (isEven) { // even rows...
-		return TArray<FCoordinate2D>({
-			{tile.X + 1, tile.Y},
-			{tile.X, tile.Y - 1},
-			{tile.X - 1, tile.Y - 1},
-			{tile.X - 1, tile.Y},
-			{tile.X - 1, tile.Y + 1},
-			{tile.X, tile.Y + 1},
-			});
-
-	}
-
-	return TArray<FCoordinate2D>({
-			{tile.X + 1, tile.Y},
-			{tile.X + 1, tile.Y - 1},
-			{tile.X, tile.Y - 1 },
-			{tile.X - 1, tile.Y},
-			{tile.X, tile.Y + 1},
-			{tile.X + 1, tile.Y + 1}
-		});
+	auto neighbors = GetHexNeighborTiles<FOddRHexLayout>(tile);
+	return TArray<FCoordinate2D>(neighbors.begin(), FHexNeighbors::Num);
 }
 TArray<FCoordinate2D> GetEvenRNeighbors(const FCoordinate2D& tile) {
-	auto isEven = tile.X % 2 == 0;
-
-	if (!isEven) {
-		return TArray<FCoordinate2D>({
-			{tile.X + 1, tile.Y},
-			{tile.X + 1, tile.Y - 1},
-			{tile.X, tile.Y - 1},
-			{tile.X - 1, tile.Y},
-			{tile.X, tile.Y + 1},
-			{tile.X + 1, tile.Y + 1},
-			});
-
-	}
-
-	return TArray<FCoordinate2D>({
-			{tile.X + 1, tile.Y},
-			{tile.X, tile.Y - 1},
-			{tile.X - 1, tile.Y - 1 },
-			{tile.X - 1, tile.Y},
-			{tile.X - 1, tile.Y + 1},
-			{tile.X, tile.Y + 1}
-		});
+	auto neighbors = GetHexNeighborTiles<FEvenRHexLayout>(tile);
+	return TArray<FCoordinate2D>(neighbors.begin(), FHexNeighbors::Num);
 }
 TArray<FCoordinate2D> GetOddQNeighbors(const FCoordinate2D& tile) {
-	auto isEven = tile.X % 2 == 0;
-
-	if (!isEven) {
-		return TArray<FCoordinate2D>({
-			{tile.X + 1, tile.Y},
-			{tile.X + 1, tile.Y - 1},
-			{tile.X, tile.Y - 1},
-			{tile.X - 1, tile.Y - 1},
-			{tile.X - 1, tile.Y},
-			{tile.X, tile.Y + 1},
-			});
-
-	}
-
-	return TArray<FCoordinate2D>({
-			{tile.X + 1, tile.Y + 1},
-			{tile.X + 1, tile.Y},
-			{tile.X, tile.Y - 1 },
-			{tile.X - 1, tile.Y},
-			{tile.X - 1, tile.Y + 1},
-			{tile.X, tile.Y + 1}
-		});
+	auto neighbors = GetHexNeighborTiles<FOddQHexLayout>(tile);
+	return TArray<FCoordinate2D>(neighbors.begin(), FHexNeighbors::Num);
 }
 TArray<FCoordinate2D> GetEvenQNeighbors(const FCoordinate2D& tile) {
-	auto isEven = tile.X % 2 == 0;
-
-	if (!isEven) {
-		return TArray<FCoordinate2D>({
-			{tile.X + 1, tile.Y + 1},
-			{tile.X + 1, tile.Y},
-			{tile.X, tile.Y - 1},
-			{tile.X - 1, tile.Y},
-			{tile.X - 1, tile.Y + 1},
-			{tile.X, tile.Y + 1},
-			});
-
-	}
-
-	return TArray<FCoordinate2D>({
-			{tile.X + 1, tile.Y},
-			{tile.X + 1, tile.Y - 1},
-			{tile.X, tile.Y - 1 },
-			{tile.X - 1, tile.Y - 1},
-			{tile.X - 1, tile.Y},
-			{tile.X, tile.Y + 1}
-		});
+	auto neighbors = GetHexNeighborTiles<FEvenQHexLayout>(tile);
+	return TArray<FCoordinate2D>(neighbors.begin(), FHexNeighbors::Num);
 }
 
 
 TArray<FCoordinate2D> URandomWalkLibrary::GetAllNeighbors(const FCoordinate2D& tile, int32 dimensions)
 {
-	auto parity = tile.Y % 2 == 0; // if even, this will be 0
-
-	if (parity) {
-		return TArray<FCoordinate2D>({
-			{tile.X - 1, tile.Y},
-			{tile.X - 1, tile.Y - 1},
-			{tile.X, tile.Y - 1},
-			{tile.X + 1, tile.Y},
-			{tile.X, tile.Y + 1},
-			{tile.X - 1, tile.Y + 1},
-			});
-
-	}
-
-	return TArray<FCoordinate2D>({
-			{tile.X - 1, tile.Y},
-			{tile.X, tile.Y - 1},
-			{tile.X + 1, tile.Y - 1 },
-			{tile.X + 1, tile.Y},
-			{tile.X + 1, tile.Y + 1},
-			{tile.X, tile.Y + 1}
-		});
+	auto neighbors = GetHexNeighborTiles<FMapHexLayout>(tile);
+	return TArray<FCoordinate2D>(neighbors.begin(), FHexNeighbors::Num);
 }
 
 /// <summary>
-/// Finds a neighboring tile that is in another chunk
+/// Finds a neighboring tile that is in another chunk. Works with anything that has RandRange(min, max), so the chunk
+/// generation can use FChunkRandom while Blueprints keep passing an FRandomStream
 /// </summary>
-/// <param name="node">Global position of the tile we're currently analyzing</param>
-/// <param name="nextChunkCoordinate"></param>
-/// <param name="stream"></param>
-/// <param name="dimensions"></param>
-/// <returns></returns>
-FCoordinate2D URandomWalkLibrary::FindNeighborInNextChunk(const FCoordinate2D& node, const FCoordinate2D& nextChunkCoordinate, const FRandomStream& stream, int32 dimensions)
+template<typename RandomType>
+static FCoordinate2D PickNeighborInNextChunk(const FCoordinate2D& node, const FCoordinate2D& nextChunkCoordinate, const RandomType& random, int32 dimensions)
 {
-	UE_LOG(LogTemp, Log, TEXT("Looking for Neighbors for node (%d, %d) in Chunk (%d, %d)"), node.X, node.Y, nextChunkCoordinate.X, nextChunkCoordinate.Y);
+	MAPGEN_SCOPE(FindNeighborInNextChunk);
+
+	MAPGEN_VERBOSE_LOG(Log, TEXT("Looking for Neighbors for node (%d, %d) in Chunk (%d, %d)"), node.X, node.Y, nextChunkCoordinate.X, nextChunkCoordinate.Y);
 
-	auto neighbors = GetAllNeighbors(node).FilterByPredicate([&](const FCoordinate2D& coord) {
+	TArray<FCoordinate2D, TInlineAllocator<FHexNeighbors::Num>> neighbors;
+	ForEachHexNeighbor<FMapHexLayout>(node, [&](const FCoordinate2D& coord) {
 		// Need to make sure we aren't going to grab a tile corner.
 		// Honestly. corners are unlikely to be an issue any more with the self-avoiding walk...
 
-		return nextChunkCoordinate == UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(coord);
+		if (nextChunkCoordinate == UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(coord, dimensions)) {
+			neighbors.Add(coord);
+		}
 		});
 
+#if MAPGEN_VERBOSE_LOGGING
 	for (auto& neighbor : neighbors) {
-		UE_LOG(LogTemp, Log, TEXT("\tPotential Neighbor (%d, %d)"), neighbor.X, neighbor.Y);
+		MAPGEN_VERBOSE_LOG(Log, TEXT("\tPotential Neighbor (%d, %d)"), neighbor.X, neighbor.Y);
 	}
+#endif
 
 	// get random neighbor..
-	UE_LOG(LogTemp, Log, TEXT("Found %d potential neighbors"), neighbors.Num());
+	MAPGEN_VERBOSE_LOG(Log, TEXT("Found %d potential neighbors"), neighbors.Num());
 
 	if (neighbors.IsEmpty()) {
 		return {};
 	}
 
-	auto result = neighbors[stream.RandRange(0, neighbors.Num() - 1)];
+	auto result = neighbors[random.RandRange(0, neighbors.Num() - 1)];
 
-	UE_LOG(LogTemp, Log, TEXT("\t SELECTED (%d, %d)"), result.X, result.Y);
+	MAPGEN_VERBOSE_LOG(Log, TEXT("\t SELECTED (%d, %d)"), result.X, result.Y);
 
 	return result;
+}
 
+/// <summary>
+/// Finds a neighboring tile that is in another chunk
+/// </summary>
+/// <param name="node">Global position of the tile we're currently analyzing</param>
+/// <param name="nextChunkCoordinate"></param>
+/// <param name="stream"></param>
+/// <param name="dimensions"></param>
+/// <returns></returns>
+FCoordinate2D URandomWalkLibrary::FindNeighborInNextChunk(const FCoordinate2D& node, const FCoordinate2D& nextChunkCoordinate, const FRandomStream& stream, int32 dimensions)
+{
+	return PickNeighborInNextChunk(node, nextChunkCoordinate, stream, dimensions);
 }
 
 TArray<FCoordinate2D> URandomWalkLibrary::GetHexNeighbors(FCoordinate2D start, int32 dimensions)
 {
 	auto neighbors = TArray<FCoordinate2D>();
+	ForEachHexNeighborInBounds<FAxialHexLayout>(start, dimensions, [&](const FCoordinate2D& neighbor) {
+		neighbors.Add(neighbor);
+	});
 
-	if (start.X > 0) {
-		neighbors.Emplace(start.X - 1, start.Y);
-		if (start.Y > 0) {
-			neighbors.Emplace(start.X - 1, start.Y - 1);
-		}
+	return neighbors;
+}
+
+// Picks a random non-corner tile on the chunk edge facing direction
+static FCoordinate2D GetRandomEdgeTile(const FCoordinate2D& direction, const FChunkRandom& random, int32 dimensions)
+{
+	auto along = random.RandRange(1, dimensions - 2);
+
+	if (direction.X != 0) {
+		return FCoordinate2D(direction.X > 0 ? dimensions - 1 : 0, along);
 	}
+	return FCoordinate2D(along, direction.Y > 0 ? dimensions - 1 : 0);
+}
 
-	if (start.X < dimensions - 1) {
-		neighbors.Emplace(start.X + 1, start.Y);
-		if (start.Y < dimensions - 1) {
-			neighbors.Emplace(start.X + 1, start.Y + 1);
-		}
+static FCoordinate2D GetWalkDirection(const TArray<FCoordinate2D>& chunkWalk, int32 fromIndex)
+{
+	if (!chunkWalk.IsValidIndex(fromIndex) || !chunkWalk.IsValidIndex(fromIndex + 1)) {
+		return FCoordinate2D(1, 0);
 	}
+	return FCoordinate2D(chunkWalk[fromIndex + 1].X - chunkWalk[fromIndex].X, chunkWalk[fromIndex + 1].Y - chunkWalk[fromIndex].Y);
+}
+
+/// <summary>
+/// Picks where the road crosses from chunk chunkIndex into chunk chunkIndex + 1. Only depends on the seed and the two chunks
+/// </summary>
+static void GetChunkCrossing(const TArray<FCoordinate2D>& chunkWalk, int32 chunkIndex, int32 seed, int32 dimensions, FCoordinate2D& outExit, FCoordinate2D& outEntry)
+{
+	auto& chunk = chunkWalk[chunkIndex];
+	auto& nextChunk = chunkWalk[chunkIndex + 1];
+	auto random = FChunkRandom(seed, chunk, EChunkRandomPurpose::Crossing);
+
+	outExit = GetRandomEdgeTile(GetWalkDirection(chunkWalk, chunkIndex), random, dimensions);
 
-	if (start.Y > 0) {
-		neighbors.Emplace(start.X, start.Y - 1);
+	auto globalExit = FCoordinate2D(chunk.X * dimensions + outExit.X, chunk.Y * dimensions + outExit.Y);
+	auto globalEntry = PickNeighborInNextChunk(globalExit, nextChunk, random, dimensions);
+	outEntry = FCoordinate2D(globalEntry.X - nextChunk.X * dimensions, globalEntry.Y - nextChunk.Y * dimensions);
+}
+
+/// <summary>
+/// Fills in outPath for chunk chunkIndex of the walk using the given pathfinder. Reuses outPath.Path's allocation
+/// </summary>
+/// <returns>Number of tiles the pathfinder expanded</returns>
+static int32 BuildChunkPath(const TArray<FCoordinate2D>& chunkWalk, int32 chunkIndex, int32 seed, int32 dimensions, FHexPathfinder& pathfinder, FChunkPath& outPath)
+{
+	outPath.ChunkCoordinate = chunkWalk[chunkIndex];
+
+	FCoordinate2D unused;
+	if (chunkIndex > 0) {
+		GetChunkCrossing(chunkWalk, chunkIndex - 1, seed, dimensions, unused, outPath.Entry);
+	}
+	else {
+		// Nothing before the first chunk, so come in on the side opposite to where we leave
+		auto direction = GetWalkDirection(chunkWalk, chunkIndex);
+		direction = FCoordinate2D(-direction.X, -direction.Y);
+		outPath.Entry = GetRandomEdgeTile(direction, FChunkRandom(seed, outPath.ChunkCoordinate, EChunkRandomPurpose::OpenEntry), dimensions);
 	}
 
-	if (start.Y < dimensions - 1) {
-		neighbors.Emplace(start.X, start.Y + 1);
+	if (chunkIndex < chunkWalk.Num() - 1) {
+		GetChunkCrossing(chunkWalk, chunkIndex, seed, dimensions, outPath.Exit, unused);
+	}
+	else {
+		// Nothing after the last chunk, so keep heading the way the walk was going
+		auto direction = GetWalkDirection(chunkWalk, chunkIndex - 1);
+		outPath.Exit = GetRandomEdgeTile(direction, FChunkRandom(seed, outPath.ChunkCoordinate, EChunkRandomPurpose::OpenExit), dimensions);
 	}
 
-	return neighbors;
+	pathfinder.Initialize(FChunkRandom(seed, outPath.ChunkCoordinate, EChunkRandomPurpose::Path), dimensions);
+	if (!pathfinder.FindPath(outPath.Entry, outPath.Exit, outPath.Path)) {
+		UE_LOG(LogTemp, Warning, TEXT("Failed to find a path through chunk (%d, %d)"), outPath.ChunkCoordinate.X, outPath.ChunkCoordinate.Y);
+	}
+
+	return pathfinder.GetNodesExpanded();
+}
+
+FChunkPath URandomWalkLibrary::GenerateChunkPath(const TArray<FCoordinate2D>& chunkWalk, int32 chunkIndex, int32 seed, int32 dimensions, int32* outNodesExpanded)
+{
+	FChunkPath result;
+	if (!chunkWalk.IsValidIndex(chunkIndex)) {
+		return result;
+	}
+
+	FHexPathfinder pathfinder;
+	const auto nodesExpanded = BuildChunkPath(chunkWalk, chunkIndex, seed, dimensions, pathfinder, result);
+
+	if (outNodesExpanded) {
+		*outNodesExpanded = nodesExpanded;
+	}
+
+	return result;
+}
+
+TArray<FChunkPath> URandomWalkLibrary::GenerateChunkPaths(const TArray<FCoordinate2D>& chunkWalk, int32 seed, int32 dimensions)
+{
+	return GenerateChunkPaths(chunkWalk, seed, dimensions, false);
+}
+
+TArray<FChunkPath> URandomWalkLibrary::GenerateChunkPaths(const TArray<FCoordinate2D>& chunkWalk, int32 seed, int32 dimensions, bool bSingleThreaded)
+{
+	MAPGEN_SCOPE(GenerateChunkPaths);
+
+	TArray<FChunkPath> results;
+	results.SetNum(chunkWalk.Num());
+
+	// Summed on the calling thread afterwards so the counters are only touched from one place
+	TArray<int32> nodesExpanded;
+	nodesExpanded.SetNumZeroed(chunkWalk.Num());
+
+	ParallelFor(chunkWalk.Num(), [&](int32 chunkIndex) {
+		results[chunkIndex] = GenerateChunkPath(chunkWalk, chunkIndex, seed, dimensions, &nodesExpanded[chunkIndex]);
+	}, bSingleThreaded ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	auto totalNodesExpanded = 0;
+	for (auto count : nodesExpanded) {
+		totalNodesExpanded += count;
+	}
+	MAPGEN_COUNTER_ADD(NodesExpanded, totalNodesExpanded);
+	MAPGEN_COUNTER_ADD(ChunksBuilt, chunkWalk.Num());
+
+	return results;
+}
+
+void URandomWalkLibrary::GenerateChunkPaths(const TArray<FCoordinate2D>& chunkWalk, int32 seed, FMapGenContext& context, TArray<FChunkPath>& outPaths, int32 dimensions)
+{
+	MAPGEN_SCOPE(GenerateChunkPaths);
+
+	// SetNum keeps the chunks (and their Path allocations) that are already there
+	outPaths.SetNum(chunkWalk.Num(), false);
+
+	auto totalNodesExpanded = 0;
+	for (int32 chunkIndex = 0; chunkIndex < chunkWalk.Num(); chunkIndex++) {
+		// A path can't be longer than the chunk has tiles, so it never has to grow again after this
+		outPaths[chunkIndex].Path.Reserve(dimensions * dimensions);
+		totalNodesExpanded += BuildChunkPath(chunkWalk, chunkIndex, seed, dimensions, context.Pathfinder, outPaths[chunkIndex]);
+	}
+	MAPGEN_COUNTER_ADD(NodesExpanded, totalNodesExpanded);
+	MAPGEN_COUNTER_ADD(ChunksBuilt, chunkWalk.Num());
+}
+
+void URandomWalkLibrary::ResetMapGenCounters()
+{
+	MAPGEN_COUNTER_RESET(NodesExpanded);
+	MAPGEN_COUNTER_RESET(WalkRetries);
+	MAPGEN_COUNTER_RESET(ChunksBuilt);
 }
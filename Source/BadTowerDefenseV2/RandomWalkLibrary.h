@@ -3,11 +3,14 @@
 #pragma once
 
 #include "FCoordinate2D.h"
+#include "FChunkPath.h"
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "RandomWalkLibrary.generated.h"
 
+class FMapGenContext;
+class FCoordinateSet;
 
 /**
  *
@@ -19,16 +22,33 @@ class BADTOWERDEFENSEV2_API URandomWalkLibrary : public UBlueprintFunctionLibrar
 
 
 	UFUNCTION()
-	static bool IsSelfAvoiding(TArray<FCoordinate2D> walk, int32 mapSize);
+	static bool IsSelfAvoiding(const TArray<FCoordinate2D>& walk, int32 mapSize);
 
 	UFUNCTION()
 	static TArray<FCoordinate2D> ShortWalk(int32 mapSize, const FRandomStream & stream);
 
+	static bool IsSelfAvoiding(const TArray<FCoordinate2D>& walk, int32 mapSize, FCoordinateSet& visited);
+	static void ShortWalk(int32 mapSize, const FRandomStream& stream, FMapGenContext& context, TArray<FCoordinate2D>& outWalk);
+	static void DimerizationWalkAtDepth(int32 mapSize, const FRandomStream& stream, FMapGenContext& context, int32 depth, TArray<FCoordinate2D>& outWalk);
+
+public:
 	UFUNCTION(BlueprintCallable)
 	static TArray<FCoordinate2D> DimerizationWalk(int32 mapSize, const FRandomStream& stream);
 
+	/**
+	 * Self-avoiding walk using the pivot algorithm: starts from a straight line and applies a fixed number of
+	 * random rotations/reflections around random points, keeping the ones that stay self-avoiding.
+	 * Runtime is bounded by pivotAttemptsPerStep * mapSize attempts, so it stays usable for mapSize in the thousands.
+	 */
+	UFUNCTION(BlueprintCallable)
+	static TArray<FCoordinate2D> PivotWalk(int32 mapSize, const FRandomStream& stream, int32 pivotAttemptsPerStep = 2);
+
+	/** Picks DimerizationWalk for short maps and PivotWalk for long ones */
 	UFUNCTION(BlueprintCallable)
-	static TArray<FCoordinate2D> DijkstraRandomPath(const FCoordinate2D& start, const FCoordinate2D& end, const FRandomStream& stream, int32 dimensions = 8);
+	static TArray<FCoordinate2D> SelfAvoidingWalk(int32 mapSize, const FRandomStream& stream);
+
+	UFUNCTION(BlueprintCallable)
+	static TArray<FCoordinate2D> DijkstraRandomPath(const FCoordinate2D& start, const FCoordinate2D& end, const FRandomStream& stream, int32 dimensions = 8, bool bUseHeuristic = true);
 
 	UFUNCTION(BlueprintCallable, BlueprintPure)
 	static TArray<FCoordinate2D> GetOutOfBoundsNeighbors(FCoordinate2D tile, int32 dimensions = 8);
@@ -39,6 +59,40 @@ class BADTOWERDEFENSEV2_API URandomWalkLibrary : public UBlueprintFunctionLibrar
 	UFUNCTION(BlueprintCallable, BlueprintPure)
 	static FCoordinate2D FindNeighborInNextChunk(const FCoordinate2D& node, const FCoordinate2D& nextChunkCoordinate, const FRandomStream& stream, int32 dimensions = 8);
 
+	/**
+	 * Generates the road through every chunk of a chunk walk (e.g. from DimerizationWalk) in parallel.
+	 * Every random decision for a chunk comes from an FChunkRandom keyed by the seed and the chunk's coordinate,
+	 * so the output doesn't depend on the number of worker threads or the order chunks are processed in.
+	 */
+	UFUNCTION(BlueprintCallable)
+	static TArray<FChunkPath> GenerateChunkPaths(const TArray<FCoordinate2D>& chunkWalk, int32 seed, int32 dimensions = 8);
+
+	/** Same as above. bSingleThreaded builds every chunk on the calling thread, e.g. to compare against the parallel run or count allocations */
+	static TArray<FChunkPath> GenerateChunkPaths(const TArray<FCoordinate2D>& chunkWalk, int32 seed, int32 dimensions, bool bSingleThreaded);
+
+	/**
+	 * Generates the road through a single chunk of the walk. Same result as the matching entry of GenerateChunkPaths.
+	 * Chunk files rely on it building the same road for a seed, bump ChunkFile::GENERATOR_VERSION when that changes
+	 */
+	static FChunkPath GenerateChunkPath(const TArray<FCoordinate2D>& chunkWalk, int32 chunkIndex, int32 seed, int32 dimensions = 8, int32* outNodesExpanded = nullptr);
+
+	/**
+	 * The overloads taking an FMapGenContext produce the same results as the ones above, but write into an output
+	 * array and keep all of their scratch space in the context. Once warmed up, calling them again with the same
+	 * context and sizes doesn't allocate.
+	 */
+	static void DimerizationWalk(int32 mapSize, const FRandomStream& stream, FMapGenContext& context, TArray<FCoordinate2D>& outWalk);
+	static void PivotWalk(int32 mapSize, const FRandomStream& stream, FMapGenContext& context, TArray<FCoordinate2D>& outWalk, int32 pivotAttemptsPerStep = 2);
+	static void SelfAvoidingWalk(int32 mapSize, const FRandomStream& stream, FMapGenContext& context, TArray<FCoordinate2D>& outWalk);
+	static bool DijkstraRandomPath(const FCoordinate2D& start, const FCoordinate2D& end, const FRandomStream& stream, FMapGenContext& context, TArray<FCoordinate2D>& outPath, int32 dimensions = 8, bool bUseHeuristic = true);
+
+	/** Runs on the calling thread, and reuses the Path arrays already in outPaths */
+	static void GenerateChunkPaths(const TArray<FCoordinate2D>& chunkWalk, int32 seed, FMapGenContext& context, TArray<FChunkPath>& outPaths, int32 dimensions = 8);
+
+	/** Clears the per-generation counters (nodes expanded, walk retries, chunks built) shown in `stat MapGen` and Insights */
+	UFUNCTION(BlueprintCallable)
+	static void ResetMapGenCounters();
+
 
 private:
 	UFUNCTION()
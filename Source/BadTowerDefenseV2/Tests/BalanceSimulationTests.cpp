@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BalanceSimulation.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Steps the balance simulation is run at, the first one is what the others are compared against
+static const float BALANCE_TEST_TIME_STEPS[] = { 1.f / 120.f, 1.f / 60.f, 1.f / 30.f, 1.f / 10.f };
+
+/// <summary>
+/// A map without towers where every enemy walks the whole road, so how long a wave takes only depends on how fast they walk
+/// </summary>
+static FBalanceSimConfig MakeWalkOnlyConfig(float timeStep)
+{
+	FBalanceSimConfig config;
+	config.TimeStep = timeStep;
+	config.HeadquartersHealth = 1000;
+
+	FEnemyUnitStats grunt;
+	grunt.Speed = 150.f;
+	config.Enemies.Add(TEXT("Grunt"), grunt);
+
+	FEnemyUnitStats runner;
+	runner.Speed = 330.f;
+	config.Enemies.Add(TEXT("Runner"), runner);
+
+	config.Layouts.AddDefaulted();
+
+	auto& wave = config.Waves.AddDefaulted_GetRef();
+	auto& grunts = wave.Groups.AddDefaulted_GetRef();
+	grunts.Enemy = TEXT("Grunt");
+	grunts.Count = 5;
+	grunts.Interval = 0.7f;
+	auto& runners = wave.Groups.AddDefaulted_GetRef();
+	runners.Enemy = TEXT("Runner");
+	runners.Count = 5;
+	runners.Delay = 2.f;
+	runners.Interval = 0.3f;
+	return config;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBalanceSimTimeStepTest, "BadTowerDefense.Balance.ResultsDontDependOnTimeStep", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBalanceSimTimeStepTest::RunTest(const FString& Parameters)
+{
+	for (int32 seed = 0; seed < 5; seed++) {
+		FBalanceRunParams params;
+		params.Seed = seed;
+		params.LayoutIndex = 0;
+
+		TArray<FBalanceWaveResult> reference;
+		const auto referenceConfig = MakeWalkOnlyConfig(BALANCE_TEST_TIME_STEPS[0]);
+		FBalanceSimulation(referenceConfig).Run(params, reference);
+		if (!TestEqual(FString::Printf(TEXT("seed %d plays the wave"), seed), reference.Num(), 1)) {
+			continue;
+		}
+		TestEqual(FString::Printf(TEXT("seed %d leaks every enemy"), seed), reference[0].Leaked, reference[0].Spawned);
+
+		for (auto timeStep : BALANCE_TEST_TIME_STEPS) {
+			const auto testCase = FString::Printf(TEXT("seed %d, time step %.4f"), seed, timeStep);
+			const auto config = MakeWalkOnlyConfig(timeStep);
+
+			TArray<FBalanceWaveResult> waves;
+			FBalanceSimulation(config).Run(params, waves);
+			if (!TestEqual(testCase + TEXT(" plays the wave"), waves.Num(), 1)) {
+				continue;
+			}
+
+			TestEqual(testCase + TEXT(" spawns the same enemies"), waves[0].Spawned, reference[0].Spawned);
+			TestEqual(testCase + TEXT(" leaks the same enemies"), waves[0].Leaked, reference[0].Leaked);
+			TestFalse(testCase + TEXT(" doesn't time out"), waves[0].bTimedOut);
+
+			// Spawns and arrivals are only seen at the end of a step, so the wave can end up to a step late on either side
+			const auto tolerance = 2.f * (timeStep + BALANCE_TEST_TIME_STEPS[0]);
+			TestTrue(testCase + FString::Printf(TEXT(" takes %.3fs, as long as at the smallest step (%.3fs)"), waves[0].SimulatedSeconds, reference[0].SimulatedSeconds),
+				FMath::Abs(waves[0].SimulatedSeconds - reference[0].SimulatedSeconds) <= tolerance);
+		}
+	}
+	return true;
+}
+
+#endif
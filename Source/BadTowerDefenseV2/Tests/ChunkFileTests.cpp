@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChunkFile.h"
+#include "RandomWalkLibrary.h"
+#include "FChunkPath.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/// <summary>
+/// Some tile type for every tile of a chunk, so every bit of every plane gets set somewhere
+/// </summary>
+static TArray<EHexTileType> MakeChunkFileTestTileTypes(int32 chunkIndex, int32 dimensions)
+{
+	TArray<EHexTileType> tileTypes;
+	for (int32 i = 0; i < dimensions * dimensions; i++) {
+		tileTypes.Add(static_cast<EHexTileType>((i + chunkIndex) % static_cast<int32>(EHexTileType::MAX)));
+	}
+	return tileTypes;
+}
+
+/// <summary>
+/// A finished chunk file for seed. Even chunks get MakeChunkFileTestTileTypes, odd ones the writer's road and land
+/// </summary>
+static TArray<uint8> MakeChunkFileTestFile(int32 seed, int32 dimensions, TArray<FChunkPath>& outChunkPaths)
+{
+	const auto walk = URandomWalkLibrary::DimerizationWalk(8, FRandomStream(seed));
+	outChunkPaths = URandomWalkLibrary::GenerateChunkPaths(walk, seed, dimensions);
+
+	TArray<FCoordinate2D> chunkWalk;
+	for (auto& chunkPath : outChunkPaths) {
+		chunkWalk.Add(chunkPath.ChunkCoordinate);
+	}
+
+	FChunkFileWriter writer(chunkWalk, seed, dimensions);
+	for (int32 i = 0; i < outChunkPaths.Num(); i++) {
+		if (i % 2 == 0) {
+			writer.AddChunk(outChunkPaths[i], MakeChunkFileTestTileTypes(i, dimensions));
+		}
+		else {
+			writer.AddChunk(outChunkPaths[i]);
+		}
+	}
+	return writer.Finish();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChunkFileRoundTripTest, "BadTowerDefense.ChunkFile.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FChunkFileRoundTripTest::RunTest(const FString& Parameters)
+{
+	// 8 fits a tile plane in one word, 12 needs several
+	for (auto dimensions : { 8, 12 }) {
+		for (int32 seed = 0; seed < 5; seed++) {
+			const auto testCase = FString::Printf(TEXT("dimensions %d, seed %d"), dimensions, seed);
+
+			TArray<FChunkPath> chunkPaths;
+			const auto bytes = MakeChunkFileTestFile(seed, dimensions, chunkPaths);
+
+			FChunkFileView view;
+			if (!TestTrue(testCase + TEXT(" reads back"), view.Initialize(bytes))) {
+				continue;
+			}
+			TestEqual(testCase + TEXT(" has every chunk"), view.GetNumChunks(), chunkPaths.Num());
+			TestEqual(testCase + TEXT(" keeps the dimensions"), view.GetDimensions(), dimensions);
+			TestEqual(testCase + TEXT(" keeps the seed"), view.GetSeed(), seed);
+			TestEqual(testCase + TEXT(" records the generator"), view.GetGeneratorVersion(), ChunkFile::GENERATOR_VERSION);
+			TestTrue(testCase + TEXT(" can regenerate chunks"), view.CanRegenerateChunks());
+
+			TArray<FCoordinate2D> walk;
+			view.ReadChunkWalk(walk);
+			TestEqual(testCase + TEXT(" keeps the walk"), walk.Num(), chunkPaths.Num());
+
+			FChunkPath readPath;
+			TArray<EHexTileType> tileTypes;
+			for (int32 i = 0; i < FMath::Min(walk.Num(), chunkPaths.Num()); i++) {
+				const auto chunkCase = testCase + FString::Printf(TEXT(", chunk %d"), i);
+				auto& chunkPath = chunkPaths[i];
+
+				TestEqual(chunkCase + TEXT(" keeps its coordinate"), walk[i], chunkPath.ChunkCoordinate);
+				TestEqual(chunkCase + TEXT(" keeps its entry"), view.GetEntry(i), chunkPath.Entry);
+				TestEqual(chunkCase + TEXT(" keeps its exit"), view.GetExit(i), chunkPath.Exit);
+				TestEqual(chunkCase + TEXT(" keeps its path length"), view.GetPathLength(i), chunkPath.Path.Num());
+				if (view.GetPathLength(i) == chunkPath.Path.Num()) {
+					for (int32 j = 0; j < chunkPath.Path.Num(); j++) {
+						TestEqual(chunkCase + TEXT(" keeps its path tiles"), view.GetPathTile(i, j), chunkPath.Path[j]);
+					}
+				}
+
+				if (TestTrue(chunkCase + TEXT(" path reads back"), view.ReadChunkPath(i, readPath))) {
+					TestEqual(chunkCase + TEXT(" path reads back the same"), readPath.ChunkCoordinate, chunkPath.ChunkCoordinate);
+					TestTrue(chunkCase + TEXT(" path reads back the same"), readPath.Entry == chunkPath.Entry && readPath.Exit == chunkPath.Exit && readPath.Path == chunkPath.Path);
+				}
+
+				// Odd chunks were written without tile types: road on the path, land everywhere else
+				auto expectedTileTypes = MakeChunkFileTestTileTypes(i, dimensions);
+				if (i % 2 != 0) {
+					for (auto& tileType : expectedTileTypes) {
+						tileType = EHexTileType::Land;
+					}
+					for (auto& tile : chunkPath.Path) {
+						expectedTileTypes[tile.X * dimensions + tile.Y] = EHexTileType::Road;
+					}
+				}
+
+				view.ReadTileTypes(i, tileTypes);
+				TestTrue(chunkCase + TEXT(" keeps its tile types"), tileTypes == expectedTileTypes);
+				for (int32 x = 0; x < dimensions; x++) {
+					for (int32 y = 0; y < dimensions; y++) {
+						TestTrue(chunkCase + FString::Printf(TEXT(" keeps the tile type of (%d, %d)"), x, y), view.GetTileType(i, FCoordinate2D(x, y)) == expectedTileTypes[x * dimensions + y]);
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChunkFileRejectsBadDataTest, "BadTowerDefense.ChunkFile.RejectsBadData", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FChunkFileRejectsBadDataTest::RunTest(const FString& Parameters)
+{
+	// Initialize warns about everything it rejects
+	AddExpectedError(TEXT("[Cc]hunk file"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	TArray<FChunkPath> chunkPaths;
+	const auto bytes = MakeChunkFileTestFile(1, 8, chunkPaths);
+
+	FChunkFileView view;
+	if (!TestTrue(TEXT("The untouched file reads"), view.Initialize(bytes))) {
+		return true;
+	}
+
+	TestFalse(TEXT("Nothing isn't a chunk file"), view.Initialize({}));
+	TestFalse(TEXT("A failed Initialize leaves the view empty"), view.IsValid());
+	TestFalse(TEXT("Half a header isn't a chunk file"), view.Initialize(MakeArrayView(bytes.GetData(), static_cast<int32>(sizeof(FChunkFileHeader) / 2))));
+	TestFalse(TEXT("A file missing its last byte is truncated"), view.Initialize(MakeArrayView(bytes.GetData(), bytes.Num() - 1)));
+	TestFalse(TEXT("A file missing its paths is truncated"), view.Initialize(MakeArrayView(bytes.GetData(), static_cast<int32>(reinterpret_cast<const FChunkFileHeader*>(bytes.GetData())->PathsOffset))));
+
+	auto withExtraByte = bytes;
+	withExtraByte.Add(0);
+	TestFalse(TEXT("A file with trailing bytes is rejected"), view.Initialize(withExtraByte));
+
+	auto corrupt = [&bytes](TFunctionRef<void(FChunkFileHeader&)> corruptHeader) {
+		auto copy = bytes;
+		corruptHeader(*reinterpret_cast<FChunkFileHeader*>(copy.GetData()));
+		return copy;
+	};
+
+	TestFalse(TEXT("A bad magic is rejected"), view.Initialize(corrupt([](FChunkFileHeader& header) { header.Magic ^= 0xFF; })));
+	TestFalse(TEXT("A newer version is rejected"), view.Initialize(corrupt([](FChunkFileHeader& header) { header.Version = ChunkFile::VERSION + 1; })));
+	TestFalse(TEXT("An older version is rejected"), view.Initialize(corrupt([](FChunkFileHeader& header) { header.Version = ChunkFile::VERSION - 1; })));
+	TestFalse(TEXT("Zero dimensions are rejected"), view.Initialize(corrupt([](FChunkFileHeader& header) { header.Dimensions = 0; })));
+	TestFalse(TEXT("A wrong chunk count is rejected"), view.Initialize(corrupt([](FChunkFileHeader& header) { header.NumChunks++; })));
+	TestFalse(TEXT("A wrong file size is rejected"), view.Initialize(corrupt([](FChunkFileHeader& header) { header.FileSize++; })));
+	TestFalse(TEXT("A moved section is rejected"), view.Initialize(corrupt([](FChunkFileHeader& header) { header.TileGridsOffset += 8; })));
+
+	const auto& layout = *reinterpret_cast<const FChunkFileHeader*>(bytes.GetData());
+	auto badRecord = bytes;
+	reinterpret_cast<FChunkFileRecord*>(badRecord.GetData() + layout.RecordsOffset)->Exit = layout.Dimensions * layout.Dimensions;
+	TestFalse(TEXT("A record pointing outside its chunk is rejected"), view.Initialize(badRecord));
+
+	// Path tiles are only checked when their chunk is read
+	auto badPathTile = bytes;
+	reinterpret_cast<uint16*>(badPathTile.GetData() + layout.PathsOffset)[0] = MAX_uint16;
+	FChunkPath chunkPath;
+	if (TestTrue(TEXT("A corrupt path tile still opens"), view.Initialize(badPathTile))) {
+		TestFalse(TEXT("A corrupt path tile fails its chunk"), view.ReadChunkPath(0, chunkPath));
+		TestTrue(TEXT("A chunk that failed to read has no path"), chunkPath.Path.IsEmpty());
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChunkFileGeneratorVersionTest, "BadTowerDefense.ChunkFile.OnlyCurrentGeneratorRegenerates", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FChunkFileGeneratorVersionTest::RunTest(const FString& Parameters)
+{
+	TArray<FChunkPath> chunkPaths;
+	auto bytes = MakeChunkFileTestFile(2, 8, chunkPaths);
+
+	FChunkFileView view;
+	TestTrue(TEXT("The current generator's file reads"), view.Initialize(bytes));
+	TestTrue(TEXT("The current generator's file can regenerate chunks"), view.CanRegenerateChunks());
+
+	// Another generator's roads still read fine, they just can't be rebuilt
+	for (auto generatorVersion : { ChunkFile::GENERATOR_VERSION - 1, ChunkFile::GENERATOR_VERSION + 1 }) {
+		const auto testCase = FString::Printf(TEXT("Generator version %u"), generatorVersion);
+		reinterpret_cast<FChunkFileHeader*>(bytes.GetData())->GeneratorVersion = generatorVersion;
+
+		if (!TestTrue(testCase + TEXT(" reads"), view.Initialize(bytes))) {
+			continue;
+		}
+		TestEqual(testCase + TEXT(" is reported"), view.GetGeneratorVersion(), generatorVersion);
+		TestFalse(testCase + TEXT(" can't regenerate chunks"), view.CanRegenerateChunks());
+
+		FChunkPath chunkPath;
+		TestTrue(testCase + TEXT(" reads its roads"), view.ReadChunkPath(0, chunkPath) && chunkPath.Path == chunkPaths[0].Path);
+	}
+	return true;
+}
+
+#endif
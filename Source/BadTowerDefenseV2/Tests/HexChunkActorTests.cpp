@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HexChunkActor.h"
+#include "RandomWalkLibrary.h"
+#include "MapUtilitiesLibrary.h"
+#include "FChunkPath.h"
+
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Random tile type changes per chunk, checked every CHUNK_ACTOR_TEST_CHECK_EVERY of them
+constexpr int32 CHUNK_ACTOR_TEST_SWAPS = 200;
+constexpr int32 CHUNK_ACTOR_TEST_CHECK_EVERY = 20;
+
+/// <summary>
+/// Every instance of every tile component has to stand on a tile of that component's type, carry that tile's occupied
+/// flag, and every tile has to have exactly one instance. Instances are matched to tiles by their transform
+/// </summary>
+static void TestChunkActorInstances(FAutomationTestBase& test, const FString& testCase, const AHexChunkActor& actor, int32 dimensions)
+{
+	const auto chunk = actor.GetChunkCoordinate();
+	const auto origin = FCoordinate2D(chunk.X * dimensions, chunk.Y * dimensions);
+	const auto originLocation = UMapUtilitiesLibrary::ConvertGlobalCoordinateToWorldLocation(origin, actor.TileSize);
+
+	TArray<FVector> tileLocations;
+	for (int32 x = 0; x < dimensions; x++) {
+		for (int32 y = 0; y < dimensions; y++) {
+			tileLocations.Add(UMapUtilitiesLibrary::ConvertGlobalCoordinateToWorldLocation(FCoordinate2D(origin.X + x, origin.Y + y), actor.TileSize) - originLocation);
+		}
+	}
+
+	TArray<int32> instancesPerTile;
+	instancesPerTile.Init(0, dimensions * dimensions);
+	for (int32 type = 0; type < static_cast<int32>(EHexTileType::MAX); type++) {
+		const auto tileType = static_cast<EHexTileType>(type);
+		auto component = actor.GetTileComponent(tileType);
+
+		for (int32 instance = 0; instance < component->GetInstanceCount(); instance++) {
+			FTransform transform;
+			component->GetInstanceTransform(instance, transform, false);
+
+			const auto tileIndex = tileLocations.IndexOfByPredicate([&](const FVector& location) {
+				return location.Equals(transform.GetLocation(), 1.f);
+			});
+			if (!test.TestTrue(testCase + TEXT(" has instances only on tiles"), tileIndex != INDEX_NONE)) {
+				continue;
+			}
+
+			const auto tile = FCoordinate2D(tileIndex / dimensions, tileIndex % dimensions);
+			instancesPerTile[tileIndex]++;
+			test.TestTrue(testCase + FString::Printf(TEXT(" has the instance on (%d, %d) in the component of its type"), tile.X, tile.Y), actor.GetTileType(tile) == tileType);
+			test.TestEqual(testCase + FString::Printf(TEXT(" has the occupied flag of (%d, %d) on its instance"), tile.X, tile.Y),
+				component->PerInstanceSMCustomData[instance * component->NumCustomDataFloats] != 0.f, actor.IsTileOccupied(tile));
+		}
+	}
+
+	for (int32 tileIndex = 0; tileIndex < instancesPerTile.Num(); tileIndex++) {
+		test.TestEqual(testCase + FString::Printf(TEXT(" has one instance for tile %d"), tileIndex), instancesPerTile[tileIndex], 1);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexChunkActorTest, "BadTowerDefense.HexChunkActor.BuildAndSwapTiles", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexChunkActorTest::RunTest(const FString& Parameters)
+{
+	// A world of our own, nothing in it but the chunk actors
+	auto world = UWorld::CreateWorld(EWorldType::Game, false);
+	auto& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	worldContext.SetCurrentWorld(world);
+
+	constexpr int32 dimensions = 8;
+	const auto walk = URandomWalkLibrary::DimerizationWalk(4, FRandomStream(7));
+	const auto chunkPaths = URandomWalkLibrary::GenerateChunkPaths(walk, 7, dimensions);
+
+	for (auto& chunkPath : chunkPaths) {
+		const auto testCase = FString::Printf(TEXT("Chunk (%d, %d)"), chunkPath.ChunkCoordinate.X, chunkPath.ChunkCoordinate.Y);
+
+		auto actor = world->SpawnActor<AHexChunkActor>();
+		if (!TestNotNull(testCase + TEXT(" spawns"), actor)) {
+			break;
+		}
+		actor->BuildFromChunkPath(chunkPath, dimensions);
+
+		TInlineComponentArray<UHierarchicalInstancedStaticMeshComponent*> tileComponents(actor);
+		TestEqual(testCase + TEXT(" has a component per tile type"), tileComponents.Num(), static_cast<int32>(EHexTileType::MAX));
+
+		TSet<FCoordinate2D> roadTiles(chunkPath.Path);
+		for (int32 type = 0; type < static_cast<int32>(EHexTileType::MAX); type++) {
+			const auto tileType = static_cast<EHexTileType>(type);
+			const auto expected = tileType == EHexTileType::Road ? roadTiles.Num() : tileType == EHexTileType::Land ? dimensions * dimensions - roadTiles.Num() : 0;
+			TestEqual(testCase + FString::Printf(TEXT(" has the instances of tile type %d"), type), actor->GetTileComponent(tileType)->GetInstanceCount(), expected);
+		}
+		TestChunkActorInstances(*this, testCase + TEXT(" after building"), *actor, dimensions);
+
+		// Every change moves an instance out of one component, which fills the hole with its last instance
+		FRandomStream swaps(chunkPath.ChunkCoordinate.X * 31 + chunkPath.ChunkCoordinate.Y);
+		for (int32 swap = 1; swap <= CHUNK_ACTOR_TEST_SWAPS; swap++) {
+			const auto tile = FCoordinate2D(swaps.RandRange(0, dimensions - 1), swaps.RandRange(0, dimensions - 1));
+			actor->SetTileType(tile, static_cast<EHexTileType>(swaps.RandRange(0, static_cast<int32>(EHexTileType::MAX) - 1)));
+			if (swaps.FRand() < 0.2f) {
+				actor->SetTileOccupied(tile, !actor->IsTileOccupied(tile));
+			}
+
+			if (swap % CHUNK_ACTOR_TEST_CHECK_EVERY == 0) {
+				TestChunkActorInstances(*this, testCase + FString::Printf(TEXT(" after %d changes"), swap), *actor, dimensions);
+			}
+		}
+
+		int32 numInstances = 0;
+		for (int32 type = 0; type < static_cast<int32>(EHexTileType::MAX); type++) {
+			numInstances += actor->GetNumTileInstances(static_cast<EHexTileType>(type));
+		}
+		TestEqual(testCase + TEXT(" still has one instance per tile"), numInstances, dimensions * dimensions);
+
+		actor->ClearTiles();
+		TestEqual(testCase + TEXT(" has no land after clearing"), actor->GetNumTileInstances(EHexTileType::Land), 0);
+		TestEqual(testCase + TEXT(" has no road after clearing"), actor->GetNumTileInstances(EHexTileType::Road), 0);
+	}
+
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+	return true;
+}
+
+#endif
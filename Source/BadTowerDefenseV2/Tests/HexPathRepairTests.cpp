@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HexIncrementalPathfinder.h"
+#include "HexPathfinder.h"
+#include "RandomWalkLibrary.h"
+#include "FChunkPath.h"
+#include "ChunkRandom.h"
+#include "HexLayout.h"
+#include "HexPathTestUtils.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Seeds the repair tests run over, and how many tiles each one blocks or unblocks per chunk
+constexpr int32 PATH_REPAIR_TEST_SEEDS = 10;
+constexpr int32 PATH_REPAIR_TEST_STEPS = 20;
+
+/// <summary>
+/// Plain Dijkstra from scratch over the same costs, with blocked tiles left out. INDEX_NONE if end can't be reached
+/// </summary>
+static int64 GetCheapestCost(const FHexPathfinder& costs, const TArray<bool>& blocked, const FCoordinate2D& start, const FCoordinate2D& end)
+{
+	const auto dimensions = costs.GetDimensions();
+	const auto tileCount = dimensions * dimensions;
+	const auto endIndex = end.X * dimensions + end.Y;
+
+	TArray<int64> costSoFar;
+	costSoFar.Init(TNumericLimits<int64>::Max(), tileCount);
+	TArray<bool> settled;
+	settled.Init(false, tileCount);
+	costSoFar[start.X * dimensions + start.Y] = 0;
+
+	while (true) {
+		auto current = INDEX_NONE;
+		for (int32 i = 0; i < tileCount; i++) {
+			if (!settled[i] && costSoFar[i] != TNumericLimits<int64>::Max() && (current == INDEX_NONE || costSoFar[i] < costSoFar[current])) {
+				current = i;
+			}
+		}
+		if (current == INDEX_NONE) {
+			return INDEX_NONE;
+		}
+		if (current == endIndex) {
+			return costSoFar[current];
+		}
+
+		settled[current] = true;
+		ForEachHexNeighborInBounds<FMapHexLayout>(FCoordinate2D(current / dimensions, current % dimensions), dimensions, [&](const FCoordinate2D& neighbor) {
+			const auto neighborIndex = neighbor.X * dimensions + neighbor.Y;
+			if (!blocked[neighborIndex]) {
+				costSoFar[neighborIndex] = FMath::Min(costSoFar[neighborIndex], costSoFar[current] + costs.GetEnterCost(neighborIndex, endIndex));
+			}
+		});
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHexPathRepairMatchesFullSearchTest, "BadTowerDefense.PathRepair.MatchesFullSearch", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHexPathRepairMatchesFullSearchTest::RunTest(const FString& Parameters)
+{
+	int64 repairs = 0;
+	int64 repairNodesExpanded = 0;
+	int64 fullSearchNodesExpanded = 0;
+
+	for (auto dimensions : { 8, 12 }) {
+		for (int32 seed = 0; seed < PATH_REPAIR_TEST_SEEDS; seed++) {
+			const auto walk = URandomWalkLibrary::DimerizationWalk(8, FRandomStream(seed));
+			const auto chunkPaths = URandomWalkLibrary::GenerateChunkPaths(walk, seed, dimensions);
+
+			for (auto& chunkPath : chunkPaths) {
+				const auto testCase = FString::Printf(TEXT("dimensions %d, seed %d, chunk (%d, %d)"), dimensions, seed, chunkPath.ChunkCoordinate.X, chunkPath.ChunkCoordinate.Y);
+				const auto random = FChunkRandom(seed, chunkPath.ChunkCoordinate, EChunkRandomPurpose::Path);
+
+				FHexPathfinder costs;
+				costs.Initialize(random, dimensions);
+
+				// Nothing blocked, so it has to find a road as cheap as the one FHexPathfinder generated. Not always the
+				// same one, roads along the border tie
+				FHexIncrementalPathfinder pathfinder;
+				pathfinder.Initialize(random, dimensions, chunkPath.Entry, chunkPath.Exit);
+				pathfinder.UpdatePath();
+				if (!TestTrue(testCase + TEXT(" finds a road"), pathfinder.HasPath())) {
+					continue;
+				}
+				TestEqual(testCase + TEXT(" starts out as cheap as the generated road"), GetHexPathCost(costs, pathfinder.GetPath()), GetHexPathCost(costs, chunkPath.Path));
+				TestEqual(testCase + TEXT(" prices the generated road like FHexPathfinder"), pathfinder.GetPathCost(chunkPath.Path), GetHexPathCost(costs, chunkPath.Path));
+
+				TArray<bool> blocked;
+				blocked.Init(false, dimensions * dimensions);
+				FRandomStream steps(seed);
+				for (int32 step = 0; step < PATH_REPAIR_TEST_STEPS; step++) {
+					const auto tile = FCoordinate2D(steps.RandRange(0, dimensions - 1), steps.RandRange(0, dimensions - 1));
+					if (tile == chunkPath.Entry || tile == chunkPath.Exit) {
+						continue;
+					}
+
+					const auto index = tile.X * dimensions + tile.Y;
+					blocked[index] = !blocked[index];
+					pathfinder.SetTileBlocked(tile, blocked[index]);
+					pathfinder.UpdatePath();
+					repairs++;
+					repairNodesExpanded += pathfinder.GetNodesExpanded();
+
+					// The same blocked tiles, searched from scratch
+					FHexIncrementalPathfinder fullSearch;
+					fullSearch.Initialize(random, dimensions, chunkPath.Entry, chunkPath.Exit);
+					for (int32 i = 0; i < blocked.Num(); i++) {
+						if (blocked[i]) {
+							fullSearch.SetTileBlocked(FCoordinate2D(i / dimensions, i % dimensions), true);
+						}
+					}
+					fullSearch.UpdatePath();
+					fullSearchNodesExpanded += fullSearch.GetNodesExpanded();
+
+					const auto stepCase = testCase + FString::Printf(TEXT(", step %d"), step);
+					const auto cheapestCost = GetCheapestCost(costs, blocked, chunkPath.Entry, chunkPath.Exit);
+					if (!TestEqual(stepCase + TEXT(" finds a path exactly when there is one"), pathfinder.HasPath(), cheapestCost != INDEX_NONE) || !pathfinder.HasPath()) {
+						continue;
+					}
+
+					auto& path = pathfinder.GetPath();
+					TestEqual(stepCase + TEXT(" goes from end to start"), path[0], chunkPath.Exit);
+					TestEqual(stepCase + TEXT(" goes from end to start"), path.Last(), chunkPath.Entry);
+					TestEqual(stepCase + TEXT(" costs the same as a full search"), GetHexPathCost(costs, path), cheapestCost);
+					for (auto& pathTile : path) {
+						TestFalse(stepCase + TEXT(" avoids blocked tiles"), blocked[pathTile.X * dimensions + pathTile.Y]);
+					}
+				}
+			}
+		}
+	}
+
+	if (repairs > 0) {
+		AddInfo(FString::Printf(TEXT("%lld repairs expanded %.1f tiles on average, searching from scratch expanded %.1f"),
+			repairs, static_cast<double>(repairNodesExpanded) / repairs, static_cast<double>(fullSearchNodesExpanded) / repairs));
+	}
+	return true;
+}
+
+#endif
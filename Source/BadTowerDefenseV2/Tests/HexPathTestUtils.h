@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "HexPathfinder.h"
+
+#include "CoreMinimal.h"
+
+/** What FHexPathfinder charges for a path written from end back to start. Tests price paths with this rather than with the code they check */
+inline int64 GetHexPathCost(const FHexPathfinder& costs, const TArray<FCoordinate2D>& path)
+{
+	const auto dimensions = costs.GetDimensions();
+	const auto endIndex = path[0].X * dimensions + path[0].Y;
+
+	int64 cost = 0;
+	for (int32 i = 0; i < path.Num() - 1; i++) {
+		cost += costs.GetEnterCost(path[i].X * dimensions + path[i].Y, endIndex);
+	}
+	return cost;
+}
@@ -0,0 +1,330 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RandomWalkLibrary.h"
+#include "MapUtilitiesLibrary.h"
+#include "FChunkPath.h"
+#include "MapGenContext.h"
+#include "MallocCountingProxy.h"
+#include "ChunkRandom.h"
+#include "HexPathfinder.h"
+#include "HexPathTestUtils.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Seeds every determinism test runs over
+constexpr int32 MAPGEN_TEST_SEEDS = 20;
+
+static bool IsSameChunkPaths(const TArray<FChunkPath>& lhs, const TArray<FChunkPath>& rhs)
+{
+	if (lhs.Num() != rhs.Num()) {
+		return false;
+	}
+
+	for (int32 i = 0; i < lhs.Num(); i++) {
+		if (lhs[i].ChunkCoordinate != rhs[i].ChunkCoordinate || lhs[i].Entry != rhs[i].Entry || lhs[i].Exit != rhs[i].Exit || lhs[i].Path != rhs[i].Path) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// mapSize steps between chunks that share an edge, never visiting a chunk twice
+/// </summary>
+static bool IsValidChunkWalk(const TArray<FCoordinate2D>& walk, int32 mapSize)
+{
+	if (walk.Num() != mapSize + 1) {
+		return false;
+	}
+
+	TSet<FCoordinate2D> visited;
+	for (int32 i = 0; i < walk.Num(); i++) {
+		bool bIsAlreadyInSet = false;
+		visited.Add(walk[i], &bIsAlreadyInSet);
+		if (bIsAlreadyInSet) {
+			return false;
+		}
+		if (i > 0 && FMath::Abs(walk[i].X - walk[i - 1].X) + FMath::Abs(walk[i].Y - walk[i - 1].Y) != 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMapGenDimerizationWalkTest, "BadTowerDefense.MapGen.DimerizationWalk", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMapGenDimerizationWalkTest::RunTest(const FString& Parameters)
+{
+	for (auto mapSize : { 4, 16, 64 }) {
+		for (int32 seed = 0; seed < MAPGEN_TEST_SEEDS; seed++) {
+			const auto walk = URandomWalkLibrary::DimerizationWalk(mapSize, FRandomStream(seed));
+			TestTrue(FString::Printf(TEXT("mapSize %d, seed %d is self avoiding"), mapSize, seed), IsValidChunkWalk(walk, mapSize));
+			TestTrue(FString::Printf(TEXT("mapSize %d, seed %d is the same twice"), mapSize, seed), walk == URandomWalkLibrary::DimerizationWalk(mapSize, FRandomStream(seed)));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMapGenPivotWalkTest, "BadTowerDefense.MapGen.PivotWalk", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMapGenPivotWalkTest::RunTest(const FString& Parameters)
+{
+	for (auto mapSize : { 16, 256 }) {
+		for (int32 seed = 0; seed < MAPGEN_TEST_SEEDS; seed++) {
+			const auto walk = URandomWalkLibrary::PivotWalk(mapSize, FRandomStream(seed));
+			TestTrue(FString::Printf(TEXT("mapSize %d, seed %d is self avoiding"), mapSize, seed), IsValidChunkWalk(walk, mapSize));
+			TestTrue(FString::Printf(TEXT("mapSize %d, seed %d is the same twice"), mapSize, seed), walk == URandomWalkLibrary::PivotWalk(mapSize, FRandomStream(seed)));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMapGenDijkstraRandomPathTest, "BadTowerDefense.MapGen.DijkstraRandomPath", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMapGenDijkstraRandomPathTest::RunTest(const FString& Parameters)
+{
+	for (auto dimensions : { 8, 16 }) {
+		for (int32 seed = 0; seed < MAPGEN_TEST_SEEDS; seed++) {
+			FRandomStream endpoints(seed);
+			const auto start = FCoordinate2D(0, endpoints.RandRange(1, dimensions - 2));
+			const auto end = FCoordinate2D(dimensions - 1, endpoints.RandRange(1, dimensions - 2));
+
+			const auto path = URandomWalkLibrary::DijkstraRandomPath(start, end, FRandomStream(seed), dimensions);
+			const auto context = FString::Printf(TEXT("dimensions %d, seed %d"), dimensions, seed);
+			TestTrue(context + TEXT(" is the same twice"), path == URandomWalkLibrary::DijkstraRandomPath(start, end, FRandomStream(seed), dimensions));
+
+			// From end back to start, one neighbor at a time, without leaving the chunk
+			if (!TestTrue(context + TEXT(" found a path"), path.Num() > 0)) {
+				continue;
+			}
+			TestEqual(context + TEXT(" starts at the end"), path[0], end);
+			TestEqual(context + TEXT(" ends at the start"), path.Last(), start);
+			for (int32 i = 1; i < path.Num(); i++) {
+				TestTrue(context + TEXT(" steps to a neighbor"), URandomWalkLibrary::GetAllNeighbors(path[i - 1], dimensions).Contains(path[i]));
+				TestTrue(context + TEXT(" stays in the chunk"), path[i].X >= 0 && path[i].Y >= 0 && path[i].X < dimensions && path[i].Y < dimensions);
+			}
+
+			// A* may pick another of several equally cheap paths, but never a more expensive one
+			FHexPathfinder pathfinder;
+			pathfinder.Initialize(FRandomStream(seed), dimensions);
+			TArray<FCoordinate2D> dijkstraPath;
+			if (TestTrue(context + TEXT(" found a path without the heuristic"), pathfinder.FindPath(start, end, dijkstraPath, false))) {
+				TestEqual(context + TEXT(" costs the same with and without the heuristic"), GetHexPathCost(pathfinder, path), GetHexPathCost(pathfinder, dijkstraPath));
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMapGenGenerateChunkPathsTest, "BadTowerDefense.MapGen.GenerateChunkPaths", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMapGenGenerateChunkPathsTest::RunTest(const FString& Parameters)
+{
+	for (auto dimensions : { 8, 16 }) {
+		for (int32 seed = 0; seed < MAPGEN_TEST_SEEDS; seed++) {
+			const auto walk = URandomWalkLibrary::SelfAvoidingWalk(16, FRandomStream(seed));
+			const auto paths = URandomWalkLibrary::GenerateChunkPaths(walk, seed, dimensions);
+			TestTrue(FString::Printf(TEXT("dimensions %d, seed %d is the same twice"), dimensions, seed), IsSameChunkPaths(paths, URandomWalkLibrary::GenerateChunkPaths(walk, seed, dimensions)));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMapGenGetAllNeighborsTest, "BadTowerDefense.MapGen.GetAllNeighbors", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMapGenGetAllNeighborsTest::RunTest(const FString& Parameters)
+{
+	// Negative coordinates too, odd rows are shifted and the parity of a negative Y is easy to get wrong
+	for (int32 y = -9; y <= 9; y++) {
+		for (int32 x = -9; x <= 9; x++) {
+			const auto tile = FCoordinate2D(x, y);
+			const auto neighbors = URandomWalkLibrary::GetAllNeighbors(tile);
+			const auto context = FString::Printf(TEXT("(%d, %d)"), x, y);
+
+			TestEqual(context + TEXT(" has six neighbors"), neighbors.Num(), 6);
+			for (auto& neighbor : neighbors) {
+				TestEqual(context + TEXT(" neighbor is one step away"), tile.GetHexDistance(neighbor), 1);
+				TestTrue(context + TEXT(" is a neighbor of its neighbor"), URandomWalkLibrary::GetAllNeighbors(neighbor).Contains(tile));
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMapGenCoordinateConversionTest, "BadTowerDefense.MapGen.CoordinateConversions", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMapGenCoordinateConversionTest::RunTest(const FString& Parameters)
+{
+	// 8 takes the power of two fast path, 6 and 12 don't
+	for (auto dimensions : { 6, 8, 12, 16 }) {
+		for (int32 y = -3 * dimensions; y < 3 * dimensions; y++) {
+			for (int32 x = -3 * dimensions; x < 3 * dimensions; x++) {
+				const auto global = FCoordinate2D(x, y);
+				const auto chunk = UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkCoordinate(global, dimensions);
+				const auto local = UMapUtilitiesLibrary::ConvertGlobalCoordinateToChunkLocalCoordinate(global, dimensions);
+				const auto context = FString::Printf(TEXT("dimensions %d, (%d, %d)"), dimensions, x, y);
+
+				TestTrue(context + TEXT(" local is inside the chunk"), local.X >= 0 && local.Y >= 0 && local.X < dimensions && local.Y < dimensions);
+				TestEqual(context + TEXT(" chunk and local add back up"), FCoordinate2D(chunk.X * dimensions + local.X, chunk.Y * dimensions + local.Y), global);
+			}
+		}
+
+		// The two aren't inverses, ConvertIndexToCoordinates comes back with X and Y swapped. Blueprints rely on both
+		// as they are, so this pins them down rather than round tripping
+		for (int32 index = 0; index < dimensions * dimensions; index++) {
+			const auto coordinates = UMapUtilitiesLibrary::ConvertIndexToCoordinates(index, dimensions);
+			const auto context = FString::Printf(TEXT("dimensions %d, index %d"), dimensions, index);
+			TestEqual(context + TEXT(" to coordinates"), coordinates, FCoordinate2D(index % dimensions, index / dimensions));
+			TestEqual(context + TEXT(" back to the transposed index"), UMapUtilitiesLibrary::ConvertCoordinatesToIndex(coordinates.Y, coordinates.X, dimensions), index);
+		}
+	}
+
+	// Tile centers have to come back as the same tile
+	for (int32 y = -20; y <= 20; y++) {
+		for (int32 x = -20; x <= 20; x++) {
+			const auto tile = FCoordinate2D(x, y);
+			const auto location = UMapUtilitiesLibrary::ConvertGlobalCoordinateToWorldLocation(tile, 100.f);
+			TestEqual(FString::Printf(TEXT("(%d, %d) round trips through world space"), x, y), UMapUtilitiesLibrary::ConvertWorldLocationToGlobalCoordinate(location, 100.f), tile);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMapGenContextNoAllocationTest, "BadTowerDefense.MapGen.ContextDoesNotAllocateAfterWarmUp", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMapGenContextNoAllocationTest::RunTest(const FString& Parameters)
+{
+	// Everything with a context overload runs on this thread (GenerateChunkPaths with a context doesn't fan out),
+	// so the thread's allocation count is all of it
+	for (auto mapSize : { 16, 64 }) {
+		for (auto dimensions : { 8, 16 }) {
+			FMapGenContext context;
+			TArray<FCoordinate2D> walk;
+			TArray<FCoordinate2D> dimerizationWalk;
+			TArray<FCoordinate2D> pivotWalk;
+			TArray<FCoordinate2D> path;
+			TArray<FChunkPath> chunkPaths;
+			auto regenerateMap = [&](int32 seed) {
+				URandomWalkLibrary::SelfAvoidingWalk(mapSize, FRandomStream(seed), context, walk);
+				URandomWalkLibrary::DimerizationWalk(mapSize, FRandomStream(seed), context, dimerizationWalk);
+				URandomWalkLibrary::PivotWalk(mapSize, FRandomStream(seed), context, pivotWalk);
+				URandomWalkLibrary::DijkstraRandomPath(FCoordinate2D(0, 1), FCoordinate2D(dimensions - 1, dimensions - 2), FRandomStream(seed), context, path, dimensions);
+				URandomWalkLibrary::GenerateChunkPaths(walk, seed, context, chunkPaths, dimensions);
+			};
+
+			// Warm up on every seed first, so the buffers have grown to the largest any of them needs
+			for (int32 seed = 0; seed < MAPGEN_TEST_SEEDS; seed++) {
+				regenerateMap(seed);
+			}
+
+			for (int32 seed = 0; seed < MAPGEN_TEST_SEEDS; seed++) {
+				uint64 allocations = 0;
+				{
+					FScopedAllocationCounter counter;
+					regenerateMap(seed);
+					allocations = counter.GetAllocations();
+				}
+				const auto testCase = FString::Printf(TEXT("mapSize %d, dimensions %d, seed %d"), mapSize, dimensions, seed);
+				TestEqual(testCase + TEXT(" allocations after warming up"), allocations, uint64(0));
+
+				// Same results as the versions without a context
+				TestTrue(testCase + TEXT(" walk matches"), walk == URandomWalkLibrary::SelfAvoidingWalk(mapSize, FRandomStream(seed)));
+				TestTrue(testCase + TEXT(" chunk paths match"), IsSameChunkPaths(chunkPaths, URandomWalkLibrary::GenerateChunkPaths(walk, seed, dimensions)));
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMapGenChunkPathAnyOrderTest, "BadTowerDefense.MapGen.ChunkPathsDontDependOnOrder", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMapGenChunkPathAnyOrderTest::RunTest(const FString& Parameters)
+{
+	for (auto dimensions : { 8, 16 }) {
+		for (int32 seed = 0; seed < MAPGEN_TEST_SEEDS; seed++) {
+			const auto walk = URandomWalkLibrary::SelfAvoidingWalk(64, FRandomStream(seed));
+			const auto expected = URandomWalkLibrary::GenerateChunkPaths(walk, seed, dimensions, true);
+			const auto testCase = FString::Printf(TEXT("dimensions %d, seed %d"), dimensions, seed);
+
+			TArray<int32> order;
+			for (int32 i = 0; i < walk.Num(); i++) {
+				order.Add(i);
+			}
+			FRandomStream shuffle(seed);
+			for (int32 i = order.Num() - 1; i > 0; i--) {
+				order.Swap(i, shuffle.RandRange(0, i));
+			}
+
+			TArray<FChunkPath> shuffled;
+			shuffled.SetNum(walk.Num());
+			for (auto chunkIndex : order) {
+				shuffled[chunkIndex] = URandomWalkLibrary::GenerateChunkPath(walk, chunkIndex, seed, dimensions);
+			}
+			TestTrue(testCase + TEXT(" shuffled order matches"), IsSameChunkPaths(shuffled, expected));
+
+			TArray<FChunkPath> backwards;
+			backwards.SetNum(walk.Num());
+			for (int32 chunkIndex = walk.Num() - 1; chunkIndex >= 0; chunkIndex--) {
+				backwards[chunkIndex] = URandomWalkLibrary::GenerateChunkPath(walk, chunkIndex, seed, dimensions);
+			}
+			TestTrue(testCase + TEXT(" backwards order matches"), IsSameChunkPaths(backwards, expected));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMapGenChunkPathThreadCountTest, "BadTowerDefense.MapGen.ChunkPathsDontDependOnThreadCount", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMapGenChunkPathThreadCountTest::RunTest(const FString& Parameters)
+{
+	// Long walks so the parallel run actually spreads over the workers
+	for (auto dimensions : { 8, 16 }) {
+		for (int32 seed = 0; seed < MAPGEN_TEST_SEEDS; seed++) {
+			const auto walk = URandomWalkLibrary::SelfAvoidingWalk(256, FRandomStream(seed));
+			const auto singleThreaded = URandomWalkLibrary::GenerateChunkPaths(walk, seed, dimensions, true);
+			const auto parallel = URandomWalkLibrary::GenerateChunkPaths(walk, seed, dimensions, false);
+			TestTrue(FString::Printf(TEXT("dimensions %d, seed %d parallel matches single threaded"), dimensions, seed), IsSameChunkPaths(parallel, singleThreaded));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMapGenChunkRandomTest, "BadTowerDefense.MapGen.ChunkRandomIsKeyed", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMapGenChunkRandomTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 DRAWS = 64;
+
+	for (int32 seed = 0; seed < MAPGEN_TEST_SEEDS; seed++) {
+		const auto chunk = FCoordinate2D(seed - 7, 3 - seed);
+		const auto testCase = FString::Printf(TEXT("seed %d"), seed);
+
+		// Same key, same draws, whether drawn in sequence or by index and in any order
+		const FChunkRandom first(seed, chunk, EChunkRandomPurpose::Path);
+		const FChunkRandom second(seed, chunk, EChunkRandomPurpose::Path);
+		TArray<uint64> draws;
+		for (int32 i = 0; i < DRAWS; i++) {
+			draws.Add(first.GetUInt64());
+		}
+		for (int32 i = DRAWS - 1; i >= 0; i--) {
+			TestEqual(testCase + TEXT(" draw by index matches the sequence"), second.GetUInt64(i), draws[i]);
+		}
+		for (int32 i = 0; i < DRAWS; i++) {
+			TestEqual(testCase + TEXT(" ranged draw matches"), first.RandRange(i, -5, 17), second.RandRange(i, -5, 17));
+		}
+
+		// Changing any part of the key gives another sequence
+		const FChunkRandom otherSeed(seed + 1, chunk, EChunkRandomPurpose::Path);
+		const FChunkRandom otherChunk(seed, FCoordinate2D(chunk.X + 1, chunk.Y), EChunkRandomPurpose::Path);
+		const FChunkRandom otherPurpose(seed, chunk, EChunkRandomPurpose::Crossing);
+		TestTrue(testCase + TEXT(" seed is part of the key"), otherSeed.GetUInt64(0) != draws[0] || otherSeed.GetUInt64(1) != draws[1]);
+		TestTrue(testCase + TEXT(" chunk is part of the key"), otherChunk.GetUInt64(0) != draws[0] || otherChunk.GetUInt64(1) != draws[1]);
+		TestTrue(testCase + TEXT(" purpose is part of the key"), otherPurpose.GetUInt64(0) != draws[0] || otherPurpose.GetUInt64(1) != draws[1]);
+	}
+	return true;
+}
+
+#endif
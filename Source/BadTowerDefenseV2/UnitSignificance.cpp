@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UnitSignificance.h"
+
+float FUnitSignificanceSettings::Score(const FUnitSignificanceInput& input) const
+{
+	const auto cameraRange = FMath::Max(CameraFarDistance - CameraNearDistance, 1.f);
+	auto cameraScore = 1.f - FMath::Clamp((input.CameraDistance - CameraNearDistance) / cameraRange, 0.f, 1.f);
+	if (!input.bVisible) {
+		cameraScore *= OffscreenScale;
+	}
+
+	// Being next to a tower (or an enemy, for a tower) matters for gameplay whether or not anyone is looking
+	auto actionScore = 0.f;
+	if (input.TileDistance >= 0 && input.TileDistance <= ActionRange) {
+		actionScore = 1.f - static_cast<float>(input.TileDistance) / (ActionRange + 1);
+	}
+
+	return FMath::Max(cameraScore, actionScore);
+}
+
+int32 FUnitSignificanceSettings::UpdateTier(int32 currentTier, float score) const
+{
+	const auto lastTier = TierMinScores.Num();
+	auto tier = FMath::Clamp(currentTier, 0, lastTier);
+
+	// Up while the score clears the better tier's threshold by the margin, down while it misses our own by the margin
+	while (tier > 0 && score >= TierMinScores[tier - 1] + Hysteresis) {
+		tier--;
+	}
+	while (tier < lastTier && score < TierMinScores[tier] - Hysteresis) {
+		tier++;
+	}
+	return tier;
+}
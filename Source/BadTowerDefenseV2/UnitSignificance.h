@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UnitSignificance.generated.h"
+
+/** What a unit's significance is scored from, gathered by UUnitSignificanceSubsystem */
+struct FUnitSignificanceInput {
+	// World units from the camera
+	float CameraDistance = 0.f;
+
+	// Enemies: tiles to the nearest tower. Towers: tiles to the nearest enemy. Negative if there's none in range
+	int32 TileDistance = INDEX_NONE;
+
+	// Rendered recently, i.e. on screen
+	bool bVisible = false;
+};
+
+/**
+ * Turns a unit's distance to the camera and to the action into a significance score in [0, 1], and the score into a
+ * tier: 0 is full detail, every tier after that ticks less often.
+ *
+ * Moving between tiers needs the score to clear the tier's threshold by Hysteresis, so a unit hovering around a
+ * threshold doesn't flip between tick rates every update.
+ */
+USTRUCT(BlueprintType)
+struct BADTOWERDEFENSEV2_API FUnitSignificanceSettings {
+	GENERATED_USTRUCT_BODY()
+
+	// Closer than this to the camera counts as fully significant
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float CameraNearDistance = 2000.f;
+
+	// Further than this from the camera adds nothing to the score
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float CameraFarDistance = 10000.f;
+
+	// Camera part of the score is scaled by this while the unit is off screen
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float OffscreenScale = 0.4f;
+
+	// Enemies within this many tiles of a tower (and towers within this many of an enemy) are scored by distance to the action too
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	int32 ActionRange = 6;
+
+	// Lowest score of each tier but the last, best tier first. One more tier than there are entries
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	TArray<float> TierMinScores = { 0.6f, 0.3f, 0.1f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float Hysteresis = 0.05f;
+
+	int32 GetNumTiers() const { return TierMinScores.Num() + 1; }
+
+	float Score(const FUnitSignificanceInput& input) const;
+
+	/** The tier a unit currently in currentTier moves to with score */
+	int32 UpdateTier(int32 currentTier, float score) const;
+};
@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UnitSignificanceSubsystem.h"
+#include "EnemySpatialIndexSubsystem.h"
+#include "HexFlowFieldSubsystem.h"
+#include "HexMath.h"
+#include "MapUtilitiesLibrary.h"
+
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("Significance"), STATGROUP_Significance, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Score Units"), STAT_Significance_Score, STATGROUP_Significance);
+DECLARE_CYCLE_STAT(TEXT("Throttle Behavior Trees"), STAT_Significance_ThrottleBrains, STATGROUP_Significance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Units"), STAT_Significance_Units, STATGROUP_Significance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Units At Full Rate"), STAT_Significance_FullRate, STATGROUP_Significance);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Tier Changes"), STAT_Significance_TierChanges, STATGROUP_Significance);
+
+void UUnitSignificanceSubsystem::Deinitialize()
+{
+	Units.Empty();
+	UnitIndices.Empty();
+	TowerDistances.Empty();
+	Super::Deinitialize();
+}
+
+bool UUnitSignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UUnitSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUnitSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UUnitSignificanceSubsystem::RegisterUnit(AActor* unit, bool bIsTower)
+{
+	if (!unit || UnitIndices.Contains(unit)) {
+		return;
+	}
+
+	UnitIndices.Add(unit, Units.Num());
+	auto& added = Units.AddDefaulted_GetRef();
+	added.Actor = unit;
+	added.bIsTower = bIsTower;
+	RecordTickIntervals(added, unit);
+
+	bTowerDistancesDirty |= bIsTower;
+}
+
+void UUnitSignificanceSubsystem::UnregisterUnit(AActor* unit)
+{
+	auto index = UnitIndices.Find(unit);
+	if (!index) {
+		return;
+	}
+
+	// Back to the intervals it came with, it might be pooled and reused
+	auto& removed = Units[*index];
+	removed.Tier = 0;
+	ApplyTier(removed);
+
+	RemoveUnitAt(*index);
+}
+
+void UUnitSignificanceSubsystem::RemoveUnitAt(int32 index)
+{
+	UnitIndices.Remove(Units[index].Actor);
+	bTowerDistancesDirty |= Units[index].bIsTower;
+
+	Units.RemoveAtSwap(index, 1, false);
+	if (Units.IsValidIndex(index)) {
+		UnitIndices[Units[index].Actor] = index;
+	}
+}
+
+int32 UUnitSignificanceSubsystem::GetUnitTier(AActor* unit) const
+{
+	auto index = UnitIndices.Find(unit);
+	return index ? Units[*index].Tier : INDEX_NONE;
+}
+
+int32 UUnitSignificanceSubsystem::GetNumUnitsInTier(int32 tier) const
+{
+	int32 count = 0;
+	for (auto& unit : Units) {
+		count += unit.Tier == tier;
+	}
+	return count;
+}
+
+float UUnitSignificanceSubsystem::GetTierTickInterval(int32 tier) const
+{
+	if (TierTickIntervals.IsEmpty()) {
+		return 0.f;
+	}
+	return TierTickIntervals[FMath::Clamp(tier, 0, TierTickIntervals.Num() - 1)];
+}
+
+void UUnitSignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Units.IsEmpty()) {
+		return;
+	}
+
+	// The flow field owns the tile size, same as UEnemySpatialIndexSubsystem
+	auto flowField = GetWorld()->GetSubsystem<UHexFlowFieldSubsystem>();
+	const auto tileSize = flowField ? flowField->TileSize : 100.f;
+
+	if (bTowerDistancesDirty) {
+		RebuildTowerDistances(tileSize);
+	}
+
+	auto playerController = GetWorld()->GetFirstPlayerController();
+	if (playerController && playerController->PlayerCameraManager) {
+		SCOPE_CYCLE_COUNTER(STAT_Significance_Score);
+
+		const auto cameraLocation = playerController->PlayerCameraManager->GetCameraLocation();
+		const auto count = FMath::Min(FMath::Max(UnitsScoredPerFrame, 1), Units.Num());
+		for (int32 i = 0; i < count && !Units.IsEmpty(); i++) {
+			if (NextUnitToScore >= Units.Num()) {
+				NextUnitToScore = 0;
+			}
+
+			auto& unit = Units[NextUnitToScore];
+			if (!unit.Actor.ResolveObjectPtr()) {
+				// Destroyed without unregistering, the next unit swaps into this slot
+				RemoveUnitAt(NextUnitToScore);
+				continue;
+			}
+
+			ScoreUnit(unit, cameraLocation, tileSize);
+			NextUnitToScore++;
+		}
+	}
+
+	// Behavior trees schedule their own next tick every time they tick (UBehaviorTreeComponent::ScheduleNextTick),
+	// which would undo a tick interval set once. So cap how soon they tick again after they've had their say
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Significance_ThrottleBrains);
+
+		for (auto& unit : Units) {
+			if (unit.Tier == 0) {
+				continue;
+			}
+
+			auto brain = unit.Brain.Get();
+			const auto interval = GetTierTickInterval(unit.Tier);
+			if (brain && brain->IsComponentTickEnabled() && brain->PrimaryComponentTick.TickInterval < interval) {
+				brain->SetComponentTickIntervalAndCooldown(interval);
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_Significance_Units, Units.Num());
+	SET_DWORD_STAT(STAT_Significance_FullRate, GetNumUnitsInTier(0));
+}
+
+void UUnitSignificanceSubsystem::ScoreUnit(FSignificantUnit& unit, const FVector& cameraLocation, float tileSize)
+{
+	auto actor = unit.Actor.ResolveObjectPtr();
+	const auto location = actor->GetActorLocation();
+	const auto tile = UMapUtilitiesLibrary::ConvertWorldLocationToGlobalCoordinate(location, tileSize);
+
+	FUnitSignificanceInput input;
+	input.CameraDistance = FVector::Dist(location, cameraLocation);
+	input.bVisible = actor->WasRecentlyRendered(0.25f);
+
+	if (!unit.bIsTower) {
+		auto towerDistance = TowerDistances.Find(tile);
+		input.TileDistance = towerDistance ? *towerDistance : INDEX_NONE;
+	}
+	else if (auto spatialIndex = GetWorld()->GetSubsystem<UEnemySpatialIndexSubsystem>()) {
+		auto& index = spatialIndex->GetIndex();
+		QueryHandles.Reset();
+		index.Query(tile, Settings.ActionRange, QueryHandles);
+		for (auto handle : QueryHandles) {
+			const auto distance = tile.GetHexDistance(index.GetTile(handle));
+			if (input.TileDistance < 0 || distance < input.TileDistance) {
+				input.TileDistance = distance;
+			}
+		}
+	}
+
+	const auto tier = Settings.UpdateTier(unit.Tier, Settings.Score(input));
+	if (tier != unit.Tier) {
+		unit.Tier = tier;
+		ApplyTier(unit);
+		INC_DWORD_STAT(STAT_Significance_TierChanges);
+	}
+}
+
+/// <summary>
+/// Remembers the tick interval ticker and each of its ticking components have right now, so tiers can be applied on top of them and undone
+/// </summary>
+void UUnitSignificanceSubsystem::RecordTickIntervals(FSignificantUnit& unit, AActor* ticker)
+{
+	unit.OriginalIntervals.Add({ ticker, ticker->GetActorTickInterval() });
+	for (auto component : ticker->GetComponents()) {
+		if (component->PrimaryComponentTick.bCanEverTick) {
+			unit.OriginalIntervals.Add({ component, component->GetComponentTickInterval() });
+		}
+	}
+}
+
+/// <summary>
+/// Sets the tick interval of everything on the unit that ticks: the actor and its components, and for pawns their
+/// controller and its components too (path following, the behavior tree). Nothing ticks faster than it did when the
+/// unit registered, so tier 0 restores the original intervals
+/// </summary>
+void UUnitSignificanceSubsystem::ApplyTier(FSignificantUnit& unit)
+{
+	auto actor = unit.Actor.ResolveObjectPtr();
+	if (!actor) {
+		return;
+	}
+
+	unit.Brain.Reset();
+	if (auto pawn = Cast<APawn>(actor)) {
+		auto controller = pawn->GetController();
+		if (controller && controller != unit.Controller.Get()) {
+			unit.Controller = controller;
+			RecordTickIntervals(unit, controller);
+		}
+		if (auto aiController = Cast<AAIController>(controller)) {
+			unit.Brain = aiController->GetBrainComponent();
+		}
+	}
+
+	// Components added after the unit registered keep whatever interval they were given
+	const auto interval = GetTierTickInterval(unit.Tier);
+	for (auto& original : unit.OriginalIntervals) {
+		const auto target = FMath::Max(original.Interval, interval);
+		if (auto tickingActor = Cast<AActor>(original.Ticker.Get())) {
+			tickingActor->SetActorTickInterval(target);
+		}
+		else if (auto component = Cast<UActorComponent>(original.Ticker.Get())) {
+			component->SetComponentTickInterval(target);
+		}
+	}
+}
+
+void UUnitSignificanceSubsystem::RebuildTowerDistances(float tileSize)
+{
+	bTowerDistancesDirty = false;
+	TowerDistances.Reset();
+
+	for (auto& unit : Units) {
+		auto tower = unit.Actor.ResolveObjectPtr();
+		if (!unit.bIsTower || !tower) {
+			continue;
+		}
+
+		const auto towerTile = UMapUtilitiesLibrary::ConvertWorldLocationToGlobalCoordinate(tower->GetActorLocation(), tileSize);
+		HexMath::ForEachTileInRange(towerTile, Settings.ActionRange, [this, &towerTile](const FCoordinate2D& tile) {
+			const auto distance = towerTile.GetHexDistance(tile);
+			auto& nearest = TowerDistances.FindOrAdd(tile, distance);
+			nearest = FMath::Min(nearest, distance);
+		});
+	}
+}
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "FCoordinate2D.h"
+#include "UnitSignificance.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "UnitSignificanceSubsystem.generated.h"
+
+class AController;
+class UActorComponent;
+
+/**
+ * Tick LOD for enemies and towers. Every registered unit is scored by its distance to the camera, whether it's on
+ * screen and how close it is to the action (enemies to towers, towers to enemies), sorted into a tier, and every
+ * ticking part of it is slowed down to that tier's interval: the actor, its components (movement, animation) and its
+ * AI controller with its behavior tree and path following.
+ *
+ * Tiers never speed anything up: a part that was authored to tick slower than its tier keeps its own interval, and
+ * tier 0 and unregistering put back the intervals it had when the unit registered.
+ *
+ * Units near the action score high whether or not they're on screen, so the ones that affect gameplay keep ticking
+ * every frame. Scoring is spread over frames, UnitsScoredPerFrame at a time, so the cost stays flat as waves grow.
+ */
+UCLASS()
+class BADTOWERDEFENSEV2_API UUnitSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Starts managing unit's tick rate. Towers are scored by nearby enemies instead of nearby towers */
+	UFUNCTION(BlueprintCallable, Category = "Significance")
+	void RegisterUnit(AActor* unit, bool bIsTower = false);
+
+	/** Puts back the tick intervals unit had when it registered and stops managing it */
+	UFUNCTION(BlueprintCallable, Category = "Significance")
+	void UnregisterUnit(AActor* unit);
+
+	/** 0 is full detail. -1 if the unit isn't registered */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Significance")
+	int32 GetUnitTier(AActor* unit) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Significance")
+	int32 GetNumUnitsInTier(int32 tier) const;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	FUnitSignificanceSettings Settings;
+
+	// Seconds between ticks per tier, one entry per tier (see FUnitSignificanceSettings::TierMinScores)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	TArray<float> TierTickIntervals = { 0.f, 0.1f, 0.25f, 0.5f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	int32 UnitsScoredPerFrame = 128;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	// An actor or component of the unit and the tick interval it had before it was throttled
+	struct FOriginalTickInterval {
+		TWeakObjectPtr<UObject> Ticker;
+		float Interval = 0.f;
+	};
+
+	struct FSignificantUnit {
+		// Stays unique once the actor is destroyed, so it still finds the unit in UnitIndices
+		TObjectKey<AActor> Actor;
+		// The controller whose intervals were recorded, pawns can be possessed after they register
+		TWeakObjectPtr<AController> Controller;
+		TArray<FOriginalTickInterval> OriginalIntervals;
+		// The behavior tree has to be throttled every frame, see Tick
+		TWeakObjectPtr<UActorComponent> Brain;
+		bool bIsTower = false;
+		int32 Tier = 0;
+	};
+
+	void RemoveUnitAt(int32 index);
+	void ScoreUnit(FSignificantUnit& unit, const FVector& cameraLocation, float tileSize);
+	void ApplyTier(FSignificantUnit& unit);
+	void RecordTickIntervals(FSignificantUnit& unit, AActor* ticker);
+	float GetTierTickInterval(int32 tier) const;
+	void RebuildTowerDistances(float tileSize);
+
+	TArray<FSignificantUnit> Units;
+	TMap<TObjectKey<AActor>, int32> UnitIndices;
+	int32 NextUnitToScore = 0;
+
+	// Tiles within Settings.ActionRange of a tower and how far the nearest tower is. Towers don't move, so this is only
+	// rebuilt when they're registered or unregistered
+	TMap<FCoordinate2D, int32> TowerDistances;
+	bool bTowerDistancesDirty = false;
+
+	// Scratch for enemy queries
+	TArray<int32> QueryHandles;
+};
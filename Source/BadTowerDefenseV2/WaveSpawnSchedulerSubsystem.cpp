@@ -0,0 +1,282 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WaveSpawnSchedulerSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/PlatformTime.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("WaveSpawn"), STATGROUP_WaveSpawn, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Activate Enemy"), STAT_WaveSpawn_Activate, STATGROUP_WaveSpawn);
+DECLARE_CYCLE_STAT(TEXT("Prepare Enemy"), STAT_WaveSpawn_Prepare, STATGROUP_WaveSpawn);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queued Spawns"), STAT_WaveSpawn_QueueDepth, STATGROUP_WaveSpawn);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Prepared Enemies"), STAT_WaveSpawn_Prepared, STATGROUP_WaveSpawn);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Over Budget Frames"), STAT_WaveSpawn_OverBudgetFrames, STATGROUP_WaveSpawn);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Unprepared Spawns"), STAT_WaveSpawn_Unprepared, STATGROUP_WaveSpawn);
+
+struct FSpawnsEarlier {
+	bool operator()(const FQueuedEnemySpawn& lhs, const FQueuedEnemySpawn& rhs) const {
+		return lhs.SpawnTime != rhs.SpawnTime ? lhs.SpawnTime < rhs.SpawnTime : lhs.Sequence < rhs.Sequence;
+	}
+};
+
+void UWaveSpawnSchedulerSubsystem::Deinitialize()
+{
+	// The world tears down the prepared actors themselves
+	Queue.Empty();
+	Prepared.Empty();
+	UpdateStats();
+	Super::Deinitialize();
+}
+
+bool UWaveSpawnSchedulerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UWaveSpawnSchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UWaveSpawnSchedulerSubsystem, STATGROUP_Tickables);
+}
+
+void UWaveSpawnSchedulerSubsystem::QueueSpawn(TSubclassOf<APawn> enemyClass, const FTransform& transform, float delay)
+{
+	QueueWave(enemyClass, transform, 1, 0.f, delay);
+}
+
+void UWaveSpawnSchedulerSubsystem::QueueWave(TSubclassOf<APawn> enemyClass, const FTransform& transform, int32 count, float interval, float delay)
+{
+	if (!enemyClass || count <= 0) {
+		return;
+	}
+
+	const auto startTime = GetWorld()->GetTimeSeconds() + FMath::Max(delay, 0.f);
+	interval = FMath::Max(interval, 0.f);
+
+	Queue.Reserve(Queue.Num() + count);
+	for (int32 i = 0; i < count; i++) {
+		FQueuedEnemySpawn spawn;
+		spawn.EnemyClass = enemyClass.Get();
+		spawn.Transform = transform;
+		spawn.SpawnTime = startTime + static_cast<double>(interval) * i;
+		spawn.Sequence = NextSequence++;
+		Queue.HeapPush(spawn, FSpawnsEarlier());
+	}
+
+	Prepared.FindOrAdd(enemyClass.Get()).NumQueued += count;
+	UpdateStats();
+}
+
+void UWaveSpawnSchedulerSubsystem::PrewarmEnemies(TSubclassOf<APawn> enemyClass, int32 count)
+{
+	if (!enemyClass) {
+		return;
+	}
+
+	auto& prepared = Prepared.FindOrAdd(enemyClass.Get());
+	prepared.NumToKeepPrepared = FMath::Max(count, 0);
+}
+
+void UWaveSpawnSchedulerSubsystem::ClearQueue()
+{
+	for (auto& prepared : Prepared) {
+		for (auto pawn : prepared.Value.Pawns) {
+			if (IsValid(pawn)) {
+				pawn->Destroy();
+			}
+		}
+		for (auto controller : prepared.Value.Controllers) {
+			if (IsValid(controller)) {
+				controller->Destroy();
+			}
+		}
+	}
+
+	Queue.Reset();
+	Prepared.Reset();
+	UpdateStats();
+}
+
+int32 UWaveSpawnSchedulerSubsystem::GetNumPrepared(TSubclassOf<APawn> enemyClass) const
+{
+	auto prepared = Prepared.Find(enemyClass.Get());
+	return prepared ? prepared->Pawns.Num() : 0;
+}
+
+void UWaveSpawnSchedulerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const auto startTime = FPlatformTime::Seconds();
+	const auto budget = FrameBudgetMs / 1000.0;
+	auto remainingBudget = [startTime, budget] {
+		return budget - (FPlatformTime::Seconds() - startTime);
+	};
+
+	// Always at least one, otherwise a budget smaller than a single activation would never drain the queue
+	const auto now = GetWorld()->GetTimeSeconds();
+	if (IsSpawnDue(now)) {
+		do {
+			ActivateNextSpawn();
+		} while (IsSpawnDue(now) && remainingBudget() > 0.0);
+	}
+
+	// Whatever is left goes into getting later spawns ready, as long as another one is likely to fit
+	while (remainingBudget() > PrepareSecondsEstimate) {
+		const auto prepareStart = FPlatformTime::Seconds();
+		if (!PrepareNextEnemy()) {
+			break;
+		}
+		PrepareSecondsEstimate = FMath::Lerp(PrepareSecondsEstimate, FPlatformTime::Seconds() - prepareStart, 0.25);
+	}
+
+	if (remainingBudget() < 0.0) {
+		NumOverBudgetFrames++;
+		INC_DWORD_STAT(STAT_WaveSpawn_OverBudgetFrames);
+	}
+
+	UpdateStats();
+}
+
+bool UWaveSpawnSchedulerSubsystem::IsSpawnDue(double now) const
+{
+	return !Queue.IsEmpty() && Queue.HeapTop().SpawnTime <= now;
+}
+
+void UWaveSpawnSchedulerSubsystem::ActivateNextSpawn()
+{
+	SCOPE_CYCLE_COUNTER(STAT_WaveSpawn_Activate);
+
+	FQueuedEnemySpawn spawn;
+	Queue.HeapPop(spawn, FSpawnsEarlier(), false);
+
+	UClass* enemyClass = spawn.EnemyClass;
+	if (!enemyClass) {
+		return;
+	}
+
+	auto& prepared = Prepared.FindOrAdd(enemyClass);
+	prepared.NumQueued = FMath::Max(prepared.NumQueued - 1, 0);
+
+	APawn* pawn = nullptr;
+	AController* controller = nullptr;
+	FParkedActor parked;
+	while (!pawn && !prepared.Pawns.IsEmpty()) {
+		pawn = prepared.Pawns.Pop(false);
+		controller = prepared.Controllers.Pop(false);
+		parked = prepared.Parked.Pop(false);
+		if (!IsValid(pawn)) {
+			// Destroyed by something else while it was waiting
+			if (IsValid(controller)) {
+				controller->Destroy();
+			}
+			pawn = nullptr;
+			controller = nullptr;
+		}
+	}
+
+	if (!pawn) {
+		// Nothing ready in time, so this one pays the whole spawn
+		INC_DWORD_STAT(STAT_WaveSpawn_Unprepared);
+		if (!PrepareEnemy(enemyClass)) {
+			return;
+		}
+		auto& justPrepared = Prepared.FindChecked(enemyClass);
+		pawn = justPrepared.Pawns.Pop(false);
+		controller = justPrepared.Controllers.Pop(false);
+		parked = justPrepared.Parked.Pop(false);
+	}
+
+	pawn->SetActorTransform(spawn.Transform, false, nullptr, ETeleportType::ResetPhysics);
+	parked.Unpark(pawn);
+
+	if (IsValid(controller)) {
+		controller->SetActorTickEnabled(true);
+		controller->Possess(pawn);
+	}
+	else {
+		pawn->SpawnDefaultController();
+	}
+
+	OnEnemySpawned.Broadcast(pawn);
+}
+
+/// <summary>
+/// Prepares one enemy for the first class that has fewer ready than it has queued (or was prewarmed to).
+/// False if every class has enough
+/// </summary>
+bool UWaveSpawnSchedulerSubsystem::PrepareNextEnemy()
+{
+	UClass* enemyClass = nullptr;
+	for (auto& prepared : Prepared) {
+		auto& enemies = prepared.Value;
+		if (enemies.Pawns.Num() < FMath::Max(enemies.NumQueued, enemies.NumToKeepPrepared)) {
+			enemyClass = prepared.Key;
+			break;
+		}
+	}
+
+	return enemyClass && PrepareEnemy(enemyClass);
+}
+
+/// <summary>
+/// Spawns one hidden enemy of enemyClass plus its controller and adds them to its prepared list
+/// </summary>
+bool UWaveSpawnSchedulerSubsystem::PrepareEnemy(UClass* enemyClass)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WaveSpawn_Prepare);
+
+	auto world = GetWorld();
+	auto pawn = world->SpawnActorDeferred<APawn>(enemyClass, FTransform::Identity, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (!pawn) {
+		// Don't keep trying a class that can't be spawned every frame
+		auto& prepared = Prepared.FindOrAdd(enemyClass);
+		prepared.NumQueued = 0;
+		prepared.NumToKeepPrepared = 0;
+		return false;
+	}
+
+	// Possession waits for activation, with the controller spawned below, so the AI doesn't start while it's hidden
+	pawn->AutoPossessAI = EAutoPossessAI::Disabled;
+	pawn->FinishSpawning(FTransform::Identity);
+
+	FParkedActor parked;
+	parked.Park(pawn);
+
+	// Same as APawn::SpawnDefaultController, minus the Possess
+	AController* controller = nullptr;
+	if (pawn->AIControllerClass) {
+		FActorSpawnParameters spawnParameters;
+		spawnParameters.Instigator = pawn->GetInstigator();
+		spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		spawnParameters.OverrideLevel = pawn->GetLevel();
+		spawnParameters.ObjectFlags |= RF_Transient;
+
+		controller = world->SpawnActor<AController>(pawn->AIControllerClass, FTransform::Identity, spawnParameters);
+		if (controller) {
+			controller->SetActorTickEnabled(false);
+		}
+	}
+
+	// Looked up only now: spawning ran BeginPlay, which could have queued more spawns and grown the map
+	auto& prepared = Prepared.FindOrAdd(enemyClass);
+	prepared.Pawns.Add(pawn);
+	prepared.Controllers.Add(controller);
+	prepared.Parked.Add(MoveTemp(parked));
+	return true;
+}
+
+void UWaveSpawnSchedulerSubsystem::UpdateStats() const
+{
+	int32 numPrepared = 0;
+	for (auto& prepared : Prepared) {
+		numPrepared += prepared.Value.Pawns.Num();
+	}
+
+	SET_DWORD_STAT(STAT_WaveSpawn_QueueDepth, Queue.Num());
+	SET_DWORD_STAT(STAT_WaveSpawn_Prepared, numPrepared);
+}
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ParkedActor.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/SubclassOf.h"
+#include "WaveSpawnSchedulerSubsystem.generated.h"
+
+class AController;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnScheduledEnemySpawned, APawn*, Enemy);
+
+USTRUCT()
+struct FQueuedEnemySpawn {
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UClass> EnemyClass;
+
+	FTransform Transform;
+
+	// World time (seconds) to activate at
+	double SpawnTime = 0.0;
+
+	// Keeps spawns queued for the same time in the order they were queued
+	uint64 Sequence = 0;
+};
+
+/** Enemies of one class that are spawned and have a controller, but aren't in play yet */
+USTRUCT()
+struct FPreparedEnemies {
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<APawn>> Pawns;
+
+	// Controllers[i] possesses Pawns[i] when it's activated, can be null if the pawn has no AIControllerClass
+	UPROPERTY()
+	TArray<TObjectPtr<AController>> Controllers;
+
+	// Parked[i] is what Pawns[i] had switched on before it was hidden
+	TArray<FParkedActor> Parked;
+
+	// Spawns of this class still in the queue
+	int32 NumQueued = 0;
+
+	// Keep at least this many ready even with nothing queued (PrewarmEnemies)
+	int32 NumToKeepPrepared = 0;
+};
+
+/**
+ * Spreads the cost of spawning a wave over several frames instead of spawning the whole wave (pawns and AI
+ * controllers) in the frame it starts.
+ *
+ * Spawns are queued with the time they should happen at. Each frame, within FrameBudgetMs:
+ *   1. due spawns are activated: a prepared pawn is moved into place, shown and possessed by its prepared controller
+ *   2. whatever budget is left prepares pawns for spawns further down the queue: spawned hidden with auto
+ *      possession off, plus their controller, so activating them later is cheap
+ *
+ * Queueing a wave only pushes entries onto a heap, so starting a wave costs the same however big it is. At least one
+ * due spawn is activated per frame so the queue always drains; frames that still go over budget show up in
+ * `stat WaveSpawn`.
+ */
+UCLASS()
+class BADTOWERDEFENSEV2_API UWaveSpawnSchedulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Queues one spawn, delay seconds from now */
+	UFUNCTION(BlueprintCallable, Category = "Wave Spawn")
+	void QueueSpawn(TSubclassOf<APawn> enemyClass, const FTransform& transform, float delay = 0.f);
+
+	/** Queues count spawns at transform, the first after delay seconds and then one every interval seconds */
+	UFUNCTION(BlueprintCallable, Category = "Wave Spawn")
+	void QueueWave(TSubclassOf<APawn> enemyClass, const FTransform& transform, int32 count, float interval = 0.f, float delay = 0.f);
+
+	/** Prepares at least count enemies of enemyClass in idle frames, e.g. while the player is building between waves */
+	UFUNCTION(BlueprintCallable, Category = "Wave Spawn")
+	void PrewarmEnemies(TSubclassOf<APawn> enemyClass, int32 count);
+
+	/** Drops every queued spawn and destroys every prepared enemy */
+	UFUNCTION(BlueprintCallable, Category = "Wave Spawn")
+	void ClearQueue();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Wave Spawn")
+	int32 GetQueueDepth() const { return Queue.Num(); }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Wave Spawn")
+	int32 GetNumPrepared(TSubclassOf<APawn> enemyClass) const;
+
+	/** Frames since the subsystem started that went over FrameBudgetMs */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Wave Spawn")
+	int32 GetNumOverBudgetFrames() const { return NumOverBudgetFrames; }
+
+	/** Broadcast for every enemy that enters play, once it's been possessed */
+	UPROPERTY(BlueprintAssignable, Category = "Wave Spawn")
+	FOnScheduledEnemySpawned OnEnemySpawned;
+
+	// Milliseconds per frame for activating and preparing enemies
+	UPROPERTY(BlueprintReadWrite, Category = "Wave Spawn")
+	float FrameBudgetMs = 1.f;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	bool IsSpawnDue(double now) const;
+	void ActivateNextSpawn();
+	bool PrepareNextEnemy();
+	bool PrepareEnemy(UClass* enemyClass);
+	void UpdateStats() const;
+
+	// Min-heap on (SpawnTime, Sequence)
+	UPROPERTY()
+	TArray<FQueuedEnemySpawn> Queue;
+
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FPreparedEnemies> Prepared;
+
+	uint64 NextSequence = 0;
+	int32 NumOverBudgetFrames = 0;
+
+	// Running estimate of how long preparing one enemy takes, so we don't start one we can't finish within budget
+	double PrepareSecondsEstimate = 0.0;
+};